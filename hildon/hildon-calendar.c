@@ -52,6 +52,10 @@
  * and to remove the marker, hildon_calendar_unmark_day(). Alternative, all
  * marks can be cleared with hildon_calendar_clear_marks().
  *
+ * These marks apply to day numbers, whatever the month shown. Dates of any
+ * month can be marked in advance with hildon_calendar_mark_julian_days(),
+ * which keeps the marks when the month changes.
+ *
  * The way in which the calendar itself is displayed can be altered using
  * hildon_calendar_set_display_options().
  *
@@ -87,6 +91,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
+#include <locale.h>
 
 #include <glib.h>
 
@@ -210,6 +215,30 @@ enum
 
 static guint hildon_calendar_signals[LAST_SIGNAL] = { 0 };
 
+/* Extents of the fixed texts of a calendar: month names, day names and
+ * digits. They only depend on the font, the locale and the settings
+ * below, so they are measured once and shared by all calendars. */
+typedef struct
+{
+  HildonCalendarDisplayOptions display_flags;
+  gboolean has_details;
+  gint detail_width_chars;
+  gint detail_height_rows;
+
+  gint max_month_width;
+  gint max_year_width;
+  gint max_header_height;
+  gint min_day_width;
+  gint max_day_char_ascent;
+  gint max_day_char_descent;
+  gint max_label_char_ascent;
+  gint max_label_char_descent;
+  gint max_week_char_width;
+  gint max_detail_height;
+} CalendarTextMetrics;
+
+static GHashTable *calendar_text_metrics = NULL;
+
 struct _HildonCalendarPrivate
 {
   HildonCalendarDisplayOptions display_flags;
@@ -229,6 +258,11 @@ struct _HildonCalendarPrivate
   gint  num_marked_dates;
   gint  marked_date[31];
 
+  /* Marks set by Julian day, as a bitmap split in 32-day words:
+   * julian_day / 32 => bits, with empty words removed */
+  GHashTable *julian_marks;
+  guint32     month_julian_marks;   /* bit day - 1 for the shown month */
+
   gint  focus_row;
   gint  focus_col;
 
@@ -276,10 +310,32 @@ struct _HildonCalendarPrivate
   gpointer              detail_func_user_data;
   GDestroyNotify        detail_func_destroy;
 
+  /* Asynchronous alternative to detail_func. Cells waiting to be
+   * requested have their bit set in detail_pending. */
+  HildonCalendarDetailProvider detail_provider;
+  gpointer              detail_provider_user_data;
+  GDestroyNotify        detail_provider_destroy;
+  guint                 detail_pending[6];
+  guint                 detail_request_id;
+
   /* Size requistion for details provided by the hook. */
   gint detail_height_rows;
   gint detail_width_chars;
   gint detail_overflow[6];
+
+  /* Details of the visible month, fetched from the hook on first use.
+   * A cell is cached when its bit is set in detail_cached, since %NULL
+   * is a valid detail. */
+  gchar       *detail_cache[6][7];
+  guint        detail_cached[6];
+  PangoLayout *detail_layout[6][7];
+
+  /* Shaped day numbers, shared by every month */
+  PangoLayout *day_layout[31];
+
+  /* Owned by calendar_text_metrics, reset on style-updated and
+   * direction-changed */
+  const CalendarTextMetrics *text_metrics;
 };
 
 static void hildon_calendar_finalize     (GObject      *calendar);
@@ -321,12 +377,17 @@ static gboolean hildon_calendar_scroll         (GtkWidget        *widget,
                                              GdkEventScroll   *event);
 static gboolean hildon_calendar_key_press      (GtkWidget        *widget,
                                              GdkEventKey      *event);
+static gboolean hildon_calendar_focus_in       (GtkWidget        *widget,
+                                             GdkEventFocus    *event);
 static gboolean hildon_calendar_focus_out      (GtkWidget        *widget,
                                              GdkEventFocus    *event);
 static void     hildon_calendar_grab_notify    (GtkWidget        *widget,
                                              gboolean          was_grabbed);
 static void     hildon_calendar_state_flags_changed  (GtkWidget     *widget,
                                                    GtkStateFlags  previous_state);
+static void     hildon_calendar_style_updated  (GtkWidget        *widget);
+static void     hildon_calendar_direction_changed (GtkWidget        *widget,
+                                                GtkTextDirection  previous_direction);
 static gboolean hildon_calendar_query_tooltip  (GtkWidget        *widget,
                                              gint              x,
                                              gint              y,
@@ -373,6 +434,13 @@ static void calendar_invalidate_arrow   (HildonCalendar *widget,
                                          guint      arrow);
 
 static void calendar_compute_days      (HildonCalendar *calendar);
+static guint32 calendar_get_month_julian_marks (HildonCalendar *calendar);
+static void calendar_drop_detail       (HildonCalendar *calendar,
+                                        gint         row,
+                                        gint         col);
+static void calendar_drop_details      (HildonCalendar *calendar);
+static void calendar_clear_details     (HildonCalendar *calendar);
+static void calendar_drop_layouts      (HildonCalendar *calendar);
 static gint calendar_get_xsep          (HildonCalendar *calendar);
 static gint calendar_get_ysep          (HildonCalendar *calendar);
 static gint calendar_get_inner_border  (HildonCalendar *calendar);
@@ -412,7 +480,10 @@ hildon_calendar_class_init (HildonCalendarClass *class)
   widget_class->key_press_event = hildon_calendar_key_press;
   widget_class->scroll_event = hildon_calendar_scroll;
   widget_class->state_flags_changed = hildon_calendar_state_flags_changed;
+  widget_class->style_updated = hildon_calendar_style_updated;
+  widget_class->direction_changed = hildon_calendar_direction_changed;
   widget_class->grab_notify = hildon_calendar_grab_notify;
+  widget_class->focus_in_event = hildon_calendar_focus_in;
   widget_class->focus_out_event = hildon_calendar_focus_out;
   widget_class->query_tooltip = hildon_calendar_query_tooltip;
 
@@ -818,6 +889,8 @@ hildon_calendar_init (HildonCalendar *calendar)
   for (i=0;i<31;i++)
     priv->marked_date[i] = FALSE;
   priv->num_marked_dates = 0;
+  priv->julian_marks = g_hash_table_new (NULL, NULL);
+  priv->month_julian_marks = 0;
   priv->selected_day = tm->tm_mday;
 
   priv->display_flags = (HILDON_CALENDAR_SHOW_HEADING |
@@ -925,17 +998,32 @@ hildon_calendar_init (HildonCalendar *calendar)
  *          Utility Functions           *
  ****************************************/
 
-static void
-calendar_queue_refresh (HildonCalendar *calendar)
+static gboolean
+calendar_has_details (HildonCalendar *calendar)
 {
   HildonCalendarPrivate *priv = calendar->priv;
 
-  if (!(priv->detail_func) ||
-      !(priv->display_flags & HILDON_CALENDAR_SHOW_DETAILS) ||
-       (priv->detail_width_chars && priv->detail_height_rows))
-    gtk_widget_queue_draw (GTK_WIDGET (calendar));
-  else
+  return priv->detail_func != NULL || priv->detail_provider != NULL;
+}
+
+/* Whether the size of the calendar depends on the details it shows */
+static gboolean
+calendar_details_need_resize (HildonCalendar *calendar)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+
+  return calendar_has_details (calendar) &&
+         (priv->display_flags & HILDON_CALENDAR_SHOW_DETAILS) &&
+         !(priv->detail_width_chars && priv->detail_height_rows);
+}
+
+static void
+calendar_queue_refresh (HildonCalendar *calendar)
+{
+  if (calendar_details_need_resize (calendar))
     gtk_widget_queue_resize (GTK_WIDGET (calendar));
+  else
+    gtk_widget_queue_draw (GTK_WIDGET (calendar));
 }
 
 static void
@@ -1102,6 +1190,61 @@ calendar_compute_days (HildonCalendar *calendar)
         }
       col = 0;
     }
+
+  priv->month_julian_marks = calendar_get_month_julian_marks (calendar);
+
+  calendar_drop_details (calendar);
+}
+
+static gboolean
+calendar_julian_day_is_marked (HildonCalendar *calendar,
+                               guint32      julian_day)
+{
+  guint32 bits;
+
+  bits = GPOINTER_TO_UINT (g_hash_table_lookup (calendar->priv->julian_marks,
+                                                GUINT_TO_POINTER (julian_day / 32)));
+
+  return (bits & (1u << (julian_day % 32))) != 0;
+}
+
+/* Collects the Julian day marks of the shown month, one bit per day */
+static guint32
+calendar_get_month_julian_marks (HildonCalendar *calendar)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+  GDate date;
+  guint32 first;
+  guint32 marks = 0;
+  gint day, ndays;
+
+  if (g_hash_table_size (priv->julian_marks) == 0)
+    return 0;
+
+  if (!g_date_valid_dmy (1, priv->month + 1, priv->year))
+    return 0;
+
+  g_date_clear (&date, 1);
+  g_date_set_dmy (&date, 1, priv->month + 1, priv->year);
+
+  first = g_date_get_julian (&date);
+  ndays = month_length[leap (priv->year)][priv->month + 1];
+
+  for (day = 0; day < ndays; day++)
+    if (calendar_julian_day_is_marked (calendar, first + day))
+      marks |= (1u << day);
+
+  return marks;
+}
+
+static gboolean
+calendar_day_is_marked (HildonCalendar *calendar,
+                        gint         day)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+
+  return priv->marked_date[day - 1] ||
+         (priv->month_julian_marks & (1u << (day - 1)));
 }
 
 static void
@@ -1127,6 +1270,8 @@ calendar_select_and_focus_day (HildonCalendar *calendar,
 
   if (old_focus_row != -1 && old_focus_col != -1)
     calendar_invalidate_day (calendar, old_focus_row, old_focus_col);
+  if (priv->focus_row != -1 && priv->focus_col != -1)
+    calendar_invalidate_day (calendar, priv->focus_row, priv->focus_col);
 
   hildon_calendar_select_day (calendar, day);
 }
@@ -1365,6 +1510,60 @@ calendar_day_rectangle (HildonCalendar  *calendar,
   rect->width = priv->day_width;
 }
 
+static void
+calendar_header_rectangle (HildonCalendar  *calendar,
+                           GdkRectangle *rect)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+  GtkBorder padding;
+
+  get_component_paddings (calendar, &padding, NULL, NULL, NULL);
+
+  rect->x = padding.left;
+  rect->y = padding.top;
+  rect->width = gtk_widget_get_allocated_width (GTK_WIDGET (calendar))
+                - padding.left - padding.right;
+  rect->height = priv->header_h;
+}
+
+static void
+calendar_day_names_rectangle (HildonCalendar  *calendar,
+                              GdkRectangle *rect)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+  GtkBorder padding;
+  gint inner_border = calendar_get_inner_border (calendar);
+
+  get_component_paddings (calendar, &padding, NULL, NULL, NULL);
+
+  rect->x = padding.left + inner_border;
+  rect->y = priv->header_h + padding.top + inner_border;
+  rect->width = gtk_widget_get_allocated_width (GTK_WIDGET (calendar))
+                - inner_border * 2 - padding.left - padding.right;
+  rect->height = priv->day_name_h;
+}
+
+static void
+calendar_week_numbers_rectangle (HildonCalendar  *calendar,
+                                 GdkRectangle *rect)
+{
+  GtkWidget *widget = GTK_WIDGET (calendar);
+  HildonCalendarPrivate *priv = calendar->priv;
+  GtkBorder padding;
+  gint inner_border = calendar_get_inner_border (calendar);
+
+  get_component_paddings (calendar, &padding, NULL, NULL, NULL);
+
+  rect->y = priv->header_h + priv->day_name_h + padding.top + inner_border;
+  if (gtk_widget_get_direction (widget) == GTK_TEXT_DIR_LTR)
+    rect->x = padding.left + inner_border;
+  else
+    rect->x = gtk_widget_get_allocated_width (widget) - priv->week_width
+              - (padding.right + inner_border);
+  rect->width = priv->week_width;
+  rect->height = priv->main_h;
+}
+
 static void
 calendar_set_month_prev (HildonCalendar *calendar)
 {
@@ -1419,6 +1618,13 @@ calendar_set_month_prev (HildonCalendar *calendar)
 static void
 hildon_calendar_finalize (GObject *object)
 {
+  HildonCalendar *calendar = HILDON_CALENDAR (object);
+
+  calendar_clear_details (calendar);
+  calendar_drop_layouts (calendar);
+
+  g_hash_table_destroy (calendar->priv->julian_marks);
+
   G_OBJECT_CLASS (hildon_calendar_parent_class)->finalize (object);
 }
 
@@ -1437,6 +1643,20 @@ hildon_calendar_destroy (GtkWidget *widget)
       priv->detail_func_destroy = NULL;
     }
 
+  if (priv->detail_provider_destroy && priv->detail_provider_user_data)
+    {
+      priv->detail_provider_destroy (priv->detail_provider_user_data);
+      priv->detail_provider_user_data = NULL;
+      priv->detail_provider_destroy = NULL;
+    }
+  priv->detail_provider = NULL;
+
+  if (priv->detail_request_id)
+    {
+      g_source_remove (priv->detail_request_id);
+      priv->detail_request_id = 0;
+    }
+
   GTK_WIDGET_CLASS (hildon_calendar_parent_class)->destroy (widget);
 }
 
@@ -1847,6 +2067,30 @@ hildon_calendar_unmap (GtkWidget *widget)
   GTK_WIDGET_CLASS (hildon_calendar_parent_class)->unmap (widget);
 }
 
+/* Computes the year and month shown by cells of @day_month kind */
+static void
+calendar_get_cell_month (HildonCalendar *calendar,
+                         gint         day_month,
+                         gint        *year,
+                         gint        *month)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+
+  *year = priv->year;
+  *month = priv->month + day_month - MONTH_CURRENT;
+
+  if (*month < 0)
+    {
+      *month += 12;
+      *year -= 1;
+    }
+  else if (*month > 11)
+    {
+      *month -= 12;
+      *year += 1;
+    }
+}
+
 static gchar*
 hildon_calendar_get_detail (HildonCalendar *calendar,
                          gint         row,
@@ -1858,24 +2102,229 @@ hildon_calendar_get_detail (HildonCalendar *calendar,
   if (priv->detail_func == NULL)
     return NULL;
 
-  year = priv->year;
-  month = priv->month + priv->day_month[row][column] - MONTH_CURRENT;
+  calendar_get_cell_month (calendar, priv->day_month[row][column], &year, &month);
+
+  return priv->detail_func (calendar,
+                            year, month,
+                            priv->day[row][column],
+                            priv->detail_func_user_data);
+}
+
+/* Returns the detail of a cell, asking the hook only the first time
+ * it is needed for the visible month. */
+static const gchar*
+calendar_get_cached_detail (HildonCalendar *calendar,
+                            gint         row,
+                            gint         col)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+
+  if (!(priv->detail_cached[row] & (1 << col)))
+    {
+      priv->detail_cache[row][col] = hildon_calendar_get_detail (calendar, row, col);
+      priv->detail_cached[row] |= (1 << col);
+    }
 
-  if (month < 0)
+  return priv->detail_cache[row][col];
+}
+
+/* Returns the shaped <small> markup of the detail of a cell, or %NULL
+ * if the cell has no detail. The layout is owned by the calendar. */
+static PangoLayout*
+calendar_get_detail_layout (HildonCalendar *calendar,
+                            gint         row,
+                            gint         col)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+  const gchar *detail;
+
+  if (priv->detail_layout[row][col])
+    return priv->detail_layout[row][col];
+
+  detail = calendar_get_cached_detail (calendar, row, col);
+
+  if (detail)
     {
-      month += 12;
-      year -= 1;
+      gchar *markup = g_strconcat ("<small>", detail, "</small>", NULL);
+      PangoLayout *layout = gtk_widget_create_pango_layout (GTK_WIDGET (calendar), NULL);
+
+      pango_layout_set_markup (layout, markup, -1);
+      pango_layout_set_alignment (layout, PANGO_ALIGN_CENTER);
+      pango_layout_set_wrap (layout, PANGO_WRAP_WORD_CHAR);
+      g_free (markup);
+
+      priv->detail_layout[row][col] = layout;
     }
-  else if (month > 11)
+
+  return priv->detail_layout[row][col];
+}
+
+static PangoLayout*
+calendar_get_day_layout (HildonCalendar *calendar,
+                         gint         day)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+
+  g_return_val_if_fail (day >= 1 && day <= 31, NULL);
+
+  if (!priv->day_layout[day - 1])
     {
-      month -= 12;
-      year += 1;
+      gchar buffer[32];
+
+      /* Translators: this defines whether the day numbers should use
+       * localized digits or the ones used in English (0123...).
+       *
+       * Translate to "%Id" if you want to use localized digits, or
+       * translate to "%d" otherwise.
+       *
+       * Note that translating this doesn't guarantee that you get localized
+       * digits. That needs support from your system and locale definition
+       * too.
+       */
+      g_snprintf (buffer, sizeof (buffer), C_("calendar:day:digits", "%d"), day);
+
+      priv->day_layout[day - 1] = gtk_widget_create_pango_layout (GTK_WIDGET (calendar), buffer);
+      pango_layout_set_alignment (priv->day_layout[day - 1], PANGO_ALIGN_CENTER);
     }
 
-  return priv->detail_func (calendar,
-                            year, month,
-                            priv->day[row][column],
-                            priv->detail_func_user_data);
+  return priv->day_layout[day - 1];
+}
+
+static gboolean
+calendar_request_details_idle (gpointer data)
+{
+  HildonCalendar *calendar = HILDON_CALENDAR (data);
+  HildonCalendarPrivate *priv = calendar->priv;
+  guint days[3][31];
+  guint n_days[3] = { 0, 0, 0 };
+  gint row, col, i;
+
+  priv->detail_request_id = 0;
+
+  for (row = 0; row < 6; row++)
+    {
+      for (col = 0; col < 7; col++)
+        if (priv->detail_pending[row] & (1 << col))
+          {
+            i = priv->day_month[row][col];
+            days[i][n_days[i]++] = priv->day[row][col];
+          }
+
+      priv->detail_pending[row] = 0;
+    }
+
+  /* One batch per month shown in the grid */
+  for (i = MONTH_PREV; i <= MONTH_NEXT && priv->detail_provider; i++)
+    if (n_days[i])
+      {
+        gint year, month;
+
+        calendar_get_cell_month (calendar, i, &year, &month);
+        priv->detail_provider (calendar, year, month, days[i], n_days[i],
+                               priv->detail_provider_user_data);
+      }
+
+  return FALSE;
+}
+
+/* Frees the cached detail of a cell, without asking for it again */
+static void
+calendar_clear_detail (HildonCalendar *calendar,
+                       gint         row,
+                       gint         col)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+
+  g_free (priv->detail_cache[row][col]);
+  priv->detail_cache[row][col] = NULL;
+  priv->detail_cached[row] &= ~(1 << col);
+
+  if (priv->detail_layout[row][col])
+    {
+      g_object_unref (priv->detail_layout[row][col]);
+      priv->detail_layout[row][col] = NULL;
+    }
+}
+
+static void
+calendar_clear_details (HildonCalendar *calendar)
+{
+  gint row, col;
+
+  for (row = 0; row < 6; row++)
+    for (col = 0; col < 7; col++)
+      calendar_clear_detail (calendar, row, col);
+}
+
+/* Frees the cached detail of a cell. With a detail provider, the
+ * detail is requested again from an idle handler, once the cell has
+ * been drawn without it. */
+static void
+calendar_drop_detail (HildonCalendar *calendar,
+                      gint         row,
+                      gint         col)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+
+  calendar_clear_detail (calendar, row, col);
+
+  if (priv->detail_provider)
+    {
+      priv->detail_pending[row] |= (1 << col);
+
+      if (!priv->detail_request_id)
+        priv->detail_request_id = gdk_threads_add_idle (calendar_request_details_idle,
+                                                        calendar);
+    }
+}
+
+/* Drops the detail of @day of the visible month */
+static void
+calendar_drop_day_num_detail (HildonCalendar *calendar,
+                              gint         day)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+  gint row, col;
+
+  for (row = 0; row < 6; row++)
+    for (col = 0; col < 7; col++)
+      if (priv->day_month[row][col] == MONTH_CURRENT &&
+          priv->day[row][col] == day)
+        calendar_drop_detail (calendar, row, col);
+}
+
+static void
+calendar_drop_details (HildonCalendar *calendar)
+{
+  gint row, col;
+
+  for (row = 0; row < 6; row++)
+    for (col = 0; col < 7; col++)
+      calendar_drop_detail (calendar, row, col);
+}
+
+/* Drops the shaped text, which depends on the font of the widget. The
+ * detail strings themselves are kept. */
+static void
+calendar_drop_layouts (HildonCalendar *calendar)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+  gint row, col, day;
+
+  for (row = 0; row < 6; row++)
+    for (col = 0; col < 7; col++)
+      if (priv->detail_layout[row][col])
+        {
+          g_object_unref (priv->detail_layout[row][col]);
+          priv->detail_layout[row][col] = NULL;
+        }
+
+  for (day = 0; day < 31; day++)
+    if (priv->day_layout[day])
+      {
+        g_object_unref (priv->day_layout[day]);
+        priv->day_layout[day] = NULL;
+      }
 }
 
 static gboolean
@@ -1887,7 +2336,7 @@ hildon_calendar_query_tooltip (GtkWidget  *widget,
 {
   HildonCalendar *calendar = HILDON_CALENDAR (widget);
   HildonCalendarPrivate *priv = calendar->priv;
-  gchar *detail = NULL;
+  const gchar *detail = NULL;
   GdkRectangle day_rect;
   gint row, col;
 
@@ -1898,7 +2347,7 @@ hildon_calendar_query_tooltip (GtkWidget  *widget,
       (0 != (priv->detail_overflow[row] & (1 << col)) ||
       0 == (priv->display_flags & HILDON_CALENDAR_SHOW_DETAILS)))
     {
-      detail = hildon_calendar_get_detail (calendar, row, col);
+      detail = calendar_get_cached_detail (calendar, row, col);
       calendar_day_rectangle (calendar, row, col, &day_rect);
     }
 
@@ -1907,8 +2356,6 @@ hildon_calendar_query_tooltip (GtkWidget  *widget,
       gtk_tooltip_set_tip_area (tooltip, &day_rect);
       gtk_tooltip_set_markup (tooltip, detail);
 
-      g_free (detail);
-
       return TRUE;
     }
 
@@ -1923,48 +2370,31 @@ hildon_calendar_query_tooltip (GtkWidget  *widget,
  ****************************************/
 
 static void
-hildon_calendar_size_request (GtkWidget      *widget,
-                           GtkRequisition *requisition)
+calendar_measure_text (HildonCalendar      *calendar,
+                       CalendarTextMetrics *metrics)
 {
-  HildonCalendar *calendar = HILDON_CALENDAR (widget);
-  HildonCalendarPrivate *priv = calendar->priv;
-  GtkBorder padding, day_padding, day_name_padding, week_padding;
+  GtkWidget *widget = GTK_WIDGET (calendar);
   PangoLayout *layout;
   PangoRectangle logical_rect;
-
-  gint height;
-  gint i, r, c;
-  gint calendar_margin = CALENDAR_MARGIN;
-  gint header_width, main_width;
-  gint max_header_height = 0;
-  gint max_detail_height;
-  gint inner_border = calendar_get_inner_border (calendar);
-  gint calendar_ysep = calendar_get_ysep (calendar);
-  gint calendar_xsep = calendar_get_xsep (calendar);
-
-  gboolean show_week_numbers = (priv->display_flags & HILDON_CALENDAR_SHOW_WEEK_NUMBERS);
+  HildonCalendarDisplayOptions flags = metrics->display_flags;
+  gint i;
 
   layout = gtk_widget_create_pango_layout (widget, NULL);
 
-  /*
-   * Calculate the requisition  width for the widget.
-   */
+  /* Header */
 
-  /* Header width */
-
-  if (priv->display_flags & HILDON_CALENDAR_SHOW_HEADING)
+  if (flags & HILDON_CALENDAR_SHOW_HEADING)
     {
-      priv->max_month_width = 0;
       for (i = 0; i < 12; i++)
         {
           pango_layout_set_text (layout, default_monthname[i], -1);
           pango_layout_get_pixel_extents (layout, NULL, &logical_rect);
-          priv->max_month_width = MAX (priv->max_month_width,
-                                               logical_rect.width + 8);
-          max_header_height = MAX (max_header_height, logical_rect.height);
+          metrics->max_month_width = MAX (metrics->max_month_width,
+                                          logical_rect.width + 8);
+          metrics->max_header_height = MAX (metrics->max_header_height,
+                                            logical_rect.height);
         }
 
-      priv->max_year_width = 0;
       /* Translators:  This is a text measurement template.
        * Translate it to the widest year text
        *
@@ -1972,31 +2402,13 @@ hildon_calendar_size_request (GtkWidget      *widget,
        */
       pango_layout_set_text (layout, C_("year measurement template", "2000"), -1);
       pango_layout_get_pixel_extents (layout, NULL, &logical_rect);
-      priv->max_year_width = MAX (priv->max_year_width,
-                                  logical_rect.width + 8);
-      max_header_height = MAX (max_header_height, logical_rect.height);
-    }
-  else
-    {
-      priv->max_month_width = 0;
-      priv->max_year_width = 0;
+      metrics->max_year_width = MAX (metrics->max_year_width,
+                                     logical_rect.width + 8);
+      metrics->max_header_height = MAX (metrics->max_header_height,
+                                        logical_rect.height);
     }
 
-  if (priv->display_flags & HILDON_CALENDAR_NO_MONTH_CHANGE)
-    header_width = (priv->max_month_width
-                    + priv->max_year_width
-                    + 3 * 3);
-  else
-    header_width = (priv->max_month_width
-                    + priv->max_year_width
-                    + 4 * priv->arrow_width + 3 * 3);
-
-  /* Mainwindow labels width */
-
-  priv->max_day_char_width = 0;
-  priv->max_day_char_ascent = 0;
-  priv->max_day_char_descent = 0;
-  priv->min_day_width = 0;
+  /* Mainwindow labels */
 
   for (i = 0; i < 9; i++)
     {
@@ -2004,88 +2416,207 @@ hildon_calendar_size_request (GtkWidget      *widget,
       g_snprintf (buffer, sizeof (buffer), C_("calendar:day:digits", "%d"), i * 11);
       pango_layout_set_text (layout, buffer, -1);
       pango_layout_get_pixel_extents (layout, NULL, &logical_rect);
-      priv->min_day_width = MAX (priv->min_day_width,
-                                         logical_rect.width);
+      metrics->min_day_width = MAX (metrics->min_day_width,
+                                    logical_rect.width);
 
-      priv->max_day_char_ascent = MAX (priv->max_day_char_ascent,
-                                               PANGO_ASCENT (logical_rect));
-      priv->max_day_char_descent = MAX (priv->max_day_char_descent,
-                                                PANGO_DESCENT (logical_rect));
+      metrics->max_day_char_ascent = MAX (metrics->max_day_char_ascent,
+                                          PANGO_ASCENT (logical_rect));
+      metrics->max_day_char_descent = MAX (metrics->max_day_char_descent,
+                                           PANGO_DESCENT (logical_rect));
     }
 
-  priv->max_label_char_ascent = 0;
-  priv->max_label_char_descent = 0;
-  if (priv->display_flags & HILDON_CALENDAR_SHOW_DAY_NAMES)
+  if (flags & HILDON_CALENDAR_SHOW_DAY_NAMES)
     for (i = 0; i < 7; i++)
       {
         pango_layout_set_text (layout, default_abbreviated_dayname[i], -1);
         pango_layout_line_get_pixel_extents (pango_layout_get_lines_readonly (layout)->data, NULL, &logical_rect);
 
-        priv->min_day_width = MAX (priv->min_day_width, logical_rect.width);
-        priv->max_label_char_ascent = MAX (priv->max_label_char_ascent,
-                                                   PANGO_ASCENT (logical_rect));
-        priv->max_label_char_descent = MAX (priv->max_label_char_descent,
-                                                    PANGO_DESCENT (logical_rect));
-      }
+        metrics->min_day_width = MAX (metrics->min_day_width, logical_rect.width);
+        metrics->max_label_char_ascent = MAX (metrics->max_label_char_ascent,
+                                              PANGO_ASCENT (logical_rect));
+        metrics->max_label_char_descent = MAX (metrics->max_label_char_descent,
+                                               PANGO_DESCENT (logical_rect));
+      }
+
+  if (flags & HILDON_CALENDAR_SHOW_WEEK_NUMBERS)
+    for (i = 0; i < 9; i++)
+      {
+        gchar buffer[32];
+        g_snprintf (buffer, sizeof (buffer), C_("calendar:week:digits", "%d"), i * 11);
+        pango_layout_set_text (layout, buffer, -1);
+        pango_layout_get_pixel_extents (layout, NULL, &logical_rect);
+        metrics->max_week_char_width = MAX (metrics->max_week_char_width,
+                                            logical_rect.width / 2);
+      }
+
+  /* Calculate the extents of the detail template. Do this as late as
+   * possible since pango_layout_set_markup is called which alters font
+   * settings. */
+
+  if (metrics->has_details && (flags & HILDON_CALENDAR_SHOW_DETAILS) &&
+      (metrics->detail_width_chars || metrics->detail_height_rows))
+    {
+      gint rows = MAX (1, metrics->detail_height_rows) - 1;
+      gsize len = metrics->detail_width_chars + rows + 16;
+      gchar *markup, *tail;
+
+      markup = tail = g_alloca (len);
+
+      memcpy (tail,     "<small>", 7);
+      tail += 7;
+
+      memset (tail, 'm', metrics->detail_width_chars);
+      tail += metrics->detail_width_chars;
+
+      memset (tail, '\n', rows);
+      tail += rows;
+
+      memcpy (tail,     "</small>", 9);
+      tail += 9;
+
+      g_assert (len == (tail - markup));
+
+      pango_layout_set_markup (layout, markup, -1);
+      pango_layout_get_pixel_extents (layout, NULL, &logical_rect);
+
+      if (metrics->detail_width_chars)
+        metrics->min_day_width = MAX (metrics->min_day_width, logical_rect.width);
+      if (metrics->detail_height_rows)
+        metrics->max_detail_height = MAX (metrics->max_detail_height, logical_rect.height);
+    }
+
+  g_object_unref (layout);
+}
+
+/* Looks up the text metrics matching the current font, locale and
+ * settings of @calendar, measuring them if no calendar did before. */
+static const CalendarTextMetrics*
+calendar_get_text_metrics (HildonCalendar *calendar)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+  PangoContext *context;
+  CalendarTextMetrics *metrics;
+  gchar *font, *key;
+
+  if (G_UNLIKELY (calendar_text_metrics == NULL))
+    calendar_text_metrics = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                   g_free, g_free);
+
+  context = gtk_widget_get_pango_context (GTK_WIDGET (calendar));
+  font = pango_font_description_to_string (pango_context_get_font_description (context));
+
+  key = g_strdup_printf ("%s|%g|%s|%s|%d|%d|%d|%d",
+                         font,
+                         pango_cairo_context_get_resolution (context),
+                         setlocale (LC_MESSAGES, NULL),
+                         setlocale (LC_TIME, NULL),
+                         priv->display_flags,
+                         calendar_has_details (calendar),
+                         priv->detail_width_chars,
+                         priv->detail_height_rows);
+  g_free (font);
+
+  metrics = g_hash_table_lookup (calendar_text_metrics, key);
+
+  if (metrics)
+    {
+      g_free (key);
+      return metrics;
+    }
+
+  metrics = g_new0 (CalendarTextMetrics, 1);
+  metrics->display_flags = priv->display_flags;
+  metrics->has_details = calendar_has_details (calendar);
+  metrics->detail_width_chars = priv->detail_width_chars;
+  metrics->detail_height_rows = priv->detail_height_rows;
+
+  calendar_measure_text (calendar, metrics);
+
+  g_hash_table_insert (calendar_text_metrics, key, metrics);
+
+  return metrics;
+}
+
+static void
+hildon_calendar_size_request (GtkWidget      *widget,
+                           GtkRequisition *requisition)
+{
+  HildonCalendar *calendar = HILDON_CALENDAR (widget);
+  HildonCalendarPrivate *priv = calendar->priv;
+  GtkBorder padding, day_padding, day_name_padding, week_padding;
+  const CalendarTextMetrics *metrics;
+  PangoRectangle logical_rect;
+
+  gint height;
+  gint r, c;
+  gint calendar_margin = CALENDAR_MARGIN;
+  gint header_width, main_width;
+  gint max_header_height = 0;
+  gint max_detail_height;
+  gint inner_border = calendar_get_inner_border (calendar);
+  gint calendar_ysep = calendar_get_ysep (calendar);
+  gint calendar_xsep = calendar_get_xsep (calendar);
+
+  gboolean show_week_numbers = (priv->display_flags & HILDON_CALENDAR_SHOW_WEEK_NUMBERS);
 
-  priv->max_week_char_width = 0;
-  if (show_week_numbers)
-    for (i = 0; i < 9; i++)
-      {
-        gchar buffer[32];
-        g_snprintf (buffer, sizeof (buffer), C_("calendar:week:digits", "%d"), i * 11);
-        pango_layout_set_text (layout, buffer, -1);
-        pango_layout_get_pixel_extents (layout, NULL, &logical_rect);
-        priv->max_week_char_width = MAX (priv->max_week_char_width,
-                                           logical_rect.width / 2);
-      }
+  if (priv->text_metrics == NULL ||
+      priv->text_metrics->display_flags != priv->display_flags ||
+      priv->text_metrics->has_details != calendar_has_details (calendar) ||
+      priv->text_metrics->detail_width_chars != priv->detail_width_chars ||
+      priv->text_metrics->detail_height_rows != priv->detail_height_rows)
+    priv->text_metrics = calendar_get_text_metrics (calendar);
 
-  /* Calculate detail extents. Do this as late as possible since
-   * pango_layout_set_markup is called which alters font settings. */
-  max_detail_height = 0;
+  metrics = priv->text_metrics;
 
-  if (priv->detail_func && (priv->display_flags & HILDON_CALENDAR_SHOW_DETAILS))
-    {
-      gchar *markup, *tail;
+  /*
+   * Calculate the requisition  width for the widget.
+   */
 
-      if (priv->detail_width_chars || priv->detail_height_rows)
-        {
-          gint rows = MAX (1, priv->detail_height_rows) - 1;
-          gsize len = priv->detail_width_chars + rows + 16;
+  /* Header width */
 
-          markup = tail = g_alloca (len);
+  priv->max_month_width = metrics->max_month_width;
+  priv->max_year_width = metrics->max_year_width;
+  max_header_height = metrics->max_header_height;
 
-          memcpy (tail,     "<small>", 7);
-          tail += 7;
+  if (priv->display_flags & HILDON_CALENDAR_NO_MONTH_CHANGE)
+    header_width = (priv->max_month_width
+                    + priv->max_year_width
+                    + 3 * 3);
+  else
+    header_width = (priv->max_month_width
+                    + priv->max_year_width
+                    + 4 * priv->arrow_width + 3 * 3);
 
-          memset (tail, 'm', priv->detail_width_chars);
-          tail += priv->detail_width_chars;
+  /* Mainwindow labels width */
 
-          memset (tail, '\n', rows);
-          tail += rows;
+  priv->max_day_char_width = 0;
+  priv->max_day_char_ascent = metrics->max_day_char_ascent;
+  priv->max_day_char_descent = metrics->max_day_char_descent;
+  priv->min_day_width = metrics->min_day_width;
 
-          memcpy (tail,     "</small>", 9);
-          tail += 9;
+  priv->max_label_char_ascent = metrics->max_label_char_ascent;
+  priv->max_label_char_descent = metrics->max_label_char_descent;
 
-          g_assert (len == (tail - markup));
+  priv->max_week_char_width = metrics->max_week_char_width;
 
-          pango_layout_set_markup (layout, markup, -1);
-          pango_layout_get_pixel_extents (layout, NULL, &logical_rect);
+  max_detail_height = metrics->max_detail_height;
 
-          if (priv->detail_width_chars)
-            priv->min_day_width = MAX (priv->min_day_width, logical_rect.width);
-          if (priv->detail_height_rows)
-            max_detail_height = MAX (max_detail_height, logical_rect.height);
-        }
+  if (calendar_has_details (calendar) && (priv->display_flags & HILDON_CALENDAR_SHOW_DETAILS))
+    {
+      gchar *markup;
+      PangoLayout *layout = NULL;
 
       if (!priv->detail_width_chars || !priv->detail_height_rows)
         for (r = 0; r < 6; r++)
           for (c = 0; c < 7; c++)
             {
-              gchar *detail = hildon_calendar_get_detail (calendar, r, c);
+              const gchar *detail = calendar_get_cached_detail (calendar, r, c);
 
               if (detail)
                 {
+                  if (!layout)
+                    layout = gtk_widget_create_pango_layout (widget, NULL);
+
                   markup = g_strconcat ("<small>", detail, "</small>", NULL);
                   pango_layout_set_markup (layout, markup, -1);
 
@@ -2103,9 +2634,11 @@ hildon_calendar_size_request (GtkWidget      *widget,
                     max_detail_height = MAX (max_detail_height, logical_rect.height);
 
                   g_free (markup);
-                  g_free (detail);
                 }
             }
+
+      if (layout)
+        g_object_unref (layout);
     }
 
   get_component_paddings (calendar, &padding, &day_padding, &day_name_padding, &week_padding);
@@ -2160,8 +2693,6 @@ hildon_calendar_size_request (GtkWidget      *widget,
   height = priv->header_h + priv->day_name_h + priv->main_h;
 
   requisition->height = height + padding.top + padding.bottom + (inner_border * 2);
-
-  g_object_unref (layout);
 }
 
 static void
@@ -2640,8 +3171,7 @@ calendar_paint_day (HildonCalendar *calendar,
   HildonCalendarPrivate *priv = calendar->priv;
   GtkStyleContext *context;
   GtkStateFlags state = 0;
-  gchar *detail;
-  gchar buffer[32];
+  const gchar *detail;
   gint day;
   gint x_loc, y_loc;
   GdkRectangle day_rect;
@@ -2671,7 +3201,7 @@ calendar_paint_day (HildonCalendar *calendar,
     state |= GTK_STATE_FLAG_INCONSISTENT;
   else
     {
-      if (priv->marked_date[day-1])
+      if (calendar_day_is_marked (calendar, day))
         state |= GTK_STATE_FLAG_ACTIVE;
 
       if (priv->selected_day == day)
@@ -2687,24 +3217,11 @@ calendar_paint_day (HildonCalendar *calendar,
 
   gtk_style_context_set_state (context, state);
 
-  /* Translators: this defines whether the day numbers should use
-   * localized digits or the ones used in English (0123...).
-   *
-   * Translate to "%Id" if you want to use localized digits, or
-   * translate to "%d" otherwise.
-   *
-   * Note that translating this doesn't guarantee that you get localized
-   * digits. That needs support from your system and locale definition
-   * too.
-   */
-  g_snprintf (buffer, sizeof (buffer), C_("calendar:day:digits", "%d"), day);
-
   /* Get extra information to show, if any: */
 
-  detail = hildon_calendar_get_detail (calendar, row, col);
+  detail = calendar_get_cached_detail (calendar, row, col);
 
-  layout = gtk_widget_create_pango_layout (widget, buffer);
-  pango_layout_set_alignment (layout, PANGO_ALIGN_CENTER);
+  layout = calendar_get_day_layout (calendar, day);
   pango_layout_get_pixel_extents (layout, NULL, &logical_rect);
 
   x_loc = day_rect.x + (day_rect.width - logical_rect.width) / 2;
@@ -2713,12 +3230,12 @@ calendar_paint_day (HildonCalendar *calendar,
   gtk_render_layout (context, cr, x_loc, y_loc, layout);
 
   if (priv->day_month[row][col] == MONTH_CURRENT &&
-     (priv->marked_date[day-1] || (detail && !show_details)))
+     (calendar_day_is_marked (calendar, day) || (detail && !show_details)))
     gtk_render_layout (context, cr, x_loc - 1, y_loc, layout);
 
   y_loc += priv->max_day_char_descent;
 
-  if (priv->detail_func && show_details)
+  if (calendar_has_details (calendar) && show_details)
     {
       GdkRGBA color;
 
@@ -2739,24 +3256,30 @@ calendar_paint_day (HildonCalendar *calendar,
 
   if (detail && show_details)
     {
-      gchar *markup = g_strconcat ("<small>", detail, "</small>", NULL);
-      pango_layout_set_markup (layout, markup, -1);
-      g_free (markup);
+      layout = calendar_get_detail_layout (calendar, row, col);
 
-      if (day == priv->selected_day)
+      if (day == priv->selected_day &&
+          pango_layout_get_attributes (layout))
         {
-          /* Stripping colors as they conflict with selection marking. */
+          /* Stripping colors as they conflict with selection marking.
+           * Done on a copy, so that the cached layout keeps them. */
 
-          PangoAttrList *attrs = pango_layout_get_attributes (layout);
-          PangoAttrList *colors = NULL;
+          PangoAttrList *attrs;
+          PangoAttrList *colors;
 
-          if (attrs)
-            colors = pango_attr_list_filter (attrs, is_color_attribute, NULL);
+          layout = pango_layout_copy (layout);
+          attrs = pango_attr_list_copy (pango_layout_get_attributes (layout));
+
+          colors = pango_attr_list_filter (attrs, is_color_attribute, NULL);
           if (colors)
             pango_attr_list_unref (colors);
+
+          pango_layout_set_attributes (layout, attrs);
+          pango_attr_list_unref (attrs);
         }
+      else
+        g_object_ref (layout);
 
-      pango_layout_set_wrap (layout, PANGO_WRAP_WORD_CHAR);
       pango_layout_set_width (layout, PANGO_SCALE * day_rect.width);
 
       if (priv->detail_height_rows)
@@ -2768,6 +3291,8 @@ calendar_paint_day (HildonCalendar *calendar,
 
       cairo_move_to (cr, day_rect.x, y_loc);
       pango_cairo_show_layout (cr, layout);
+
+      g_object_unref (layout);
     }
 
   if (gtk_widget_has_visible_focus (widget) &&
@@ -2782,21 +3307,26 @@ calendar_paint_day (HildonCalendar *calendar,
     priv->detail_overflow[row] &= ~(1 << col);
 
   gtk_style_context_restore (context);
-  g_object_unref (layout);
-  g_free (detail);
 }
 
 static void
-calendar_paint_main (HildonCalendar *calendar,
-                     cairo_t     *cr)
+calendar_paint_main (HildonCalendar     *calendar,
+                     cairo_t         *cr,
+                     const GdkRectangle *clip)
 {
+  GdkRectangle day_rect;
   gint row, col;
 
   cairo_save (cr);
 
   for (col = 0; col < 7; col++)
     for (row = 0; row < 6; row++)
-      calendar_paint_day (calendar, cr, row, col);
+      {
+        calendar_day_rectangle (calendar, row, col, &day_rect);
+
+        if (gdk_rectangle_intersect (clip, &day_rect, NULL))
+          calendar_paint_day (calendar, cr, row, col);
+      }
 
   cairo_restore (cr);
 }
@@ -2894,8 +3424,15 @@ hildon_calendar_draw (GtkWidget *widget,
 {
   HildonCalendar *calendar = HILDON_CALENDAR (widget);
   HildonCalendarPrivate *priv = calendar->priv;
+  GdkRectangle clip, rect;
   int i;
 
+  /* Only the parts of the calendar within the damaged area are
+   * painted, so that moving the focus or the selection costs two
+   * cells rather than the whole widget. */
+  if (!gdk_cairo_get_clip_rectangle (cr, &clip))
+    return FALSE;
+
   if (gtk_cairo_should_draw_window (cr, gtk_widget_get_window (widget)))
     {
       GtkStyleContext *context;
@@ -2915,20 +3452,35 @@ hildon_calendar_draw (GtkWidget *widget,
       gtk_style_context_restore (context);
     }
 
-  calendar_paint_main (calendar, cr);
+  calendar_paint_main (calendar, cr, &clip);
 
   if (priv->display_flags & HILDON_CALENDAR_SHOW_HEADING)
     {
-      calendar_paint_header (calendar, cr);
+      calendar_header_rectangle (calendar, &rect);
+      if (gdk_rectangle_intersect (&clip, &rect, NULL))
+        calendar_paint_header (calendar, cr);
+
       for (i = 0; i < 4; i++)
-        calendar_paint_arrow (calendar, cr, i);
+        {
+          calendar_arrow_rectangle (calendar, i, &rect);
+          if (gdk_rectangle_intersect (&clip, &rect, NULL))
+            calendar_paint_arrow (calendar, cr, i);
+        }
     }
 
   if (priv->display_flags & HILDON_CALENDAR_SHOW_DAY_NAMES)
-    calendar_paint_day_names (calendar, cr);
+    {
+      calendar_day_names_rectangle (calendar, &rect);
+      if (gdk_rectangle_intersect (&clip, &rect, NULL))
+        calendar_paint_day_names (calendar, cr);
+    }
 
   if (priv->display_flags & HILDON_CALENDAR_SHOW_WEEK_NUMBERS)
-    calendar_paint_week_numbers (calendar, cr);
+    {
+      calendar_week_numbers_rectangle (calendar, &rect);
+      if (gdk_rectangle_intersect (&clip, &rect, NULL))
+        calendar_paint_week_numbers (calendar, cr);
+    }
 
   return FALSE;
 }
@@ -3270,6 +3822,8 @@ move_focus (HildonCalendar *calendar,
 {
   HildonCalendarPrivate *priv = calendar->priv;
   GtkTextDirection text_dir = gtk_widget_get_direction (GTK_WIDGET (calendar));
+  gint old_focus_row = priv->focus_row;
+  gint old_focus_col = priv->focus_col;
 
   if ((text_dir == GTK_TEXT_DIR_LTR && direction == -1) ||
       (text_dir == GTK_TEXT_DIR_RTL && direction == 1))
@@ -3302,6 +3856,14 @@ move_focus (HildonCalendar *calendar,
       if (priv->focus_row < 0)
         priv->focus_row = 0;
     }
+
+  /* Only the cells losing and getting the focus need a repaint */
+  if (old_focus_row != priv->focus_row || old_focus_col != priv->focus_col)
+    {
+      if (old_focus_row != -1 && old_focus_col != -1)
+        calendar_invalidate_day (calendar, old_focus_row, old_focus_col);
+      calendar_invalidate_day (calendar, priv->focus_row, priv->focus_col);
+    }
 }
 
 static gboolean
@@ -3339,9 +3901,6 @@ hildon_calendar_key_press (GtkWidget   *widget,
           else
             {
               move_focus (calendar, -1);
-              calendar_invalidate_day (calendar, old_focus_row, old_focus_col);
-              calendar_invalidate_day (calendar, priv->focus_row,
-                                       priv->focus_col);
             }
         }
       break;
@@ -3362,9 +3921,6 @@ hildon_calendar_key_press (GtkWidget   *widget,
           else
             {
               move_focus (calendar, 1);
-              calendar_invalidate_day (calendar, old_focus_row, old_focus_col);
-              calendar_invalidate_day (calendar, priv->focus_row,
-                                       priv->focus_col);
             }
         }
       break;
@@ -3464,6 +4020,32 @@ hildon_calendar_state_flags_changed (GtkWidget     *widget,
     }
 }
 
+static void
+hildon_calendar_style_updated (GtkWidget *widget)
+{
+  GTK_WIDGET_CLASS (hildon_calendar_parent_class)->style_updated (widget);
+
+  calendar_drop_layouts (HILDON_CALENDAR (widget));
+
+  /* The font may have changed */
+  HILDON_CALENDAR (widget)->priv->text_metrics = NULL;
+  gtk_widget_queue_resize (widget);
+}
+
+static void
+hildon_calendar_direction_changed (GtkWidget        *widget,
+                                GtkTextDirection  previous_direction)
+{
+  GTK_WIDGET_CLASS (hildon_calendar_parent_class)->direction_changed (widget,
+                                                                    previous_direction);
+
+  /* The layouts and the text measured with them follow the direction,
+   * which usually changes along with the locale */
+  calendar_drop_layouts (HILDON_CALENDAR (widget));
+  HILDON_CALENDAR (widget)->priv->text_metrics = NULL;
+  gtk_widget_queue_resize (widget);
+}
+
 static void
 hildon_calendar_grab_notify (GtkWidget *widget,
                           gboolean   was_grabbed)
@@ -3472,13 +4054,32 @@ hildon_calendar_grab_notify (GtkWidget *widget,
     calendar_stop_spinning (HILDON_CALENDAR (widget));
 }
 
+/* The focus only shows on the focused day */
+static void
+calendar_invalidate_focus (HildonCalendar *calendar)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+
+  if (priv->focus_row != -1 && priv->focus_col != -1)
+    calendar_invalidate_day (calendar, priv->focus_row, priv->focus_col);
+}
+
+static gboolean
+hildon_calendar_focus_in (GtkWidget     *widget,
+                       GdkEventFocus *event)
+{
+  calendar_invalidate_focus (HILDON_CALENDAR (widget));
+
+  return FALSE;
+}
+
 static gboolean
 hildon_calendar_focus_out (GtkWidget     *widget,
                         GdkEventFocus *event)
 {
   HildonCalendar *calendar = HILDON_CALENDAR (widget);
 
-  calendar_queue_refresh (calendar);
+  calendar_invalidate_focus (calendar);
   calendar_stop_spinning (calendar);
 
   calendar->priv->in_drag = 0;
@@ -3915,6 +4516,7 @@ hildon_calendar_clear_marks (HildonCalendar *calendar)
     }
 
   priv->num_marked_dates = 0;
+  calendar_drop_details (calendar);
   calendar_queue_refresh (calendar);
 }
 
@@ -3939,6 +4541,7 @@ hildon_calendar_mark_day (HildonCalendar *calendar,
     {
       priv->marked_date[day - 1] = TRUE;
       priv->num_marked_dates++;
+      calendar_drop_day_num_detail (calendar, day);
       calendar_invalidate_day_num (calendar, day);
     }
 }
@@ -3991,10 +4594,155 @@ hildon_calendar_unmark_day (HildonCalendar *calendar,
     {
       priv->marked_date[day - 1] = FALSE;
       priv->num_marked_dates--;
+      calendar_drop_day_num_detail (calendar, day);
       calendar_invalidate_day_num (calendar, day);
     }
 }
 
+static void
+calendar_set_julian_marks (HildonCalendar *calendar,
+                           const guint32 *julian_days,
+                           guint        n_days,
+                           gboolean     mark)
+{
+  HildonCalendarPrivate *priv = calendar->priv;
+  guint32 old_marks, changed;
+  guint i;
+  gint day;
+
+  for (i = 0; i < n_days; i++)
+    {
+      gpointer key = GUINT_TO_POINTER (julian_days[i] / 32);
+      guint32 bits;
+
+      if (!g_date_valid_julian (julian_days[i]))
+        {
+          g_warning ("%s: invalid Julian day %u", G_STRFUNC, julian_days[i]);
+          continue;
+        }
+
+      bits = GPOINTER_TO_UINT (g_hash_table_lookup (priv->julian_marks, key));
+
+      if (mark)
+        bits |= (1u << (julian_days[i] % 32));
+      else
+        bits &= ~(1u << (julian_days[i] % 32));
+
+      if (bits)
+        g_hash_table_insert (priv->julian_marks, key, GUINT_TO_POINTER (bits));
+      else
+        g_hash_table_remove (priv->julian_marks, key);
+    }
+
+  /* Only the days of the shown month whose mark changed need a repaint */
+  old_marks = priv->month_julian_marks;
+  priv->month_julian_marks = calendar_get_month_julian_marks (calendar);
+  changed = old_marks ^ priv->month_julian_marks;
+
+  for (day = 1; changed; day++, changed >>= 1)
+    if (changed & 1)
+      {
+        calendar_drop_day_num_detail (calendar, day);
+        calendar_invalidate_day_num (calendar, day);
+      }
+}
+
+/**
+ * hildon_calendar_mark_julian_days:
+ * @calendar: a #HildonCalendar.
+ * @julian_days: (array length=n_days): the days to mark, as Julian days.
+ * @n_days: the number of elements in @julian_days.
+ *
+ * Places a visual marker on a set of dates, which can belong to any
+ * month. Dates are given as Julian days, as returned by
+ * g_date_get_julian(). Unlike hildon_calendar_mark_day(), the marks
+ * stay on their dates when the month shown changes, so a whole year
+ * of marks can be set at once.
+ *
+ * Since: 3.0
+ */
+void
+hildon_calendar_mark_julian_days (HildonCalendar *calendar,
+                               const guint32 *julian_days,
+                               guint        n_days)
+{
+  g_return_if_fail (HILDON_IS_CALENDAR (calendar));
+  g_return_if_fail (julian_days != NULL || n_days == 0);
+
+  calendar_set_julian_marks (calendar, julian_days, n_days, TRUE);
+}
+
+/**
+ * hildon_calendar_unmark_julian_days:
+ * @calendar: a #HildonCalendar.
+ * @julian_days: (array length=n_days): the days to unmark, as Julian days.
+ * @n_days: the number of elements in @julian_days.
+ *
+ * Removes the visual marker from dates marked with
+ * hildon_calendar_mark_julian_days().
+ *
+ * Since: 3.0
+ */
+void
+hildon_calendar_unmark_julian_days (HildonCalendar *calendar,
+                                 const guint32 *julian_days,
+                                 guint        n_days)
+{
+  g_return_if_fail (HILDON_IS_CALENDAR (calendar));
+  g_return_if_fail (julian_days != NULL || n_days == 0);
+
+  calendar_set_julian_marks (calendar, julian_days, n_days, FALSE);
+}
+
+/**
+ * hildon_calendar_clear_julian_marks:
+ * @calendar: a #HildonCalendar.
+ *
+ * Removes all the marks set with hildon_calendar_mark_julian_days().
+ * Marks set with hildon_calendar_mark_day() are kept.
+ *
+ * Since: 3.0
+ */
+void
+hildon_calendar_clear_julian_marks (HildonCalendar *calendar)
+{
+  HildonCalendarPrivate *priv;
+
+  g_return_if_fail (HILDON_IS_CALENDAR (calendar));
+
+  priv = calendar->priv;
+
+  g_hash_table_remove_all (priv->julian_marks);
+
+  if (priv->month_julian_marks)
+    {
+      priv->month_julian_marks = 0;
+      calendar_drop_details (calendar);
+      calendar_queue_refresh (calendar);
+    }
+}
+
+/**
+ * hildon_calendar_get_julian_day_is_marked:
+ * @calendar: a #HildonCalendar.
+ * @julian_day: a Julian day, as returned by g_date_get_julian().
+ *
+ * Returns whether @julian_day was marked with
+ * hildon_calendar_mark_julian_days().
+ *
+ * Returns: whether the day is marked.
+ *
+ * Since: 3.0
+ */
+gboolean
+hildon_calendar_get_julian_day_is_marked (HildonCalendar *calendar,
+                                       guint32      julian_day)
+{
+  g_return_val_if_fail (HILDON_IS_CALENDAR (calendar), FALSE);
+
+  return calendar_julian_day_is_marked (calendar, julian_day);
+}
+
 /**
  * hildon_calendar_get_date:
  * @calendar: a #HildonCalendar
@@ -4068,11 +4816,169 @@ hildon_calendar_set_detail_func (HildonCalendar           *calendar,
   priv->detail_func_user_data = data;
   priv->detail_func_destroy = destroy;
 
+  if (func && priv->detail_provider)
+    hildon_calendar_set_detail_provider (calendar, NULL, NULL, NULL);
+
+  calendar_drop_details (calendar);
+
+  gtk_widget_set_has_tooltip (GTK_WIDGET (calendar),
+                              calendar_has_details (calendar));
+  gtk_widget_queue_resize (GTK_WIDGET (calendar));
+}
+
+/**
+ * hildon_calendar_invalidate_details:
+ * @calendar: a #HildonCalendar.
+ *
+ * Makes @calendar ask its detail function again for the details of
+ * the visible month. The details are cached while a month is shown,
+ * so this has to be called when the information returned by the
+ * function installed with hildon_calendar_set_detail_func() changes.
+ * Changing the month, or marking and unmarking a day, refreshes the
+ * details without calling this function.
+ *
+ * Since: 3.0
+ */
+void
+hildon_calendar_invalidate_details (HildonCalendar *calendar)
+{
+  g_return_if_fail (HILDON_IS_CALENDAR (calendar));
+
+  calendar_drop_details (calendar);
+  calendar_queue_refresh (calendar);
+}
+
+/**
+ * hildon_calendar_set_detail_provider:
+ * @calendar: a #HildonCalendar.
+ * @provider: a function requesting details for batches of days, or %NULL.
+ * @data: data to pass to @provider invocations.
+ * @destroy: a function for releasing @data.
+ *
+ * Installs an asynchronous alternative to
+ * hildon_calendar_set_detail_func(). Instead of being asked for each
+ * day while painting, @provider is called from an idle handler with
+ * all the days of a month that need details, and returns at once.
+ * The calendar is drawn without those details, which are filled in
+ * as they are passed to hildon_calendar_set_details().
+ *
+ * This suits backends that answer for many days in one query, or
+ * that do their work in another thread. hildon_calendar_set_details()
+ * must be called from the main thread.
+ *
+ * Setting a provider unsets the detail function, and the other way
+ * around.
+ *
+ * Since: 3.0
+ */
+void
+hildon_calendar_set_detail_provider (HildonCalendar              *calendar,
+                                  HildonCalendarDetailProvider provider,
+                                  gpointer                  data,
+                                  GDestroyNotify            destroy)
+{
+  HildonCalendarPrivate *priv;
+
+  g_return_if_fail (HILDON_IS_CALENDAR (calendar));
+
+  priv = calendar->priv;
+
+  if (priv->detail_provider_destroy)
+    priv->detail_provider_destroy (priv->detail_provider_user_data);
+
+  priv->detail_provider = provider;
+  priv->detail_provider_user_data = data;
+  priv->detail_provider_destroy = destroy;
+
+  if (provider && priv->detail_func)
+    hildon_calendar_set_detail_func (calendar, NULL, NULL, NULL);
+
+  if (!provider && priv->detail_request_id)
+    {
+      g_source_remove (priv->detail_request_id);
+      priv->detail_request_id = 0;
+      memset (priv->detail_pending, 0, sizeof (priv->detail_pending));
+    }
+
+  calendar_drop_details (calendar);
+
   gtk_widget_set_has_tooltip (GTK_WIDGET (calendar),
-                              NULL != priv->detail_func);
+                              calendar_has_details (calendar));
   gtk_widget_queue_resize (GTK_WIDGET (calendar));
 }
 
+/**
+ * hildon_calendar_set_details:
+ * @calendar: a #HildonCalendar.
+ * @year: the year of the days.
+ * @month: the month of the days, between 0 and 11.
+ * @days: (array length=n_days): the days of @month.
+ * @details: (array length=n_days) (nullable): Pango markup with the details
+ *     of each element of @days, or %NULL for days without details.
+ * @n_days: the number of elements in @days.
+ *
+ * Provides details requested by the function installed with
+ * hildon_calendar_set_detail_provider(). Only the days that are still
+ * visible are used, and only their cells are redrawn, unless the size
+ * of the calendar depends on its details.
+ *
+ * Since: 3.0
+ */
+void
+hildon_calendar_set_details (HildonCalendar     *calendar,
+                          guint            year,
+                          guint            month,
+                          const guint     *days,
+                          const gchar    **details,
+                          guint            n_days)
+{
+  HildonCalendarPrivate *priv;
+  gboolean need_resize;
+  gint day_month;
+  guint i;
+
+  g_return_if_fail (HILDON_IS_CALENDAR (calendar));
+  g_return_if_fail (month < 12);
+  g_return_if_fail (days != NULL || n_days == 0);
+
+  priv = calendar->priv;
+  need_resize = calendar_details_need_resize (calendar);
+
+  /* Find out which part of the grid shows @month, if any */
+  for (day_month = MONTH_PREV; day_month <= MONTH_NEXT; day_month++)
+    {
+      gint y, m;
+
+      calendar_get_cell_month (calendar, day_month, &y, &m);
+      if (y == (gint) year && m == (gint) month)
+        break;
+    }
+
+  if (day_month > MONTH_NEXT)
+    return;
+
+  for (i = 0; i < n_days; i++)
+    {
+      gint row, col;
+
+      for (row = 0; row < 6; row++)
+        for (col = 0; col < 7; col++)
+          if (priv->day_month[row][col] == day_month &&
+              priv->day[row][col] == (gint) days[i])
+            {
+              calendar_clear_detail (calendar, row, col);
+              priv->detail_cache[row][col] = g_strdup (details ? details[i] : NULL);
+              priv->detail_cached[row] |= (1 << col);
+
+              if (!need_resize)
+                calendar_invalidate_day (calendar, row, col);
+            }
+    }
+
+  if (need_resize)
+    gtk_widget_queue_resize (GTK_WIDGET (calendar));
+}
+
 /**
  * hildon_calendar_set_detail_width_chars:
  * @calendar: a #HildonCalendar.
@@ -99,6 +99,29 @@ typedef gchar* (*HildonCalendarDetailFunc) (HildonCalendar *calendar,
                                             guint        day,
                                             gpointer     user_data);
 
+/**
+ * HildonCalendarDetailProvider:
+ * @calendar: a #HildonCalendar.
+ * @year: the year for which details are needed.
+ * @month: the month for which details are needed.
+ * @days: (array length=n_days): the days of @month for which details are needed.
+ * @n_days: the number of elements in @days.
+ * @user_data: the data passed with hildon_calendar_set_detail_provider().
+ *
+ * This kind of functions request the details for a batch of days of
+ * one month. They must not block: the answer is given later, possibly
+ * in several parts, with hildon_calendar_set_details(). The array is
+ * only valid during the call.
+ *
+ * Since: 3.0
+ */
+typedef void (*HildonCalendarDetailProvider) (HildonCalendar *calendar,
+                                              guint        year,
+                                              guint        month,
+                                              const guint *days,
+                                              guint        n_days,
+                                              gpointer     user_data);
+
 struct _HildonCalendar
 {
   GtkWidget widget;
@@ -168,6 +191,20 @@ void       hildon_calendar_set_detail_func (HildonCalendar           *calendar,
                                          gpointer               data,
                                          GDestroyNotify         destroy);
 
+void       hildon_calendar_invalidate_details (HildonCalendar       *calendar);
+
+void       hildon_calendar_set_detail_provider (HildonCalendar              *calendar,
+                                             HildonCalendarDetailProvider provider,
+                                             gpointer                  data,
+                                             GDestroyNotify            destroy);
+
+void       hildon_calendar_set_details (HildonCalendar     *calendar,
+                                     guint            year,
+                                     guint            month,
+                                     const guint     *days,
+                                     const gchar    **details,
+                                     guint            n_days);
+
 
 void       hildon_calendar_set_detail_width_chars (HildonCalendar    *calendar,
                                                 gint            chars);
@@ -184,6 +221,19 @@ gint       hildon_calendar_get_detail_height_rows (HildonCalendar    *calendar);
 gboolean   hildon_calendar_get_day_is_marked      (HildonCalendar    *calendar,
                                                 guint           day);
 
+void       hildon_calendar_mark_julian_days       (HildonCalendar    *calendar,
+                                                const guint32  *julian_days,
+                                                guint           n_days);
+
+void       hildon_calendar_unmark_julian_days     (HildonCalendar    *calendar,
+                                                const guint32  *julian_days,
+                                                guint           n_days);
+
+void       hildon_calendar_clear_julian_marks     (HildonCalendar    *calendar);
+
+gboolean   hildon_calendar_get_julian_day_is_marked (HildonCalendar  *calendar,
+                                                  guint32         julian_day);
+
 G_END_DECLS
 
 #endif /* __HILDON_CALENDAR_H__ */
@@ -91,7 +91,9 @@ hildon_date_button_init (HildonDateButton * self)
 {
   GtkWidget *date_selector;
 
-  date_selector = hildon_date_selector_new ();
+  date_selector = g_object_new (HILDON_TYPE_DATE_SELECTOR,
+                                "lazy-construction", TRUE,
+                                NULL);
 
   hildon_picker_button_set_selector (HILDON_PICKER_BUTTON (self),
                                      HILDON_TOUCH_SELECTOR (date_selector));
@@ -126,7 +128,9 @@ GtkWidget *
 hildon_date_button_new (HildonSizeType          size,
                         HildonButtonArrangement arrangement)
 {
-  GtkWidget *selector = hildon_date_selector_new ();
+  GtkWidget *selector = g_object_new (HILDON_TYPE_DATE_SELECTOR,
+                                      "lazy-construction", TRUE,
+                                      NULL);
   return hildon_date_button_new_full (size, arrangement, selector);
 }
 
@@ -48,6 +48,9 @@
 #include <langinfo.h>
 
 #include "hildon-date-selector.h"
+#include "hildon-touch-selector-private.h"
+#include "hildon-range-model-private.h"
+#include "hildon-private.h"
 
 #define HILDON_DATE_SELECTOR_GET_PRIVATE(obj)                           \
   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), HILDON_TYPE_DATE_SELECTOR, HildonDateSelectorPrivate))
@@ -63,8 +66,8 @@ G_DEFINE_TYPE (HildonDateSelector, hildon_date_selector, HILDON_TYPE_TOUCH_SELEC
 
 enum
 {
-  COLUMN_STRING,
-  COLUMN_INT,
+  COLUMN_STRING = HILDON_RANGE_MODEL_COLUMN_LABEL,
+  COLUMN_INT = HILDON_RANGE_MODEL_COLUMN_VALUE,
   N_COLUMNS
 };
 
@@ -96,17 +99,27 @@ struct _HildonDateSelectorPrivate
 
   gint min_year;
   gint max_year;
+
+  gboolean lazy_construction;
+  gboolean ui_constructed;
+  guint year;
+  guint month;
+  guint day;                    /* active date until the UI is constructed */
 };
 
 enum {
   PROP_MIN_YEAR = 1,
   PROP_MAX_YEAR,
+  PROP_LAZY_CONSTRUCTION
 };
 
 static GObject * hildon_date_selector_constructor (GType                  type,
                                                    guint                  n_construct_properties,
                                                    GObjectConstructParam *construct_properties);
 static void hildon_date_selector_finalize (GObject * object);
+static void hildon_date_selector_parent_set (GtkWidget *widget,
+                                             GtkWidget *previous_parent);
+static void hildon_date_selector_construct_ui (HildonDateSelector *selector);
 
 /* private functions */
 static GtkTreeModel *_create_day_model (HildonDateSelector * selector);
@@ -218,6 +231,9 @@ hildon_date_selector_set_property (GObject      *object,
   case PROP_MAX_YEAR:
     priv->max_year = g_value_get_int (value);
     break;
+  case PROP_LAZY_CONSTRUCTION:
+    priv->lazy_construction = g_value_get_boolean (value);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
   }
@@ -239,6 +255,9 @@ hildon_date_selector_get_property (GObject      *object,
   case PROP_MAX_YEAR:
     g_value_set_int (value, priv->max_year);
     break;
+  case PROP_LAZY_CONSTRUCTION:
+    g_value_set_boolean (value, priv->lazy_construction);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
   }
@@ -262,6 +281,7 @@ hildon_date_selector_class_init (HildonDateSelectorClass * class)
   gobject_class->constructor = hildon_date_selector_constructor;
 
   /* GtkWidget */
+  widget_class->parent_set = hildon_date_selector_parent_set;
 
   /* GtkContainer */
 
@@ -291,6 +311,27 @@ hildon_date_selector_class_init (HildonDateSelectorClass * class)
       2037,
       G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE));
 
+  /**
+   * HildonDateSelector:lazy-construction:
+   *
+   * Whether the columns of the selector are only built when they are
+   * first needed: when the selector is added to a container, usually
+   * the #HildonPickerDialog opened by a #HildonDateButton, or when
+   * the #HildonTouchSelector API is first used on its columns. Until
+   * then, the date is kept by the #HildonDateSelector API alone.
+   *
+   * Since: 3.0
+   */
+  g_object_class_install_property (
+    gobject_class,
+    PROP_LAZY_CONSTRUCTION,
+    g_param_spec_boolean (
+      "lazy-construction",
+      "Lazy construction",
+      "Whether the columns are only built when the selector gets a parent",
+      FALSE,
+      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE));
+
   /* signals */
 
   g_type_class_add_private (class, sizeof (HildonDateSelectorPrivate));
@@ -303,6 +344,8 @@ hildon_date_selector_construct_ui (HildonDateSelector *selector)
   gint current_item = 0;
   HildonTouchSelectorColumn *column = NULL;
 
+  selector->priv->ui_constructed = TRUE;
+
   selector->priv->year_model = _create_year_model (selector);
   selector->priv->month_model = _create_month_model (selector);
   selector->priv->day_model = _create_day_model (selector);
@@ -335,6 +378,23 @@ hildon_date_selector_construct_ui (HildonDateSelector *selector)
   }
 }
 
+/* Builds the columns of a lazily constructed selector, once they are
+   needed, with the date stored until then */
+static void
+hildon_date_selector_build_lazy_ui (HildonTouchSelector *touch_selector)
+{
+  HildonDateSelector *selector = HILDON_DATE_SELECTOR (touch_selector);
+
+  /* The date does not change here, so nobody has to be told */
+  hildon_touch_selector_block_changed (touch_selector);
+  hildon_date_selector_construct_ui (selector);
+  hildon_date_selector_select_current_date (selector, selector->priv->year,
+                                            selector->priv->month,
+                                            selector->priv->day);
+  _update_day_model (selector);
+  hildon_touch_selector_unblock_changed (touch_selector);
+}
+
 static GObject *
 hildon_date_selector_constructor (GType                  type,
                                   guint                  n_construct_properties,
@@ -350,18 +410,37 @@ hildon_date_selector_constructor (GType                  type,
 
   g_object_set (object, "live-search", FALSE, NULL);
 
-  hildon_date_selector_construct_ui (selector);
-
   g_signal_connect (object, "changed", G_CALLBACK (_manage_selector_change_cb), NULL);
 
-  /* By default we should select the current day */
-  hildon_date_selector_select_current_date (selector, selector->priv->creation_year,
-                                            selector->priv->creation_month,
-                                            selector->priv->creation_day);
+  if (selector->priv->lazy_construction) {
+    selector->priv->year = selector->priv->creation_year;
+    selector->priv->month = selector->priv->creation_month;
+    selector->priv->day = selector->priv->creation_day;
+    hildon_touch_selector_set_build_func (HILDON_TOUCH_SELECTOR (selector),
+                                          hildon_date_selector_build_lazy_ui);
+  } else {
+    hildon_date_selector_construct_ui (selector);
+
+    /* By default we should select the current day */
+    hildon_date_selector_select_current_date (selector, selector->priv->creation_year,
+                                              selector->priv->creation_month,
+                                              selector->priv->creation_day);
+  }
 
   return object;
 }
 
+static void
+hildon_date_selector_parent_set (GtkWidget *widget,
+                                 GtkWidget *previous_parent)
+{
+  if (GTK_WIDGET_CLASS (hildon_date_selector_parent_class)->parent_set)
+    GTK_WIDGET_CLASS (hildon_date_selector_parent_class)->parent_set (widget, previous_parent);
+
+  if (gtk_widget_get_parent (widget) != NULL)
+    hildon_touch_selector_build_columns (HILDON_TOUCH_SELECTOR (widget));
+}
+
 static void
 hildon_date_selector_init (HildonDateSelector * selector)
 {
@@ -380,6 +459,8 @@ hildon_date_selector_init (HildonDateSelector * selector)
   _get_real_date (&selector->priv->creation_year,
                   &selector->priv->creation_month, &selector->priv->creation_day);
   selector->priv->current_num_days = 31;
+  selector->priv->lazy_construction = FALSE;
+  selector->priv->ui_constructed = FALSE;
 }
 
 static void
@@ -530,85 +611,60 @@ _init_column_order (HildonDateSelector * selector)
 }
 
 
+/* The day, month and year columns use a HildonRangeModel: rows are
+   not stored, and labels are only formatted for the rows shown. The
+   day model changes with the selected month, so every selector has
+   its own; the month and year models are never modified and are
+   shared by all the selectors with the same locale and year range. */
 static GtkTreeModel *
 _create_day_model (HildonDateSelector * selector)
 {
-  GtkListStore *store_days = NULL;
-  gint i = 0;
-  gchar label[255];
-  struct tm tm = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-  GtkTreeIter iter;
-
-  store_days = gtk_list_store_new (2, G_TYPE_STRING, G_TYPE_INT);
-  for (i = 1; i < 32; i++) {
-    tm.tm_mday = i;
-    strftime (label, 255, _("wdgt_va_day_numeric"), &tm);
-
-    gtk_list_store_append (store_days, &iter);
-    gtk_list_store_set (store_days, &iter,
-                        COLUMN_STRING, label, COLUMN_INT, i, -1);
-  }
+  return hildon_range_model_new (1, 31, _("wdgt_va_day_numeric"),
+                                 HILDON_RANGE_MODEL_DAY);
+}
 
-  return GTK_TREE_MODEL (store_days);
+static GtkTreeModel *
+_new_year_model (HildonDateSelector * selector)
+{
+  return hildon_range_model_new (selector->priv->min_year,
+                                 selector->priv->max_year,
+                                 _("wdgt_va_year"),
+                                 HILDON_RANGE_MODEL_YEAR);
 }
 
 static GtkTreeModel *
 _create_year_model (HildonDateSelector * selector)
 {
-  GtkListStore *store_years = NULL;
-  gint real_year = 0;
-  gint i = 0;
-  static gchar label[255];
-  struct tm tm = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-  GtkTreeIter iter;
+  GtkTreeModel *model;
+  gchar *key;
 
-  real_year = selector->priv->creation_year;
+  key = g_strdup_printf ("date-selector-years:%d:%d",
+                         selector->priv->min_year, selector->priv->max_year);
+  model = hildon_private_get_shared_model (key, (HildonModelCreateFunc) _new_year_model,
+                                           selector);
+  g_free (key);
 
-  store_years = gtk_list_store_new (2, G_TYPE_STRING, G_TYPE_INT);
-  for (i = selector->priv->min_year; i < selector->priv->max_year + 1; i++) {
-    tm.tm_year = i - 1900;
-    strftime (label, 255, _("wdgt_va_year"), &tm);
-
-    gtk_list_store_append (store_years, &iter);
-    gtk_list_store_set (store_years, &iter,
-                        COLUMN_STRING, label, COLUMN_INT, i, -1);
-  }
+  return model;
+}
 
-  return GTK_TREE_MODEL (store_years);
+static GtkTreeModel *
+_new_month_model (HildonDateSelector * selector)
+{
+  return hildon_range_model_new (0, 11, _("wdgt_va_month"),
+                                 HILDON_RANGE_MODEL_MONTH);
 }
 
 static GtkTreeModel *
 _create_month_model (HildonDateSelector * selector)
 {
-  GtkTreeIter iter;
-  gint i = 0;
-  GtkListStore *store_months = NULL;
-  static gchar label[255];
-  struct tm tm = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-
-  store_months = gtk_list_store_new (2, G_TYPE_STRING, G_TYPE_INT);
-  for (i = 0; i < 12; i++) {
-    tm.tm_mon = i;
-    strftime (label, 255, _("wdgt_va_month"), &tm);
-
-    gtk_list_store_append (store_months, &iter);
-    gtk_list_store_set (store_months, &iter, COLUMN_STRING, label,
-                        COLUMN_INT, i,
-                        -1);
-  }
-
-  return GTK_TREE_MODEL (store_months);
+  return hildon_private_get_shared_model ("date-selector-months",
+                                          (HildonModelCreateFunc) _new_month_model,
+                                          selector);
 }
 
 static GtkTreeModel *
 _update_day_model (HildonDateSelector * selector)
 {
-  GtkListStore *store_days = NULL;
-  GtkTreePath *path = NULL;
-  gint i = 0;
-  GtkTreeIter iter;
-  static gchar label[255];
-  struct tm tm = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
   guint current_day = 0;
   guint current_year = 0;
   guint current_month = 0;
@@ -618,30 +674,14 @@ _update_day_model (HildonDateSelector * selector)
                                  &current_day);
 
   num_days = _month_days (current_month, current_year);
-  store_days = GTK_LIST_STORE (selector->priv->day_model);
 
   if (num_days == selector->priv->current_num_days) {
-    return GTK_TREE_MODEL (store_days);
+    return selector->priv->day_model;
   }
 
-  if (num_days > selector->priv->current_num_days) {
-    for (i = selector->priv->current_num_days + 1; i <= num_days; i++) {
-      tm.tm_mday = i;
-      strftime (label, 255, _("wdgt_va_day_numeric"), &tm);
-
-      gtk_list_store_append (store_days, &iter);
-      gtk_list_store_set (store_days, &iter,
-                          COLUMN_STRING, label, COLUMN_INT, i, -1);
-    }
-  } else {
-    path = gtk_tree_path_new_from_indices (num_days,
-                                           -1);
-    gtk_tree_model_get_iter (GTK_TREE_MODEL (store_days), &iter, path);
-    do {
-    }while (gtk_list_store_remove (store_days, &iter));
-
-    gtk_tree_path_free (path);
-  }
+  /* Only the last days are inserted or deleted */
+  hildon_range_model_set_range (HILDON_RANGE_MODEL (selector->priv->day_model),
+                                1, num_days);
 
 
   selector->priv->current_num_days = num_days;
@@ -653,7 +693,7 @@ _update_day_model (HildonDateSelector * selector)
 
   hildon_date_selector_select_day (selector, current_day);
 
-  return GTK_TREE_MODEL (store_days);
+  return selector->priv->day_model;
 }
 
 
@@ -689,6 +729,9 @@ _manage_selector_change_cb (HildonTouchSelector * touch_selector,
   g_return_if_fail (HILDON_IS_DATE_SELECTOR (touch_selector));
   selector = HILDON_DATE_SELECTOR (touch_selector);
 
+  if (!selector->priv->ui_constructed)
+    return;
+
   if ((num_column == selector->priv->month_column) ||
       (num_column == selector->priv->year_column)) /* it is required to check that with
                                                     * the years too,remember: leap years
@@ -803,6 +846,32 @@ hildon_date_selector_select_current_date (HildonDateSelector * selector,
   num_days = _month_days (month, year);
   g_return_val_if_fail (day > 0 && day <= num_days, FALSE);
 
+  if (!selector->priv->ui_constructed) {
+    gboolean year_changed = (year != selector->priv->year);
+    gboolean month_changed = (month != selector->priv->month);
+    gboolean day_changed = (day != selector->priv->day);
+
+    selector->priv->year = year;
+    selector->priv->month = month;
+    selector->priv->day = day;
+
+    /* Same emissions the columns would do, so that a
+       HildonPickerButton updates its value. A handler using the
+       column builds the columns first, see
+       hildon_touch_selector_set_build_func() */
+    if (year_changed)
+      hildon_touch_selector_emit_value_changed (HILDON_TOUCH_SELECTOR (selector),
+                                                selector->priv->year_column);
+    if (month_changed)
+      hildon_touch_selector_emit_value_changed (HILDON_TOUCH_SELECTOR (selector),
+                                                selector->priv->month_column);
+    if (day_changed)
+      hildon_touch_selector_emit_value_changed (HILDON_TOUCH_SELECTOR (selector),
+                                                selector->priv->day_column);
+
+    return TRUE;
+  }
+
 
   gtk_tree_model_iter_nth_child (selector->priv->year_model, &iter, NULL,
                                  year - min_year);
@@ -843,6 +912,16 @@ hildon_date_selector_get_date (HildonDateSelector * selector,
 {
   GtkTreeIter iter;
 
+  if (!selector->priv->ui_constructed) {
+    if (year != NULL)
+      *year = selector->priv->year;
+    if (month != NULL)
+      *month = selector->priv->month;
+    if (day != NULL)
+      *day = selector->priv->day;
+    return;
+  }
+
   if (year != NULL) {
     if (hildon_touch_selector_get_selected (HILDON_TOUCH_SELECTOR (selector),
                                             selector->priv->year_column, &iter))
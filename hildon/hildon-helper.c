@@ -39,6 +39,15 @@
 
 #define _GNU_SOURCE
 #include                                        <string.h>
+
+#if defined (__SSE2__)
+#include                                        <emmintrin.h>
+#define                                         SMART_MATCH_SIMD_BITS 1
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+#include                                        <arm_neon.h>
+#define                                         SMART_MATCH_SIMD_BITS 4
+#endif
+
 #include                                        "hildon-helper.h"
 #include                                        "hildon-banner.h"
 
@@ -567,14 +576,29 @@ hildon_format_file_size_for_display             (goffset size)
 }
 
 
+/* Every character of the Basic Multilingual Plane is looked up in
+ * these tables instead of going through the Unicode database each
+ * time. @stripped holds stripped_char() of each character, or
+ * STRIP_TABLE_UNCACHED for the few results that do not fit, and
+ * @alnum holds one bit per character telling g_unichar_isalnum(). */
+#define                                         STRIP_TABLE_SIZE 0x10000
+
+#define                                         STRIP_TABLE_UNCACHED 0xFFFF
+
+typedef struct
+{
+  guint16 stripped[STRIP_TABLE_SIZE];
+  guint32 alnum[STRIP_TABLE_SIZE / 32];
+} HildonStripTable;
+
 /**
- * stripped_char:
+ * stripped_char_uncached:
  *
  * Returns a stripped version of @ch, removing any case, accentuation
  * mark, or any special mark on it.
  **/
 static gunichar
-stripped_char (gunichar ch)
+stripped_char_uncached (gunichar ch)
 {
   gunichar decomp[4];
   gunichar retval;
@@ -605,15 +629,72 @@ stripped_char (gunichar ch)
   return 0;
 }
 
-static gchar *
+static const HildonStripTable *
+strip_table_get (void)
+{
+  static gsize initialized = 0;
+  static HildonStripTable *table = NULL;
+
+  if (g_once_init_enter (&initialized)) {
+    gunichar ch;
+
+    table = g_new0 (HildonStripTable, 1);
+
+    for (ch = 0; ch < STRIP_TABLE_SIZE; ch++) {
+      gunichar sc = stripped_char_uncached (ch);
+
+      table->stripped[ch] = sc < STRIP_TABLE_UNCACHED ? sc : STRIP_TABLE_UNCACHED;
+      if (g_unichar_isalnum (ch))
+        table->alnum[ch / 32] |= 1u << (ch % 32);
+    }
+
+    g_once_init_leave (&initialized, 1);
+  }
+
+  return table;
+}
+
+/**
+ * stripped_char:
+ *
+ * Returns a stripped version of @ch, removing any case, accentuation
+ * mark, or any special mark on it.
+ **/
+static inline gunichar
+stripped_char (const HildonStripTable *table, gunichar ch)
+{
+  if (G_LIKELY (ch < STRIP_TABLE_SIZE &&
+                table->stripped[ch] != STRIP_TABLE_UNCACHED))
+    return table->stripped[ch];
+
+  return stripped_char_uncached (ch);
+}
+
+static inline gboolean
+unichar_isalnum (const HildonStripTable *table, gunichar ch)
+{
+  if (G_LIKELY (ch < STRIP_TABLE_SIZE))
+    return (table->alnum[ch / 32] >> (ch % 32)) & 1;
+
+  return g_unichar_isalnum (ch);
+}
+
+static inline const gchar *
 e_util_unicode_get_utf8 (const gchar *text, gunichar *out)
 {
+  /* ASCII needs no decoding */
+  if (G_LIKELY ((guchar) *text < 0x80)) {
+    *out = (guchar) *text;
+    return text + 1;
+  }
+
   *out = g_utf8_get_char (text);
   return (*out == (gunichar)-1) ? NULL : g_utf8_next_char (text);
 }
 
 /**
  * get_next:
+ * @table: the strip table
  * @p: a pointer to the string to search.
  * @o: a place to store the location of the next valid char.
  * @out: a place to store the next valid char.
@@ -627,7 +708,8 @@ e_util_unicode_get_utf8 (const gchar *text, gunichar *out)
  * string iteration.
  **/
 static const gchar *
-get_next (const gchar *p, const gchar **o, gunichar *out, gboolean separators)
+get_next (const HildonStripTable *table, const gchar *p, const gchar **o,
+          gunichar *out, gboolean separators)
 {
   gunichar utf8;
 
@@ -635,12 +717,12 @@ get_next (const gchar *p, const gchar **o, gunichar *out, gboolean separators)
     do {
        *o = p;
        p = e_util_unicode_get_utf8 (p, &utf8);
-       *out = stripped_char (utf8);
-    } while (p && utf8 && !g_unichar_isalnum (*out));
+       *out = stripped_char (table, utf8);
+    } while (p && utf8 && !unichar_isalnum (table, *out));
   } else {
     *o = p;
     p = e_util_unicode_get_utf8 (p, &utf8);
-    *out = stripped_char (utf8);
+    *out = stripped_char (table, utf8);
   }
 
   return p;
@@ -672,21 +754,26 @@ get_next (const gchar *p, const gchar **o, gunichar *out, gboolean separators)
 const gchar *
 hildon_helper_utf8_strstrcasedecomp_needle_stripped (const gchar *haystack, const gunichar *nuni)
 {
+  const HildonStripTable *table;
   gunichar unival;
   gint nlen = 0;
   const gchar *o, *p;
   gunichar sc;
+  gboolean separators;
 
   if (haystack == NULL) return NULL;
   if (nuni == NULL) return NULL;
-  if (strlen (haystack) == 0) return NULL;
+  if (*haystack == '\0') return NULL;
   while (*(nuni + nlen) != 0) nlen++;
 
   if (nlen < 1) return haystack;
 
-  for (p = get_next (haystack, &o, &sc, g_unichar_isalnum (nuni[0]));
+  table = strip_table_get ();
+  separators = unichar_isalnum (table, nuni[0]);
+
+  for (p = get_next (table, haystack, &o, &sc, separators);
        p && sc;
-       p = get_next (p, &o, &sc, g_unichar_isalnum (nuni[0]))) {
+       p = get_next (table, p, &o, &sc, separators)) {
     if (sc) {
       /* We have valid stripped gchar */
       if (sc == nuni[0]) {
@@ -695,7 +782,7 @@ hildon_helper_utf8_strstrcasedecomp_needle_stripped (const gchar *haystack, cons
         while (npos < nlen) {
           q = e_util_unicode_get_utf8 (q, &unival);
           if (!q || !unival) return NULL;
-          sc = stripped_char (unival);
+          sc = stripped_char (table, unival);
           if ((!sc) || (sc != nuni[npos])) break;
           npos++;
         }
@@ -705,10 +792,10 @@ hildon_helper_utf8_strstrcasedecomp_needle_stripped (const gchar *haystack, cons
       }
     }
     while (p) {
-      sc = g_utf8_get_char (p);
-      if (!g_unichar_isalnum (sc))
+      const gchar *next = e_util_unicode_get_utf8 (p, &sc);
+      if (!next || !unichar_isalnum (table, sc))
         break;
-      p = g_utf8_next_char (p);
+      p = next;
     }
   }
 
@@ -730,13 +817,15 @@ hildon_helper_utf8_strstrcasedecomp_needle_stripped (const gchar *haystack, cons
 gunichar *
 hildon_helper_strip_string (const gchar *string)
 {
+  const HildonStripTable *table;
   gunichar *nuni;
   gint nlen;
   gunichar unival;
   const gchar *p;
 
-  if (strlen (string) == 0) return NULL;
+  if (*string == '\0') return NULL;
 
+  table = strip_table_get ();
   nuni = g_malloc (sizeof (gunichar) * (strlen (string) + 1));
 
   nlen = 0;
@@ -744,7 +833,7 @@ hildon_helper_strip_string (const gchar *string)
        p && unival;
        p = e_util_unicode_get_utf8 (p, &unival)) {
       gunichar sc;
-      sc = stripped_char (unival);
+      sc = stripped_char (table, unival);
       if (sc) {
           nuni[nlen++] = sc;
       }
@@ -775,6 +864,56 @@ hildon_helper_normalize_string (const gchar *string)
     return str;
 }
 
+#ifdef                                          SMART_MATCH_SIMD_BITS
+
+/* Word starts are found 16 bytes at a time. For each block, the
+ * vector code produces one mask of the ASCII alphanumeric bytes and
+ * one of the bytes equal, ignoring case, to @first. Masks use
+ * SMART_MATCH_SIMD_BITS bits per byte, as NEON has no byte movemask. */
+static inline void
+smart_match_block_masks (const guchar *p, guchar first, guint64 *alnum, guint64 *equal)
+{
+#if defined (__SSE2__)
+    __m128i v = _mm_loadu_si128 ((const __m128i *) p);
+    __m128i folded = _mm_or_si128 (v, _mm_set1_epi8 (0x20));
+    __m128i letter = _mm_and_si128 (_mm_cmpgt_epi8 (folded, _mm_set1_epi8 ('a' - 1)),
+                                    _mm_cmplt_epi8 (folded, _mm_set1_epi8 ('z' + 1)));
+    __m128i digit = _mm_and_si128 (_mm_cmpgt_epi8 (v, _mm_set1_epi8 ('0' - 1)),
+                                   _mm_cmplt_epi8 (v, _mm_set1_epi8 ('9' + 1)));
+
+    *alnum = (guint) _mm_movemask_epi8 (_mm_or_si128 (letter, digit));
+    *equal = (guint) _mm_movemask_epi8 (_mm_cmpeq_epi8 (folded, _mm_set1_epi8 (first | 0x20)));
+#else
+    uint8x16_t v = vld1q_u8 (p);
+    uint8x16_t folded = vorrq_u8 (v, vdupq_n_u8 (0x20));
+    uint8x16_t letter = vcleq_u8 (vsubq_u8 (folded, vdupq_n_u8 ('a')), vdupq_n_u8 ('z' - 'a'));
+    uint8x16_t digit = vcleq_u8 (vsubq_u8 (v, vdupq_n_u8 ('0')), vdupq_n_u8 ('9' - '0'));
+    uint8x16_t eq = vceqq_u8 (folded, vdupq_n_u8 (first | 0x20));
+
+    *alnum = vget_lane_u64 (vreinterpret_u64_u8 (
+        vshrn_n_u16 (vreinterpretq_u16_u8 (vorrq_u8 (letter, digit)), 4)), 0);
+    *equal = vget_lane_u64 (vreinterpret_u64_u8 (
+        vshrn_n_u16 (vreinterpretq_u16_u8 (eq), 4)), 0);
+#endif
+}
+
+/* Index of the lowest bit set in @mask, which must not be 0 */
+static inline guint
+smart_match_lowest_bit (guint64 mask)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll (mask);
+#else
+    /* gulong may only have 32 bits */
+    if ((guint32) mask != 0)
+        return g_bit_nth_lsf ((guint32) mask, -1);
+
+    return 32 + g_bit_nth_lsf ((guint32) (mask >> 32), -1);
+#endif
+}
+
+#endif
+
 /**
  * hildon_helper_smart_match:
  * @haystack: a string where to find a match
@@ -798,26 +937,585 @@ hildon_helper_normalize_string (const gchar *string)
 gchar *
 hildon_helper_smart_match (const gchar *haystack, const gchar *needle)
 {
+    const guchar *h = (const guchar *) haystack;
+    gsize hlen, nlen, i = 0;
+    gboolean prev_alnum = FALSE;
+    guchar first;
+
     if (haystack == NULL) return NULL;
     if (needle == NULL) return NULL;
-    if (strlen (haystack) == 0) return NULL;
+    if (*haystack == '\0') return NULL;
+
+    if (!g_ascii_isalnum (needle[0]))
+        return strcasestr (haystack, needle);
+
+    /* The needle can only match at the start of a word */
+    hlen = strlen (haystack);
+    nlen = strlen (needle);
+    first = g_ascii_tolower (needle[0]);
+
+#ifdef SMART_MATCH_SIMD_BITS
+    {
+        const guint64 byte_mask = (1u << SMART_MATCH_SIMD_BITS) - 1;
+        guint64 carry = 0;
+
+        for (; i + 16 <= hlen; i += 16) {
+            guint64 alnum, equal, starts;
+
+            smart_match_block_masks (h + i, first, &alnum, &equal);
+            starts = alnum & ~((alnum << SMART_MATCH_SIMD_BITS) | carry) & equal;
+            carry = (alnum >> (15 * SMART_MATCH_SIMD_BITS)) & byte_mask;
 
-    gboolean skip_separators = g_ascii_isalnum (needle[0]);
+            while (starts) {
+                guint bit = smart_match_lowest_bit (starts);
+                gsize pos = i + bit / SMART_MATCH_SIMD_BITS;
 
-    if (skip_separators) {
-        gint i = 0;
-        while (haystack[i] != '\0') {
-            while (haystack[i] != '\0' && !g_ascii_isalnum (haystack[i]))
-                i++;
-            if (g_ascii_strncasecmp (haystack + i, needle, strlen (needle)) == 0) {
-                return (gchar *)haystack + i;
+                if (hlen - pos >= nlen &&
+                    g_ascii_strncasecmp (haystack + pos, needle, nlen) == 0)
+                    return (gchar *) haystack + pos;
+
+                starts &= ~(byte_mask << (bit - bit % SMART_MATCH_SIMD_BITS));
             }
-            while (g_ascii_isalnum (haystack[i]))
-                   i++;
         }
-    } else {
-        return strcasestr (haystack, needle);
+
+        prev_alnum = carry != 0;
+    }
+#endif
+
+    for (; i < hlen; i++) {
+        gboolean alnum = g_ascii_isalnum (h[i]);
+
+        if (alnum && !prev_alnum && g_ascii_tolower (h[i]) == first &&
+            hlen - i >= nlen &&
+            g_ascii_strncasecmp (haystack + i, needle, nlen) == 0)
+            return (gchar *) haystack + i;
+
+        prev_alnum = alnum;
     }
 
     return NULL;
 }
+
+
+/* @first_bytes is the skip table of the word: one bit for each byte
+ * that can start the UTF-8 sequence of a character stripped to the
+ * first character of the word. Words of the haystack starting with
+ * any other byte are skipped without decoding or stripping them. */
+typedef struct
+{
+  gunichar *chars;
+  guint len;
+  gboolean separators;
+  guint32 first_bytes[256 / 32];
+} HildonMatcherWord;
+
+struct _HildonMatcher
+{
+  gint ref_count;
+  HildonMatcherFlags flags;
+  guint n_words;
+  HildonMatcherWord *words;
+};
+
+G_DEFINE_BOXED_TYPE (HildonMatcher, hildon_matcher,
+                     hildon_matcher_ref, hildon_matcher_unref);
+
+static void
+matcher_word_compile_skip (const HildonStripTable *table,
+                           HildonMatcherWord      *word)
+{
+  gunichar ch;
+  guint b;
+
+  for (ch = 0; ch < STRIP_TABLE_SIZE; ch++) {
+    if (table->stripped[ch] != word->chars[0] &&
+        table->stripped[ch] != STRIP_TABLE_UNCACHED)
+      continue;
+
+    if (ch < 0x80)
+      b = ch;
+    else if (ch < 0x800)
+      b = 0xC0 | (ch >> 6);
+    else
+      b = 0xE0 | (ch >> 12);
+    word->first_bytes[b / 32] |= 1u << (b % 32);
+  }
+
+  /* Characters out of the table may be stripped to anything */
+  for (b = 0xF0; b < 0x100; b++)
+    word->first_bytes[b / 32] |= 1u << (b % 32);
+}
+
+static inline gboolean
+matcher_word_may_start (const HildonMatcherWord *word,
+                        guchar                   b)
+{
+  return (word->first_bytes[b / 32] >> (b % 32)) & 1;
+}
+
+/* Returns the end of the alphanumeric characters at @p */
+static const gchar *
+matcher_skip_word (const HildonStripTable *table,
+                   const gchar            *p)
+{
+  while (*p) {
+    const gchar *next;
+    gunichar ch;
+
+    if ((guchar) *p < 0x80) {
+      if (!g_ascii_isalnum (*p))
+        break;
+      p++;
+      continue;
+    }
+
+    next = e_util_unicode_get_utf8 (p, &ch);
+    if (!next || !unichar_isalnum (table, ch))
+      break;
+    p = next;
+  }
+
+  return p;
+}
+
+/**
+ * matcher_word_match:
+ * @table: the strip table
+ * @word: a compiled word of the needle
+ * @haystack: the string to search
+ * @anchored: whether @word may only match at the start of @haystack
+ * @start: return location for the byte offset of the match
+ * @end: return location for the byte offset following the match
+ *
+ * Searches @word in @haystack the same way
+ * hildon_helper_utf8_strstrcasedecomp_needle_stripped() does, but
+ * also reports where the match ends.
+ *
+ * Returns: whether @word was found.
+ **/
+static gboolean
+matcher_word_match (const HildonStripTable  *table,
+                    const HildonMatcherWord *word,
+                    const gchar             *haystack,
+                    gboolean                 anchored,
+                    gint                    *start,
+                    gint                    *end)
+{
+  const gchar *o, *p;
+  gunichar sc;
+
+  if (anchored) {
+    guint npos = 0;
+
+    p = haystack;
+    while (npos < word->len) {
+      gunichar unival;
+
+      o = p;
+      p = e_util_unicode_get_utf8 (p, &unival);
+      if (!p || !unival)
+        return FALSE;
+
+      /* Marks and other ignorable characters do not count */
+      sc = stripped_char (table, unival);
+      if (!sc)
+        continue;
+      if (sc != word->chars[npos])
+        return FALSE;
+      npos++;
+    }
+
+    *start = 0;
+    *end = p - haystack;
+    return TRUE;
+  }
+
+  if (word->separators) {
+    p = haystack;
+    while (*p) {
+      guchar b = (guchar) *p;
+      const gchar *q;
+      gunichar unival;
+      guint npos;
+
+      if (b < 0x80 && !g_ascii_isalnum (b)) {
+        p++;
+        continue;
+      }
+
+      if (b < 0x80 && !matcher_word_may_start (word, b)) {
+        p = matcher_skip_word (table, p + 1);
+        continue;
+      }
+
+      o = p;
+      p = e_util_unicode_get_utf8 (p, &unival);
+      if (!p)
+        return FALSE;
+
+      /* Marks and other ignorable characters separate words too */
+      sc = stripped_char (table, unival);
+      if (!unichar_isalnum (table, sc))
+        continue;
+
+      if (matcher_word_may_start (word, b) && sc == word->chars[0]) {
+        for (q = p, npos = 1; npos < word->len; npos++) {
+          q = e_util_unicode_get_utf8 (q, &unival);
+          if (!q || !unival)
+            return FALSE;
+          sc = stripped_char (table, unival);
+          if ((!sc) || (sc != word->chars[npos]))
+            break;
+        }
+
+        if (npos == word->len) {
+          *start = o - haystack;
+          *end = q - haystack;
+          return TRUE;
+        }
+      }
+
+      p = matcher_skip_word (table, p);
+    }
+
+    return FALSE;
+  }
+
+  for (p = get_next (table, haystack, &o, &sc, word->separators);
+       p && sc;
+       p = get_next (table, p, &o, &sc, word->separators)) {
+    if (sc == word->chars[0]) {
+      const gchar *q = p;
+      guint npos = 1;
+
+      while (npos < word->len) {
+        gunichar unival;
+
+        q = e_util_unicode_get_utf8 (q, &unival);
+        if (!q || !unival)
+          return FALSE;
+        sc = stripped_char (table, unival);
+        if ((!sc) || (sc != word->chars[npos]))
+          break;
+        npos++;
+      }
+
+      if (npos == word->len) {
+        *start = o - haystack;
+        *end = q - haystack;
+        return TRUE;
+      }
+    }
+
+    while (p) {
+      const gchar *next = e_util_unicode_get_utf8 (p, &sc);
+      if (!next || !unichar_isalnum (table, sc))
+        break;
+      p = next;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+ * hildon_matcher_new:
+ * @needle: the text to search for
+ * @flags: a combination of #HildonMatcherFlags
+ *
+ * Creates a #HildonMatcher to search for @needle. The needle is
+ * stripped of case and accentuation marks once, as
+ * hildon_helper_strip_string() does, so that it can be searched in any
+ * number of haystacks with hildon_matcher_match() or
+ * hildon_matcher_match_all() without further conversions.
+ *
+ * By default @needle is searched at the start of every word of the
+ * haystack, like hildon_helper_smart_match() does. With
+ * %HILDON_MATCHER_SPLIT_WORDS, each space separated word of @needle is
+ * searched separately and all of them have to be found.
+ *
+ * Returns: a new #HildonMatcher. Free it with hildon_matcher_unref().
+ *
+ * Since: 3.0
+ **/
+HildonMatcher *
+hildon_matcher_new                              (const gchar        *needle,
+                                                 HildonMatcherFlags  flags)
+{
+  const HildonStripTable *table;
+  HildonMatcher *matcher;
+  gchar **words;
+  guint i;
+
+  g_return_val_if_fail (needle != NULL, NULL);
+
+  table = strip_table_get ();
+
+  if (flags & HILDON_MATCHER_SPLIT_WORDS) {
+    words = g_strsplit_set (needle, " \t\n", -1);
+  } else {
+    words = g_new0 (gchar *, 2);
+    words[0] = g_strdup (needle);
+  }
+
+  matcher = g_slice_new0 (HildonMatcher);
+  matcher->ref_count = 1;
+  matcher->flags = flags;
+  matcher->words = g_new0 (HildonMatcherWord, g_strv_length (words));
+
+  for (i = 0; words[i] != NULL; i++) {
+    HildonMatcherWord *word = &matcher->words[matcher->n_words];
+    gunichar *chars;
+
+    if (words[i][0] == '\0')
+      continue;
+
+    chars = hildon_helper_strip_string (words[i]);
+    if (chars == NULL || chars[0] == 0) {
+      g_free (chars);
+      continue;
+    }
+
+    word->chars = chars;
+    while (chars[word->len] != 0)
+      word->len++;
+    word->separators = unichar_isalnum (table, chars[0]);
+    if (word->separators)
+      matcher_word_compile_skip (table, word);
+
+    matcher->n_words++;
+  }
+
+  g_strfreev (words);
+
+  return matcher;
+}
+
+/**
+ * hildon_matcher_ref:
+ * @matcher: a #HildonMatcher
+ *
+ * Increases the reference count of @matcher.
+ *
+ * Returns: @matcher
+ *
+ * Since: 3.0
+ **/
+HildonMatcher *
+hildon_matcher_ref                              (HildonMatcher *matcher)
+{
+  g_return_val_if_fail (matcher != NULL, NULL);
+
+  g_atomic_int_inc (&matcher->ref_count);
+
+  return matcher;
+}
+
+/**
+ * hildon_matcher_unref:
+ * @matcher: a #HildonMatcher
+ *
+ * Decreases the reference count of @matcher, freeing it when it
+ * reaches zero.
+ *
+ * Since: 3.0
+ **/
+void
+hildon_matcher_unref                            (HildonMatcher *matcher)
+{
+  guint i;
+
+  g_return_if_fail (matcher != NULL);
+
+  if (!g_atomic_int_dec_and_test (&matcher->ref_count))
+    return;
+
+  for (i = 0; i < matcher->n_words; i++)
+    g_free (matcher->words[i].chars);
+  g_free (matcher->words);
+  g_slice_free (HildonMatcher, matcher);
+}
+
+static gboolean
+matcher_match                                   (const HildonStripTable *table,
+                                                 HildonMatcher          *matcher,
+                                                 const gchar            *haystack,
+                                                 gint                   *start,
+                                                 gint                   *end)
+{
+  gboolean anchored = (matcher->flags & HILDON_MATCHER_STRING_PREFIX) != 0;
+  guint i;
+
+  *start = *end = 0;
+
+  for (i = 0; i < matcher->n_words; i++) {
+    gint word_start, word_end;
+
+    if (!matcher_word_match (table, &matcher->words[i], haystack,
+                             anchored, &word_start, &word_end))
+      return FALSE;
+
+    if (i == 0) {
+      *start = word_start;
+      *end = word_end;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+ * hildon_matcher_match:
+ * @matcher: a #HildonMatcher
+ * @haystack: the string to search in
+ * @start: (out) (allow-none): return location for the byte offset where
+ * the first word of the needle was found, or %NULL
+ * @end: (out) (allow-none): return location for the byte offset following
+ * the first word of the needle, or %NULL
+ *
+ * Searches the needle of @matcher in @haystack. A needle without any
+ * searchable character matches everything, in which case @start and
+ * @end are both set to 0.
+ *
+ * Returns: %TRUE if @haystack matches
+ *
+ * Since: 3.0
+ **/
+gboolean
+hildon_matcher_match                            (HildonMatcher *matcher,
+                                                 const gchar   *haystack,
+                                                 gint          *start,
+                                                 gint          *end)
+{
+  gint first_start, first_end;
+
+  g_return_val_if_fail (matcher != NULL, FALSE);
+
+  if (haystack == NULL)
+    return FALSE;
+
+  if (!matcher_match (strip_table_get (), matcher, haystack,
+                      &first_start, &first_end))
+    return FALSE;
+
+  if (start)
+    *start = first_start;
+  if (end)
+    *end = first_end;
+
+  return TRUE;
+}
+
+/**
+ * hildon_matcher_match_all:
+ * @matcher: a #HildonMatcher
+ * @haystacks: (array length=n_haystacks): the strings to search in
+ * @n_haystacks: the number of strings in @haystacks, or -1 if
+ * @haystacks is %NULL-terminated
+ *
+ * Searches the needle of @matcher in each of @haystacks, as
+ * hildon_matcher_match() does, for instance in all the rows of a
+ * model at once. %NULL haystacks never match.
+ *
+ * Returns: (transfer full) (element-type HildonMatchRange): a #GArray
+ * with one #HildonMatchRange for each haystack, in the same order,
+ * holding where the first word of the needle was found, or -1 as
+ * both @start and @end if the haystack does not match. Free it with
+ * g_array_unref().
+ *
+ * Since: 3.0
+ **/
+GArray *
+hildon_matcher_match_all                        (HildonMatcher      *matcher,
+                                                 const gchar* const *haystacks,
+                                                 gint                n_haystacks)
+{
+  const HildonStripTable *table;
+  GArray *ranges;
+  gint i;
+
+  g_return_val_if_fail (matcher != NULL, NULL);
+  g_return_val_if_fail (haystacks != NULL || n_haystacks == 0, NULL);
+
+  if (n_haystacks < 0)
+    n_haystacks = g_strv_length ((gchar **) haystacks);
+
+  table = strip_table_get ();
+  ranges = g_array_sized_new (FALSE, FALSE, sizeof (HildonMatchRange),
+                              n_haystacks);
+
+  for (i = 0; i < n_haystacks; i++) {
+    HildonMatchRange range;
+
+    if (haystacks[i] == NULL ||
+        !matcher_match (table, matcher, haystacks[i],
+                        &range.start, &range.end))
+      range.start = range.end = -1;
+
+    g_array_append_val (ranges, range);
+  }
+
+  return ranges;
+}
+
+static gint
+match_range_compare                             (gconstpointer a,
+                                                 gconstpointer b)
+{
+  const HildonMatchRange *range1 = a;
+  const HildonMatchRange *range2 = b;
+
+  return range1->start - range2->start;
+}
+
+/**
+ * hildon_matcher_match_words:
+ * @matcher: a #HildonMatcher
+ * @haystack: the string to search in
+ *
+ * Searches every word of the needle of @matcher in @haystack, and
+ * returns where each of them was found, which is useful to highlight
+ * the matched text.
+ *
+ * Returns: (transfer full) (element-type HildonMatchRange): a #GArray of
+ * #HildonMatchRange sorted by position, with one element for each word
+ * of the needle, or %NULL if @haystack does not match. Free it with
+ * g_array_unref().
+ *
+ * Since: 3.0
+ **/
+GArray *
+hildon_matcher_match_words                      (HildonMatcher *matcher,
+                                                 const gchar   *haystack)
+{
+  const HildonStripTable *table;
+  gboolean anchored;
+  GArray *ranges;
+  guint i;
+
+  g_return_val_if_fail (matcher != NULL, NULL);
+
+  if (haystack == NULL)
+    return NULL;
+
+  table = strip_table_get ();
+  anchored = (matcher->flags & HILDON_MATCHER_STRING_PREFIX) != 0;
+  ranges = g_array_sized_new (FALSE, FALSE, sizeof (HildonMatchRange),
+                              matcher->n_words);
+
+  for (i = 0; i < matcher->n_words; i++) {
+    HildonMatchRange range;
+
+    if (!matcher_word_match (table, &matcher->words[i], haystack,
+                             anchored, &range.start, &range.end)) {
+      g_array_unref (ranges);
+      return NULL;
+    }
+
+    g_array_append_val (ranges, range);
+  }
+
+  g_array_sort (ranges, match_range_compare);
+
+  return ranges;
+}
@@ -76,6 +76,81 @@ gchar *
 hildon_helper_smart_match                       (const gchar *haystack,
                                                  const gchar *needle);
 
+/**
+ * HildonMatcherFlags:
+ * @HILDON_MATCHER_FLAGS_NONE: the needle is searched at the start of every
+ * word of the haystack
+ * @HILDON_MATCHER_STRING_PREFIX: the needle is only searched at the start
+ * of the haystack
+ * @HILDON_MATCHER_SPLIT_WORDS: each space separated word of the needle is
+ * searched separately, and all of them must be found
+ *
+ * Flags that change how a #HildonMatcher searches its needle.
+ *
+ * Since: 3.0
+ **/
+typedef enum {
+  HILDON_MATCHER_FLAGS_NONE = 0,
+  HILDON_MATCHER_STRING_PREFIX = 1 << 0,
+  HILDON_MATCHER_SPLIT_WORDS = 1 << 1
+} HildonMatcherFlags;
+
+/**
+ * HildonMatcher:
+ *
+ * A needle prepared once to be searched in many strings. The contents
+ * of this structure are private.
+ *
+ * Since: 3.0
+ **/
+typedef struct                                  _HildonMatcher HildonMatcher;
+
+/**
+ * HildonMatchRange:
+ * @start: byte offset of the first matched character
+ * @end: byte offset following the last matched character
+ *
+ * The location of a match found by hildon_matcher_match_all() or
+ * hildon_matcher_match_words().
+ *
+ * Since: 3.0
+ **/
+typedef struct {
+  gint start;
+  gint end;
+} HildonMatchRange;
+
+#define                                         HILDON_TYPE_MATCHER \
+                                                (hildon_matcher_get_type ())
+
+GType
+hildon_matcher_get_type                         (void) G_GNUC_CONST;
+
+HildonMatcher *
+hildon_matcher_new                              (const gchar        *needle,
+                                                 HildonMatcherFlags  flags);
+
+HildonMatcher *
+hildon_matcher_ref                              (HildonMatcher *matcher);
+
+void
+hildon_matcher_unref                            (HildonMatcher *matcher);
+
+gboolean
+hildon_matcher_match                            (HildonMatcher *matcher,
+                                                 const gchar   *haystack,
+                                                 gint          *start,
+                                                 gint          *end);
+
+GArray *
+hildon_matcher_match_all                        (HildonMatcher      *matcher,
+                                                 const gchar* const *haystacks,
+                                                 gint                n_haystacks);
+
+GArray *
+hildon_matcher_match_words                      (HildonMatcher *matcher,
+                                                 const gchar   *haystack);
+
 G_END_DECLS
 
 #endif                                          /* __HILDON_HELPER_H__ */
@@ -30,7 +30,8 @@
  * hildon_live_search_set_filter(). By default, #HildonLiveSearch
  * filters on the child model of the filter model set using a case
  * sensitive prefix comparison on the model's column specified by
- * #HildonLiveSearch:text-column. If a more refined filtering is
+ * #HildonLiveSearch:text-column, after Unicode normalization of both
+ * strings. If a more refined filtering is
  * necessary, you can use hildon_live_search_set_visible_func() to
  * specify a #HildonLiveSearchVisibleFunc to use.
  *
@@ -48,6 +49,8 @@ G_DEFINE_TYPE (HildonLiveSearch, hildon_live_search, GTK_TYPE_TOOLBAR);
                                                 HILDON_TYPE_LIVE_SEARCH,           \
                                                 HildonLiveSearchPrivate))
 
+typedef struct _SearchSnapshot SearchSnapshot;
+
 struct _HildonLiveSearchPrivate
 {
     GtkTreeModelFilter *filter;
@@ -57,6 +60,7 @@ struct _HildonLiveSearchPrivate
     GtkWidget *entry;
     GtkWidget *event_widget;
     GHashTable *selection_map;
+    gboolean selection_by_iter;
 
     gulong key_press_id;
     gulong event_widget_destroy_id;
@@ -64,6 +68,7 @@ struct _HildonLiveSearchPrivate
     gulong idle_filter_id;
 
     gchar *prefix;
+    gchar *prefix_key;          /* normalized prefix, for the text column */
     gint text_column;
 
     HildonLiveSearchVisibleFunc visible_func;
@@ -71,6 +76,26 @@ struct _HildonLiveSearchPrivate
     GDestroyNotify visible_destroy;
     gboolean visible_func_set;
     gboolean run_async;
+
+    gboolean indexed;
+    gboolean index_dirty;
+    gboolean refiltering;
+    GtkTreeModel *index_model;
+    GHashTable *index_rows;
+    GPtrArray *index_sorted;
+    GPtrArray *index_positions;
+    guint match_start;
+    guint match_end;
+    gchar *match_prefix;
+
+    gboolean threaded;
+    GtkTreeModel *snapshot_model;
+    SearchSnapshot *snapshot;
+    GHashTable *snapshot_changes;
+    guint snapshot_n_deleted;
+    GCancellable *filter_cancellable;
+    guint32 *thread_bitmap;
+    const gchar *thread_prefix;
 };
 
 enum
@@ -80,7 +105,9 @@ enum
     PROP_FILTER,
     PROP_WIDGET,
     PROP_TEXT_COLUMN,
-    PROP_TEXT
+    PROP_TEXT,
+    PROP_INDEXED,
+    PROP_THREADED
 };
 
 enum
@@ -98,17 +125,34 @@ visible_func                                    (GtkTreeModel *model,
 
 /* Private implementation */
 
+/* Rows of #GtkListStore and #GtkTreeStore can be identified by the
+ * user_data field of their iters alone, which stays the same as long
+ * as the row exists. These models leave the other fields of the iter
+ * unset, so only user_data may be used as the key of a row. */
+#define                                         ROW_KEY(iter) ((iter)->user_data)
+
+static gboolean
+model_has_row_keys                              (GtkTreeModel *model)
+{
+    return GTK_IS_LIST_STORE (model) || GTK_IS_TREE_STORE (model);
+}
+
 static guint
 hash_func                                       (gconstpointer key)
 {
     GtkTreePath *path;
-    gchar *path_str;
-    guint val;
+    gint *indices;
+    gint depth, i;
+    guint val = 0;
 
     path = gtk_tree_row_reference_get_path ((GtkTreeRowReference *) key);
-    path_str = gtk_tree_path_to_string (path);
-    val = g_str_hash (path_str);
-    g_free (path_str);
+    if (path == NULL)
+        return 0;
+
+    indices = gtk_tree_path_get_indices_with_depth (path, &depth);
+    for (i = 0; i < depth; i++)
+        val = (val << 5) - val + indices[i];
+
     gtk_tree_path_free (path);
 
     return val;
@@ -124,7 +168,8 @@ key_equal_func                                  (gconstpointer v1,
 
     path1 = gtk_tree_row_reference_get_path ((GtkTreeRowReference *) v1);
     path2 = gtk_tree_row_reference_get_path ((GtkTreeRowReference *) v2);
-    ret = gtk_tree_path_compare (path1, path2) == 0;
+    ret = path1 != NULL && path2 != NULL &&
+        gtk_tree_path_compare (path1, path2) == 0;
 
     gtk_tree_path_free (path1);
     gtk_tree_path_free (path2);
@@ -132,25 +177,55 @@ key_equal_func                                  (gconstpointer v1,
     return ret;
 }
 
+/* A selected row of the child model, when rows are tracked by iter
+ * (see ROW_KEY). The row reference tells whether the iter is still
+ * valid: once the row is removed, the model may hand out the same
+ * user_data to a new row. */
+typedef struct
+{
+    GtkTreeIter iter;
+    GtkTreeRowReference *row_ref;
+} SelectionEntry;
+
+static void
+selection_entry_free                            (SelectionEntry *entry)
+{
+    gtk_tree_row_reference_free (entry->row_ref);
+    g_slice_free (SelectionEntry, entry);
+}
+
 /**
  * selection_map_create:
  * @priv: The private pimpl
  *
  * Adds a selection map which is useful when merging selected rows in
  * a treeview, when the live search widget is used.
+ *
+ * Rows of list and tree stores are tracked by iter, which makes every
+ * lookup in the map constant time and allocation-free. For other
+ * models, rows are tracked by path.
  **/
 static void
 selection_map_create                            (HildonLiveSearchPrivate *priv)
 {
+    GtkTreeModel *base_model;
+
     if (!GTK_IS_TREE_VIEW (priv->kb_focus_widget))
         return;
 
     g_assert (priv->selection_map == NULL);
 
-    priv->selection_map = g_hash_table_new_full
-        (hash_func, key_equal_func,
-         (GDestroyNotify) gtk_tree_row_reference_free, NULL);
-
+    base_model = gtk_tree_model_filter_get_model (priv->filter);
+    priv->selection_by_iter = model_has_row_keys (base_model);
+
+    if (priv->selection_by_iter)
+        priv->selection_map = g_hash_table_new_full
+            (NULL, NULL,
+             NULL, (GDestroyNotify) selection_entry_free);
+    else
+        priv->selection_map = g_hash_table_new_full
+            (hash_func, key_equal_func,
+             (GDestroyNotify) gtk_tree_row_reference_free, NULL);
 }
 
 /**
@@ -206,6 +281,52 @@ convert_path_to_child_path (GtkTreeModel *model,
       (GTK_TREE_MODEL_SORT (model), path);
 }
 
+/* Converts an iter of the tree view model to one of the child model of
+ * the filter. */
+static void
+view_iter_to_base_iter (HildonLiveSearchPrivate *priv,
+                        GtkTreeIter *view_iter,
+                        GtkTreeIter *base_iter)
+{
+  GtkTreeModel *model = gtk_tree_view_get_model (GTK_TREE_VIEW (priv->kb_focus_widget));
+  GtkTreeIter filter_iter;
+
+  if (model == GTK_TREE_MODEL (priv->filter)) {
+      filter_iter = *view_iter;
+  } else {
+      g_assert (GTK_IS_TREE_MODEL_SORT (model));
+      gtk_tree_model_sort_convert_iter_to_child_iter
+          (GTK_TREE_MODEL_SORT (model), &filter_iter, view_iter);
+  }
+
+  gtk_tree_model_filter_convert_iter_to_child_iter
+      (priv->filter, base_iter, &filter_iter);
+}
+
+/* Converts an iter of the child model of the filter to one of the tree
+ * view model. Returns FALSE if the row is filtered out. */
+static gboolean
+base_iter_to_view_iter (HildonLiveSearchPrivate *priv,
+                        GtkTreeIter *base_iter,
+                        GtkTreeIter *view_iter)
+{
+  GtkTreeModel *model = gtk_tree_view_get_model (GTK_TREE_VIEW (priv->kb_focus_widget));
+  GtkTreeIter filter_iter;
+
+  if (!gtk_tree_model_filter_convert_child_iter_to_iter
+      (priv->filter, &filter_iter, base_iter))
+      return FALSE;
+
+  if (model == GTK_TREE_MODEL (priv->filter)) {
+      *view_iter = filter_iter;
+      return TRUE;
+  }
+
+  g_assert (GTK_IS_TREE_MODEL_SORT (model));
+  return gtk_tree_model_sort_convert_child_iter_to_iter
+      (GTK_TREE_MODEL_SORT (model), view_iter, &filter_iter);
+}
+
 static gboolean
 row_reference_is_not_selected (GtkTreeRowReference *row_ref,
                                gpointer value,
@@ -235,174 +356,1147 @@ row_reference_is_not_selected (GtkTreeRowReference *row_ref,
       gtk_tree_view_get_model (GTK_TREE_VIEW (priv->kb_focus_widget)),
               GTK_TREE_MODEL (priv->filter), filter_path);
 
-  ret = ! gtk_tree_selection_path_is_selected (selection, view_path);
+  ret = ! gtk_tree_selection_path_is_selected (selection, view_path);
+
+  gtk_tree_path_free (base_path);
+  gtk_tree_path_free (filter_path);
+  gtk_tree_path_free (view_path);
+
+  return ret;
+}
+
+static gboolean
+selection_entry_is_not_selected (gpointer key,
+                                 SelectionEntry *entry,
+                                 HildonLiveSearchPrivate *priv)
+{
+  GtkTreeSelection *selection = gtk_tree_view_get_selection (
+      GTK_TREE_VIEW (priv->kb_focus_widget));
+  GtkTreeIter view_iter;
+
+  if (!gtk_tree_row_reference_valid (entry->row_ref))
+      return TRUE;
+
+  /* Rows which are filtered out keep their selection state */
+  if (!base_iter_to_view_iter (priv, &entry->iter, &view_iter))
+      return FALSE;
+
+  return ! gtk_tree_selection_iter_is_selected (selection, &view_iter);
+}
+
+static void
+selection_map_add_selected (GtkTreeModel *model,
+                            GtkTreePath *view_path,
+                            GtkTreeIter *view_iter,
+                            HildonLiveSearchPrivate *priv)
+{
+  GtkTreeModel *base_model = gtk_tree_model_filter_get_model (priv->filter);
+  SelectionEntry *entry;
+  GtkTreeIter base_iter;
+  GtkTreePath *base_path;
+
+  view_iter_to_base_iter (priv, view_iter, &base_iter);
+
+  entry = g_hash_table_lookup (priv->selection_map, ROW_KEY (&base_iter));
+  if (entry != NULL && gtk_tree_row_reference_valid (entry->row_ref))
+      return;
+
+  base_path = gtk_tree_model_get_path (base_model, &base_iter);
+
+  entry = g_slice_new (SelectionEntry);
+  entry->iter = base_iter;
+  entry->row_ref = gtk_tree_row_reference_new (base_model, base_path);
+  g_hash_table_replace (priv->selection_map, ROW_KEY (&entry->iter), entry);
+
+  gtk_tree_path_free (base_path);
+}
+
+/**
+ * selection_map_update_map_from_selection:
+ * @priv: The private pimpl
+ *
+ * Find out which rows are visible in filter, and mark them as selected
+ * or unselected from treeview to selection map.
+ **/
+static void
+selection_map_update_map_from_selection         (HildonLiveSearchPrivate *priv)
+{
+    GtkTreeModel *base_model;
+    GtkTreeSelection *selection;
+    GList *selected_list, *l_iter;
+
+    if (!GTK_IS_TREE_VIEW (priv->kb_focus_widget))
+        return;
+
+    base_model = gtk_tree_model_filter_get_model (priv->filter);
+    selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (priv->kb_focus_widget));
+
+    if (priv->selection_by_iter) {
+        g_hash_table_foreach_remove (priv->selection_map,
+                                     (GHRFunc) selection_entry_is_not_selected,
+                                     priv);
+        gtk_tree_selection_selected_foreach (selection,
+                                             (GtkTreeSelectionForeachFunc) selection_map_add_selected,
+                                             priv);
+        return;
+    }
+
+    /* Remove all items from priv->selection_map which are not selected */
+    g_hash_table_foreach_remove (priv->selection_map,
+                                 (GHRFunc) row_reference_is_not_selected, priv);
+
+    /* fill priv->selection_map from gtk_tree_selection_get_selected_rows()*/
+    selected_list = l_iter = gtk_tree_selection_get_selected_rows (selection,
+                                                                 NULL);
+    while (l_iter) {
+        GtkTreePath *view_path = l_iter->data;
+        GtkTreePath *base_path, *filter_path;
+        GtkTreeRowReference *row_ref;
+
+        filter_path = convert_path_to_child_path (
+            gtk_tree_view_get_model (GTK_TREE_VIEW (priv->kb_focus_widget)),
+            GTK_TREE_MODEL (priv->filter), view_path);
+        base_path = gtk_tree_model_filter_convert_path_to_child_path
+          (priv->filter, filter_path);
+
+        row_ref = gtk_tree_row_reference_new (base_model, base_path);
+        g_hash_table_replace (priv->selection_map,
+                              row_ref, NULL);
+        gtk_tree_path_free (view_path);
+        gtk_tree_path_free (filter_path);
+        gtk_tree_path_free (base_path);
+        selected_list->data = NULL;
+        l_iter = g_list_next (l_iter);
+    }
+    g_list_free (selected_list);
+}
+
+static void
+collect_unmapped_selected (GtkTreeModel *model,
+                           GtkTreePath *view_path,
+                           GtkTreeIter *view_iter,
+                           gpointer data)
+{
+  HildonLiveSearchPrivate *priv = ((gpointer *) data)[0];
+  GArray *unselect = ((gpointer *) data)[1];
+  SelectionEntry *entry;
+  GtkTreeIter base_iter;
+
+  view_iter_to_base_iter (priv, view_iter, &base_iter);
+
+  entry = g_hash_table_lookup (priv->selection_map, ROW_KEY (&base_iter));
+  if (entry == NULL || !gtk_tree_row_reference_valid (entry->row_ref))
+      g_array_append_val (unselect, *view_iter);
+}
+
+static void
+selection_map_update_selection_from_iters       (HildonLiveSearchPrivate *priv)
+{
+    GtkTreeSelection *selection;
+    GHashTableIter iter;
+    SelectionEntry *entry;
+    GArray *unselect;
+    gpointer data[2];
+    guint i;
+
+    selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (priv->kb_focus_widget));
+
+    /* unselect things which are not in priv->selection_map. The
+     * selection cannot change while it is being traversed. */
+    unselect = g_array_new (FALSE, FALSE, sizeof (GtkTreeIter));
+    data[0] = priv;
+    data[1] = unselect;
+    gtk_tree_selection_selected_foreach (selection,
+                                         collect_unmapped_selected, data);
+    for (i = 0; i < unselect->len; i++)
+        gtk_tree_selection_unselect_iter
+            (selection, &g_array_index (unselect, GtkTreeIter, i));
+    g_array_free (unselect, TRUE);
+
+    /* going though priv->selection_map to select items */
+    g_hash_table_iter_init (&iter, priv->selection_map);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &entry)) {
+        GtkTreeIter view_iter;
+
+        if (!gtk_tree_row_reference_valid (entry->row_ref)) {
+            g_hash_table_iter_remove (&iter);
+            continue;
+        }
+
+        if (base_iter_to_view_iter (priv, &entry->iter, &view_iter))
+            gtk_tree_selection_select_iter (selection, &view_iter);
+    }
+}
+
+/**
+ * selection_map_update_selection_from_map:
+ * @priv: The private pimpl
+ *
+ * For currently visible rows in filter, set selection from selection
+ * map to treeview.
+ **/
+static void
+selection_map_update_selection_from_map         (HildonLiveSearchPrivate *priv)
+{
+    GtkTreeSelection *selection;
+    GList *selected_list, *l_iter;
+
+    if (!GTK_IS_TREE_VIEW (priv->kb_focus_widget))
+        return;
+
+    if (priv->selection_by_iter) {
+        selection_map_update_selection_from_iters (priv);
+        return;
+    }
+
+    selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (priv->kb_focus_widget));
+
+    /* unselect things which are not in priv->selection_map */
+    selected_list = l_iter = gtk_tree_selection_get_selected_rows (selection,
+                                                                 NULL);
+    while (l_iter) {
+        GtkTreePath *view_path = l_iter->data;
+        GtkTreePath *base_path, *filter_path;
+        GtkTreeRowReference *row_ref;
+
+        filter_path = convert_path_to_child_path (
+            gtk_tree_view_get_model (GTK_TREE_VIEW (priv->kb_focus_widget)),
+            GTK_TREE_MODEL (priv->filter), view_path);
+        base_path = gtk_tree_model_filter_convert_path_to_child_path
+            (priv->filter, filter_path);
+
+        /* A temporary reference hashes and compares like the stored
+         * ones, so the lookup goes through the hash table. */
+        row_ref = gtk_tree_row_reference_new
+            (gtk_tree_model_filter_get_model (priv->filter), base_path);
+        if (!g_hash_table_contains (priv->selection_map, row_ref))
+            gtk_tree_selection_unselect_path
+                (selection, view_path);
+        gtk_tree_row_reference_free (row_ref);
+
+        gtk_tree_path_free (view_path);
+        gtk_tree_path_free (filter_path);
+        gtk_tree_path_free (base_path);
+        l_iter->data = NULL;
+
+        l_iter = g_list_next (l_iter);
+    }
+    g_list_free (selected_list);
+
+    /* going though priv->selection_map to select items */
+    GHashTableIter iter;
+    gpointer key, value;
+
+    g_hash_table_iter_init (&iter, priv->selection_map);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+        GtkTreeRowReference *row_ref = key;
+        GtkTreePath *base_path = gtk_tree_row_reference_get_path (row_ref);
+        GtkTreePath *filter_path;
+        GtkTreePath *view_path;
+
+        if (base_path == NULL)
+            continue;
+
+        filter_path = gtk_tree_model_filter_convert_child_path_to_path
+          (priv->filter, base_path);
+        gtk_tree_path_free (base_path);
+
+        if (filter_path == NULL)
+            continue;
+
+        view_path = convert_child_path_to_path (
+            gtk_tree_view_get_model (GTK_TREE_VIEW (priv->kb_focus_widget)),
+            GTK_TREE_MODEL (priv->filter), filter_path);
+
+        gtk_tree_selection_select_path (selection, view_path);
+
+        gtk_tree_path_free (filter_path);
+        gtk_tree_path_free (view_path);
+    }
+}
+
+/* Indexed filtering engine.
+ *
+ * When #HildonLiveSearch:indexed is set, the text column of the child
+ * model is kept in an array sorted by its normalized contents.  All
+ * the rows starting with a given prefix are then contiguous in that
+ * array, and can be found with two binary searches.  Extending the
+ * prefix only narrows the previous range, so typing one more
+ * character never rescans the whole model.
+ *
+ * Rows are identified by their iters (see ROW_KEY), so only list and
+ * tree stores are indexed.  For list-only models the
+ * rows are additionally tracked by position, which lets deletions and
+ * reorderings be applied incrementally; any other model is simply
+ * reindexed after a row is removed. */
+
+typedef struct
+{
+    GtkTreeIter iter;
+    gchar *key;
+    gboolean visible;
+} IndexEntry;
+
+static void
+index_entry_free                                (IndexEntry *entry)
+{
+    g_free (entry->key);
+    g_slice_free (IndexEntry, entry);
+}
+
+static gchar *
+index_normalize                                 (const gchar *text)
+{
+    if (text == NULL)
+        return NULL;
+
+    return g_utf8_normalize (text, -1, G_NORMALIZE_DEFAULT);
+}
+
+static gchar *
+index_get_key                                   (HildonLiveSearchPrivate *priv,
+                                                 GtkTreeIter             *iter)
+{
+    gchar *string;
+    gchar *key;
+
+    gtk_tree_model_get (priv->index_model, iter, priv->text_column, &string, -1);
+    key = index_normalize (string);
+    g_free (string);
+
+    return key;
+}
+
+static gint
+index_compare                                   (gconstpointer a,
+                                                 gconstpointer b)
+{
+    const IndexEntry *entry1 = *(IndexEntry **) a;
+    const IndexEntry *entry2 = *(IndexEntry **) b;
+
+    return strcmp (entry1->key, entry2->key);
+}
+
+/* Returns the first position in [start, end) whose key compares
+ * greater or equal (or strictly greater, if @after is set) to the
+ * first @len bytes of @key.  Comparing only @len bytes keeps the
+ * ordering monotonic, so all the keys sharing a prefix form one run. */
+static guint
+index_search                                    (GPtrArray   *sorted,
+                                                 guint        start,
+                                                 guint        end,
+                                                 const gchar *key,
+                                                 gsize        len,
+                                                 gboolean     after)
+{
+    while (start < end) {
+        guint middle = start + (end - start) / 2;
+        IndexEntry *entry = g_ptr_array_index (sorted, middle);
+        gint cmp = strncmp (entry->key, key, len);
+
+        if (cmp < 0 || (after && cmp == 0))
+            start = middle + 1;
+        else
+            end = middle;
+    }
+
+    return start;
+}
+
+static void
+index_reset_matches                             (HildonLiveSearchPrivate *priv)
+{
+    guint i;
+
+    for (i = priv->match_start; i < priv->match_end; i++) {
+        IndexEntry *entry = g_ptr_array_index (priv->index_sorted, i);
+        entry->visible = FALSE;
+    }
+
+    priv->match_start = priv->match_end = 0;
+
+    g_free (priv->match_prefix);
+    priv->match_prefix = NULL;
+}
+
+static void
+index_sorted_insert                             (HildonLiveSearchPrivate *priv,
+                                                 IndexEntry              *entry)
+{
+    guint pos;
+
+    if (entry->key == NULL)
+        return;
+
+    pos = index_search (priv->index_sorted, 0, priv->index_sorted->len,
+                        entry->key, strlen (entry->key) + 1, FALSE);
+    g_ptr_array_insert (priv->index_sorted, pos, entry);
+}
+
+static void
+index_sorted_remove                             (HildonLiveSearchPrivate *priv,
+                                                 IndexEntry              *entry)
+{
+    guint pos;
+
+    if (entry->key == NULL)
+        return;
+
+    pos = index_search (priv->index_sorted, 0, priv->index_sorted->len,
+                        entry->key, strlen (entry->key) + 1, FALSE);
+    while (pos < priv->index_sorted->len &&
+           g_ptr_array_index (priv->index_sorted, pos) != entry)
+        pos++;
+
+    g_assert (pos < priv->index_sorted->len);
+    g_ptr_array_remove_index (priv->index_sorted, pos);
+}
+
+static IndexEntry *
+index_add_row                                   (HildonLiveSearchPrivate *priv,
+                                                 GtkTreeIter             *iter)
+{
+    IndexEntry *entry;
+
+    entry = g_slice_new (IndexEntry);
+    entry->iter = *iter;
+    entry->key = index_get_key (priv, iter);
+    entry->visible = FALSE;
+
+    g_hash_table_insert (priv->index_rows, ROW_KEY (&entry->iter), entry);
+
+    return entry;
+}
+
+static void
+on_index_row_inserted                           (GtkTreeModel *model,
+                                                 GtkTreePath  *path,
+                                                 GtkTreeIter  *iter,
+                                                 gpointer      data)
+{
+    HildonLiveSearchPrivate *priv = data;
+    IndexEntry *entry;
+
+    if (priv->index_dirty)
+        return;
+
+    index_reset_matches (priv);
+
+    entry = index_add_row (priv, iter);
+    if (priv->index_positions)
+        g_ptr_array_insert (priv->index_positions,
+                            gtk_tree_path_get_indices (path)[0], entry);
+    index_sorted_insert (priv, entry);
+}
+
+static void
+on_index_row_changed                            (GtkTreeModel *model,
+                                                 GtkTreePath  *path,
+                                                 GtkTreeIter  *iter,
+                                                 gpointer      data)
+{
+    HildonLiveSearchPrivate *priv = data;
+    IndexEntry *entry;
+    gchar *key;
+
+    if (priv->index_dirty)
+        return;
+
+    entry = g_hash_table_lookup (priv->index_rows, ROW_KEY (iter));
+    if (entry == NULL) {
+        priv->index_dirty = TRUE;
+        return;
+    }
+
+    key = index_get_key (priv, iter);
+    if (g_strcmp0 (key, entry->key) == 0) {
+        g_free (key);
+        return;
+    }
+
+    index_reset_matches (priv);
+
+    index_sorted_remove (priv, entry);
+    g_free (entry->key);
+    entry->key = key;
+    index_sorted_insert (priv, entry);
+}
+
+static void
+on_index_row_deleted                            (GtkTreeModel *model,
+                                                 GtkTreePath  *path,
+                                                 gpointer      data)
+{
+    HildonLiveSearchPrivate *priv = data;
+    IndexEntry *entry;
+
+    if (priv->index_dirty)
+        return;
+
+    /* The row is already gone, so without positions there is no way
+     * of telling which entry it was. */
+    if (priv->index_positions == NULL) {
+        priv->index_dirty = TRUE;
+        return;
+    }
+
+    index_reset_matches (priv);
+
+    entry = g_ptr_array_remove_index (priv->index_positions,
+                                      gtk_tree_path_get_indices (path)[0]);
+    index_sorted_remove (priv, entry);
+    g_hash_table_remove (priv->index_rows, ROW_KEY (&entry->iter));
+}
+
+static void
+on_index_rows_reordered                         (GtkTreeModel *model,
+                                                 GtkTreePath  *path,
+                                                 GtkTreeIter  *iter,
+                                                 gint         *new_order,
+                                                 gpointer      data)
+{
+    HildonLiveSearchPrivate *priv = data;
+    GPtrArray *positions;
+    guint i;
+
+    if (priv->index_dirty || priv->index_positions == NULL)
+        return;
+
+    positions = g_ptr_array_sized_new (priv->index_positions->len);
+    for (i = 0; i < priv->index_positions->len; i++)
+        g_ptr_array_add (positions,
+                         g_ptr_array_index (priv->index_positions, new_order[i]));
+
+    g_ptr_array_free (priv->index_positions, TRUE);
+    priv->index_positions = positions;
+}
+
+static gboolean
+index_add_row_foreach                           (GtkTreeModel *model,
+                                                 GtkTreePath  *path,
+                                                 GtkTreeIter  *iter,
+                                                 gpointer      data)
+{
+    HildonLiveSearchPrivate *priv = data;
+    IndexEntry *entry;
+
+    entry = index_add_row (priv, iter);
+    if (priv->index_positions)
+        g_ptr_array_add (priv->index_positions, entry);
+    if (entry->key)
+        g_ptr_array_add (priv->index_sorted, entry);
+
+    return FALSE;
+}
+
+static void
+index_clear                                     (HildonLiveSearchPrivate *priv)
+{
+    if (priv->index_rows == NULL)
+        return;
+
+    if (priv->index_positions) {
+        g_ptr_array_free (priv->index_positions, TRUE);
+        priv->index_positions = NULL;
+    }
+
+    g_ptr_array_free (priv->index_sorted, TRUE);
+    priv->index_sorted = NULL;
+
+    g_hash_table_destroy (priv->index_rows);
+    priv->index_rows = NULL;
+
+    priv->match_start = priv->match_end = 0;
+    g_free (priv->match_prefix);
+    priv->match_prefix = NULL;
+}
+
+static void
+index_populate                                  (HildonLiveSearchPrivate *priv)
+{
+    gint n_rows;
+
+    n_rows = gtk_tree_model_iter_n_children (priv->index_model, NULL);
+
+    priv->index_rows = g_hash_table_new_full (NULL,
+                                              NULL,
+                                              NULL,
+                                              (GDestroyNotify) index_entry_free);
+    priv->index_sorted = g_ptr_array_sized_new (n_rows);
+    if (gtk_tree_model_get_flags (priv->index_model) & GTK_TREE_MODEL_LIST_ONLY)
+        priv->index_positions = g_ptr_array_sized_new (n_rows);
+
+    gtk_tree_model_foreach (priv->index_model, index_add_row_foreach, priv);
+    g_ptr_array_sort (priv->index_sorted, index_compare);
+
+    priv->index_dirty = FALSE;
+}
+
+static void
+index_destroy                                   (HildonLiveSearchPrivate *priv)
+{
+    index_clear (priv);
+
+    if (priv->index_model) {
+        g_signal_handlers_disconnect_by_data (priv->index_model, priv);
+        g_object_unref (priv->index_model);
+        priv->index_model = NULL;
+    }
+}
+
+/**
+ * index_ensure:
+ * @priv: The private pimpl
+ *
+ * Builds the index of the text column if indexing is enabled and
+ * possible for the current model, or rebuilds it if it went stale.
+ *
+ * Returns: whether the index can be used for filtering.
+ **/
+static gboolean
+index_usable                                    (HildonLiveSearchPrivate *priv)
+{
+    return priv->indexed && priv->filter != NULL &&
+        priv->text_column != -1 && priv->visible_func == NULL &&
+        model_has_row_keys (gtk_tree_model_filter_get_model (priv->filter));
+}
+
+static gboolean
+index_ensure                                    (HildonLiveSearchPrivate *priv)
+{
+    GtkTreeModel *model;
+
+    if (!index_usable (priv))
+        return FALSE;
+
+    model = gtk_tree_model_filter_get_model (priv->filter);
+
+    if (priv->index_model != model) {
+        index_destroy (priv);
+
+        priv->index_model = g_object_ref (model);
+        g_signal_connect (model, "row-inserted",
+                          G_CALLBACK (on_index_row_inserted), priv);
+        g_signal_connect (model, "row-changed",
+                          G_CALLBACK (on_index_row_changed), priv);
+        g_signal_connect (model, "row-deleted",
+                          G_CALLBACK (on_index_row_deleted), priv);
+        g_signal_connect (model, "rows-reordered",
+                          G_CALLBACK (on_index_rows_reordered), priv);
+    } else if (priv->index_dirty) {
+        index_clear (priv);
+    }
+
+    if (priv->index_rows == NULL)
+        index_populate (priv);
+
+    return TRUE;
+}
+
+/**
+ * index_update_matches:
+ * @priv: The private pimpl
+ *
+ * Flags the indexed rows matching the current prefix as visible. If
+ * the prefix extends the previous one, only the previous matches are
+ * searched.
+ **/
+static void
+index_update_matches                            (HildonLiveSearchPrivate *priv)
+{
+    gchar *prefix;
+    guint start, end;
+    gsize len;
+    guint i;
+
+    prefix = g_strdup (priv->prefix_key);
+
+    if (prefix != NULL && priv->match_prefix != NULL &&
+        g_str_has_prefix (prefix, priv->match_prefix)) {
+        start = priv->match_start;
+        end = priv->match_end;
+    } else {
+        start = 0;
+        end = priv->index_sorted->len;
+    }
+
+    index_reset_matches (priv);
+
+    if (prefix == NULL)
+        return;
+
+    len = strlen (prefix);
+    start = index_search (priv->index_sorted, start, end, prefix, len, FALSE);
+    end = index_search (priv->index_sorted, start, end, prefix, len, TRUE);
+
+    for (i = start; i < end; i++) {
+        IndexEntry *entry = g_ptr_array_index (priv->index_sorted, i);
+        entry->visible = TRUE;
+    }
+
+    priv->match_start = start;
+    priv->match_end = end;
+    priv->match_prefix = prefix;
+}
+
+/**
+ * index_refilter:
+ * @priv: The private pimpl
+ *
+ * Shows and hides the rows whose match changed with the last call to
+ * index_update_matches(), instead of having the filter evaluate every
+ * row: only the rows shown so far and the current matches are looked
+ * at, and the filter is told about the others through row-changed.
+ *
+ * Returns: %FALSE if the rows cannot be found this way, in which case
+ * the whole filter must be refiltered.
+ **/
+static gboolean
+index_refilter                                  (HildonLiveSearchPrivate *priv)
+{
+    GtkTreeModel *model = GTK_TREE_MODEL (priv->filter);
+    GtkTreePath *virtual_root;
+    GArray *changed;
+    GtkTreeIter iter, child_iter;
+    gboolean valid;
+    guint i;
+
+    /* Only a list is all in the top level of the filter */
+    if (priv->index_positions == NULL || priv->prefix_key == NULL)
+        return FALSE;
+
+    g_object_get (priv->filter, "virtual-root", &virtual_root, NULL);
+    if (virtual_root != NULL) {
+        gtk_tree_path_free (virtual_root);
+        return FALSE;
+    }
+
+    changed = g_array_new (FALSE, FALSE, sizeof (GtkTreeIter));
+
+    /* Rows shown that do not match any more */
+    for (valid = gtk_tree_model_get_iter_first (model, &iter); valid;
+         valid = gtk_tree_model_iter_next (model, &iter)) {
+        IndexEntry *entry;
+
+        gtk_tree_model_filter_convert_iter_to_child_iter (priv->filter,
+                                                          &child_iter, &iter);
+        entry = g_hash_table_lookup (priv->index_rows, ROW_KEY (&child_iter));
+        if (entry == NULL || !entry->visible)
+            g_array_append_val (changed, child_iter);
+    }
+
+    /* Matches not shown yet */
+    for (i = priv->match_start; i < priv->match_end; i++) {
+        IndexEntry *entry = g_ptr_array_index (priv->index_sorted, i);
+
+        if (!gtk_tree_model_filter_convert_child_iter_to_iter (priv->filter,
+                                                               &iter, &entry->iter))
+            g_array_append_val (changed, entry->iter);
+    }
+
+    /* The filter is only changed once all the rows are known */
+    for (i = 0; i < changed->len; i++) {
+        GtkTreeIter *row = &g_array_index (changed, GtkTreeIter, i);
+        GtkTreePath *path = gtk_tree_model_get_path (priv->index_model, row);
+
+        gtk_tree_model_row_changed (priv->index_model, path, row);
+        gtk_tree_path_free (path);
+    }
+
+    g_array_free (changed, TRUE);
+
+    return TRUE;
+}
+
+static void
+refilter (HildonLiveSearch *livesearch)
+{
+    HildonLiveSearchPrivate *priv = livesearch->priv;
+    gboolean handled = FALSE;
+    gboolean needs_mapping;
+    gboolean indexed;
+
+    needs_mapping = GTK_IS_TREE_VIEW (priv->kb_focus_widget) &&
+        gtk_tree_selection_get_mode (gtk_tree_view_get_selection (
+                                         GTK_TREE_VIEW (priv->kb_focus_widget))) != GTK_SELECTION_NONE;
+
+    /* This is not pretty code, but it should fix some warnings in the case we
+       attempt to refilter before the treeview actually has a model. */
+    if (needs_mapping && !gtk_tree_view_get_model (GTK_TREE_VIEW (priv->kb_focus_widget)))
+        return;
+
+    /* Create/update selection map from current selection */
+    if (needs_mapping) {
+        if (priv->selection_map == NULL)
+            selection_map_create (priv);
+        selection_map_update_map_from_selection (priv);
+    }
+
+    /* Filter the model */
+    indexed = index_ensure (priv);
+    if (indexed)
+        index_update_matches (priv);
+
+    priv->refiltering = TRUE;
+    g_signal_emit (livesearch, signals[REFILTER], 0, &handled);
+    if (!handled && priv->filter &&
+        !(indexed && index_refilter (priv)))
+        gtk_tree_model_filter_refilter (priv->filter);
+    priv->refiltering = FALSE;
+
+    /* Restore selection from mapping */
+    if (needs_mapping)
+        selection_map_update_selection_from_map (priv);
+}
+
+/* Threaded filtering.
+ *
+ * When #HildonLiveSearch:threaded is set, the text column is copied
+ * into an immutable snapshot, and each change of the prefix is
+ * evaluated against it in a worker thread. A newer prefix cancels the
+ * job in flight. The resulting visibility bitmap is applied on the
+ * main thread with a single refilter, so the entry stays responsive
+ * while long lists are being filtered.
+ *
+ * Rows inserted or changed after the snapshot was taken are recorded
+ * with their normalized key and matched on the main thread, and removed
+ * rows are only counted. Once these changes make up a good part of the
+ * model, the snapshot is taken again before the next job, so its cost
+ * is spread over the changes instead of being paid on every keystroke. */
+
+#define                                         FILTER_JOB_CHECK_INTERVAL 1024
+
+#define                                         SNAPSHOT_MIN_CHANGES 256
+
+struct _SearchSnapshot
+{
+    gint ref_count;
+    guint n_rows;
+    gchar **keys;
+    GHashTable *rows;
+};
+
+typedef struct
+{
+    SearchSnapshot *snapshot;
+    gchar *prefix;
+} FilterJob;
+
+static SearchSnapshot *
+search_snapshot_ref                             (SearchSnapshot *snapshot)
+{
+    g_atomic_int_inc (&snapshot->ref_count);
+
+    return snapshot;
+}
+
+static void
+search_snapshot_unref                           (SearchSnapshot *snapshot)
+{
+    guint i;
+
+    if (!g_atomic_int_dec_and_test (&snapshot->ref_count))
+        return;
+
+    for (i = 0; i < snapshot->n_rows; i++)
+        g_free (snapshot->keys[i]);
+    g_free (snapshot->keys);
+    g_hash_table_destroy (snapshot->rows);
+    g_slice_free (SearchSnapshot, snapshot);
+}
+
+static gboolean
+search_snapshot_add_row                         (GtkTreeModel *model,
+                                                 GtkTreePath  *path,
+                                                 GtkTreeIter  *iter,
+                                                 gpointer      data)
+{
+    gpointer *args = data;
+    SearchSnapshot *snapshot = args[0];
+    HildonLiveSearchPrivate *priv = args[1];
+    gchar *string;
+
+    if (snapshot->n_rows % 256 == 0)
+        snapshot->keys = g_renew (gchar *, snapshot->keys, snapshot->n_rows + 256);
+
+    gtk_tree_model_get (model, iter, priv->text_column, &string, -1);
+    snapshot->keys[snapshot->n_rows] = index_normalize (string);
+    snapshot->n_rows++;
+    g_hash_table_insert (snapshot->rows, ROW_KEY (iter),
+                         GUINT_TO_POINTER (snapshot->n_rows));
+    g_free (string);
+
+    return FALSE;
+}
+
+static SearchSnapshot *
+search_snapshot_new                             (HildonLiveSearchPrivate *priv,
+                                                 GtkTreeModel            *model)
+{
+    SearchSnapshot *snapshot;
+    gpointer args[2];
+
+    snapshot = g_slice_new0 (SearchSnapshot);
+    snapshot->ref_count = 1;
+
+    /* Maps ROW_KEY to the row number plus one. The row lookup is only
+     * used from the main thread. */
+    snapshot->rows = g_hash_table_new (NULL, NULL);
 
-  gtk_tree_path_free (base_path);
-  gtk_tree_path_free (filter_path);
-  gtk_tree_path_free (view_path);
+    args[0] = snapshot;
+    args[1] = priv;
+    gtk_tree_model_foreach (model, search_snapshot_add_row, args);
 
-  return ret;
+    return snapshot;
 }
 
+static void
+filter_job_free                                 (FilterJob *job)
+{
+    search_snapshot_unref (job->snapshot);
+    g_free (job->prefix);
+    g_slice_free (FilterJob, job);
+}
 
-/**
- * selection_map_update_map_from_selection:
- * @priv: The private pimpl
- *
- * Find out which rows are visible in filter, and mark them as selected
- * or unselected from treeview to selection map.
- **/
 static void
-selection_map_update_map_from_selection         (HildonLiveSearchPrivate *priv)
+filter_job_thread                               (GTask        *task,
+                                                 gpointer      source_object,
+                                                 gpointer      task_data,
+                                                 GCancellable *cancellable)
 {
-    GtkTreeModel *base_model;
-    GtkTreeSelection *selection;
-    GList *selected_list, *l_iter;
+    FilterJob *job = task_data;
+    SearchSnapshot *snapshot = job->snapshot;
+    guint32 *bitmap;
+    guint i;
 
-    if (!GTK_IS_TREE_VIEW (priv->kb_focus_widget))
-        return;
+    /* Never NULL, also for an empty snapshot: NULL is not a result */
+    bitmap = g_new0 (guint32, MAX (1, (snapshot->n_rows + 31) / 32));
 
-    base_model = gtk_tree_model_filter_get_model (priv->filter);
-    selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (priv->kb_focus_widget));
+    for (i = 0; i < snapshot->n_rows; i++) {
+        const gchar *key = snapshot->keys[i];
 
-    /* Remove all items from priv->selection_map which are not selected */
-    g_hash_table_foreach_remove (priv->selection_map,
-                                 (GHRFunc) row_reference_is_not_selected, priv);
+        if (i % FILTER_JOB_CHECK_INTERVAL == 0 &&
+            g_task_return_error_if_cancelled (task)) {
+            g_free (bitmap);
+            return;
+        }
 
-    /* fill priv->selection_map from gtk_tree_selection_get_selected_rows()*/
-    selected_list = l_iter = gtk_tree_selection_get_selected_rows (selection,
-                                                                 NULL);
-    while (l_iter) {
-        GtkTreePath *view_path = l_iter->data;
-        GtkTreePath *base_path, *filter_path;
-        GtkTreeRowReference *row_ref;
+        if (key != NULL && g_str_has_prefix (key, job->prefix))
+            bitmap[i / 32] |= 1u << (i % 32);
+    }
 
-        filter_path = convert_path_to_child_path (
-            gtk_tree_view_get_model (GTK_TREE_VIEW (priv->kb_focus_widget)),
-            GTK_TREE_MODEL (priv->filter), view_path);
-        base_path = gtk_tree_model_filter_convert_path_to_child_path
-          (priv->filter, filter_path);
+    g_task_return_pointer (task, bitmap, g_free);
+}
 
-        row_ref = gtk_tree_row_reference_new (base_model, base_path);
-        g_hash_table_replace (priv->selection_map,
-                              row_ref, NULL);
-        gtk_tree_path_free (view_path);
-        gtk_tree_path_free (filter_path);
-        gtk_tree_path_free (base_path);
-        selected_list->data = NULL;
-        l_iter = g_list_next (l_iter);
+static void
+snapshot_drop                                   (HildonLiveSearchPrivate *priv)
+{
+    if (priv->snapshot) {
+        search_snapshot_unref (priv->snapshot);
+        priv->snapshot = NULL;
     }
-    g_list_free (selected_list);
+
+    if (priv->snapshot_changes)
+        g_hash_table_remove_all (priv->snapshot_changes);
+    priv->snapshot_n_deleted = 0;
 }
 
-static gboolean
-reference_row_has_path (GtkTreeRowReference *row_ref, gpointer value, GtkTreePath *path)
+static void
+on_snapshot_row_changed                         (GtkTreeModel *model,
+                                                 GtkTreePath  *path,
+                                                 GtkTreeIter  *iter,
+                                                 gpointer      data)
 {
-    gboolean ret;
-    GtkTreePath *path2 = gtk_tree_row_reference_get_path (row_ref);
-    ret = gtk_tree_path_compare (path, path2) == 0;
-    gtk_tree_path_free (path2);
-    return ret;
+    HildonLiveSearchPrivate *priv = HILDON_LIVE_SEARCH (data)->priv;
+    gchar *string;
+
+    if (priv->snapshot == NULL)
+        return;
+
+    gtk_tree_model_get (model, iter, priv->text_column, &string, -1);
+    g_hash_table_replace (priv->snapshot_changes, ROW_KEY (iter),
+                          index_normalize (string));
+    g_free (string);
 }
 
-/**
- * selection_map_update_selection_from_map:
- * @priv: The private pimpl
- *
- * For currently visible rows in filter, set selection from selection
- * map to treeview.
- **/
 static void
-selection_map_update_selection_from_map         (HildonLiveSearchPrivate *priv)
+on_snapshot_row_deleted                         (GtkTreeModel *model,
+                                                 GtkTreePath  *path,
+                                                 gpointer      data)
 {
-    GtkTreeSelection *selection;
-    GList *selected_list, *l_iter;
+    HildonLiveSearchPrivate *priv = HILDON_LIVE_SEARCH (data)->priv;
 
-    if (!GTK_IS_TREE_VIEW (priv->kb_focus_widget))
-        return;
+    /* The stale entry of the row is never looked up again: a new row
+     * reusing its key is recorded as a change first. */
+    if (priv->snapshot)
+        priv->snapshot_n_deleted++;
+}
 
-    selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (priv->kb_focus_widget));
+static gboolean
+snapshot_row_visible                            (HildonLiveSearchPrivate *priv,
+                                                 GtkTreeIter             *iter)
+{
+    gpointer key;
+    guint row;
 
-    /* unselect things which are not in priv->selection_map */
-    selected_list = l_iter = gtk_tree_selection_get_selected_rows (selection,
-                                                                 NULL);
-    while (l_iter) {
-        GtkTreePath *view_path = l_iter->data;
-        GtkTreePath *base_path, *filter_path;
-        filter_path = convert_path_to_child_path (
-            gtk_tree_view_get_model (GTK_TREE_VIEW (priv->kb_focus_widget)),
-            GTK_TREE_MODEL (priv->filter), view_path);
-        base_path = gtk_tree_model_filter_convert_path_to_child_path
-            (priv->filter, filter_path);
+    if (g_hash_table_lookup_extended (priv->snapshot_changes, ROW_KEY (iter),
+                                      NULL, &key))
+        return key != NULL && g_str_has_prefix (key, priv->thread_prefix);
 
-        if (g_hash_table_find (priv->selection_map,
-                               (GHRFunc) reference_row_has_path, base_path) == NULL)
-            gtk_tree_selection_unselect_path
-                (selection, view_path);
+    row = GPOINTER_TO_UINT (g_hash_table_lookup (priv->snapshot->rows,
+                                                 ROW_KEY (iter)));
 
-        gtk_tree_path_free (view_path);
-        gtk_tree_path_free (filter_path);
-        gtk_tree_path_free (base_path);
-        l_iter->data = NULL;
+    return row != 0 &&
+        (priv->thread_bitmap[(row - 1) / 32] & (1u << ((row - 1) % 32))) != 0;
+}
 
-        l_iter = g_list_next (l_iter);
+static void
+threaded_cancel                                 (HildonLiveSearchPrivate *priv)
+{
+    if (priv->filter_cancellable) {
+        g_cancellable_cancel (priv->filter_cancellable);
+        g_object_unref (priv->filter_cancellable);
+        priv->filter_cancellable = NULL;
     }
-    g_list_free (selected_list);
-
-    /* going though priv->selection_map to select items */
-    GHashTableIter iter;
-    gpointer key, value;
+}
 
-    g_hash_table_iter_init (&iter, priv->selection_map);
-    while (g_hash_table_iter_next (&iter, &key, &value)) {
-        GtkTreeRowReference *row_ref = key;
-        GtkTreePath *base_path = gtk_tree_row_reference_get_path (row_ref);
-        GtkTreePath *filter_path = gtk_tree_model_filter_convert_child_path_to_path
-          (priv->filter, base_path);
-        GtkTreePath *view_path;
+static void
+threaded_destroy                                (HildonLiveSearch *livesearch)
+{
+    HildonLiveSearchPrivate *priv = livesearch->priv;
 
-        if (filter_path == NULL)
-            continue;
+    threaded_cancel (priv);
+    snapshot_drop (priv);
 
-        view_path = convert_child_path_to_path (
-            gtk_tree_view_get_model (GTK_TREE_VIEW (priv->kb_focus_widget)),
-            GTK_TREE_MODEL (priv->filter), filter_path);
+    if (priv->snapshot_changes) {
+        g_hash_table_destroy (priv->snapshot_changes);
+        priv->snapshot_changes = NULL;
+    }
 
-        gtk_tree_selection_select_path (selection, view_path);
+    if (priv->snapshot_model) {
+        g_signal_handlers_disconnect_by_data (priv->snapshot_model, livesearch);
+        g_object_unref (priv->snapshot_model);
+        priv->snapshot_model = NULL;
     }
 }
 
+static gboolean
+threaded_usable                                 (HildonLiveSearchPrivate *priv)
+{
+    return priv->threaded && !priv->indexed && priv->filter != NULL &&
+        priv->text_column != -1 && priv->visible_func == NULL &&
+        model_has_row_keys (gtk_tree_model_filter_get_model (priv->filter));
+}
+
+static gboolean
+threaded_filter_start                           (HildonLiveSearch *livesearch);
+
 static void
-refilter (HildonLiveSearch *livesearch)
+on_filter_job_done                              (GObject      *source_object,
+                                                 GAsyncResult *result,
+                                                 gpointer      user_data)
 {
+    HildonLiveSearch *livesearch = HILDON_LIVE_SEARCH (source_object);
     HildonLiveSearchPrivate *priv = livesearch->priv;
-    gboolean handled = FALSE;
-    gboolean needs_mapping;
+    GTask *task = G_TASK (result);
+    FilterJob *job = g_task_get_task_data (task);
+    GError *error = NULL;
+    guint32 *bitmap;
+
+    bitmap = g_task_propagate_pointer (task, &error);
+    if (error != NULL) {
+        /* Only cancelled jobs fail, their prefix was superseded */
+        g_warn_if_fail (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED));
+        g_error_free (error);
+        return;
+    }
 
-    needs_mapping = GTK_IS_TREE_VIEW (priv->kb_focus_widget) &&
-        gtk_tree_selection_get_mode (gtk_tree_view_get_selection (
-                                         GTK_TREE_VIEW (priv->kb_focus_widget))) != GTK_SELECTION_NONE;
+    /* Superseded by a newer prefix */
+    if (g_task_get_cancellable (task) != priv->filter_cancellable) {
+        g_free (bitmap);
+        return;
+    }
 
-    /* This is not pretty code, but it should fix some warnings in the case we
-       attempt to refilter before the treeview actually has a model. */
-    if (needs_mapping && !gtk_tree_view_get_model (GTK_TREE_VIEW (priv->kb_focus_widget)))
+    g_clear_object (&priv->filter_cancellable);
+
+    /* The snapshot was taken again under the job, evaluate again */
+    if (job->snapshot != priv->snapshot) {
+        g_free (bitmap);
+        threaded_filter_start (livesearch);
         return;
+    }
 
-    /* Create/update selection map from current selection */
-    if (needs_mapping) {
-        if (priv->selection_map == NULL)
-            selection_map_create (priv);
-        selection_map_update_map_from_selection (priv);
+    priv->thread_bitmap = bitmap;
+    priv->thread_prefix = job->prefix;
+    refilter (livesearch);
+    priv->thread_bitmap = NULL;
+    priv->thread_prefix = NULL;
+    g_free (bitmap);
+}
+
+/**
+ * threaded_filter_start:
+ * @livesearch: a #HildonLiveSearch
+ *
+ * Cancels the filtering job in flight, if any, and starts a new one
+ * for the current prefix.
+ *
+ * Returns: %FALSE if threaded filtering cannot be used with the
+ * current settings, in which case nothing is started.
+ **/
+static gboolean
+threaded_filter_start                           (HildonLiveSearch *livesearch)
+{
+    HildonLiveSearchPrivate *priv = livesearch->priv;
+    GtkTreeModel *model;
+    FilterJob *job;
+    GTask *task;
+
+    threaded_cancel (priv);
+
+    if (!threaded_usable (priv) || priv->prefix == NULL)
+        return FALSE;
+
+    model = gtk_tree_model_filter_get_model (priv->filter);
+
+    /* Rows are looked up by key, so reordering needs no tracking */
+    if (priv->snapshot_model != model) {
+        threaded_destroy (livesearch);
+
+        priv->snapshot_model = g_object_ref (model);
+        priv->snapshot_changes = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+        g_signal_connect (model, "row-inserted",
+                          G_CALLBACK (on_snapshot_row_changed), livesearch);
+        g_signal_connect (model, "row-changed",
+                          G_CALLBACK (on_snapshot_row_changed), livesearch);
+        g_signal_connect (model, "row-deleted",
+                          G_CALLBACK (on_snapshot_row_deleted), livesearch);
+    } else if (priv->snapshot &&
+               g_hash_table_size (priv->snapshot_changes) + priv->snapshot_n_deleted >
+               MAX (SNAPSHOT_MIN_CHANGES, priv->snapshot->n_rows / 4)) {
+        snapshot_drop (priv);
     }
 
-    /* Filter the model */
-    g_signal_emit (livesearch, signals[REFILTER], 0, &handled);
-    if (!handled && priv->filter)
-        gtk_tree_model_filter_refilter (priv->filter);
+    if (priv->snapshot == NULL)
+        priv->snapshot = search_snapshot_new (priv, model);
 
-    /* Restore selection from mapping */
-    if (needs_mapping)
-        selection_map_update_selection_from_map (priv);
+    job = g_slice_new (FilterJob);
+    job->snapshot = search_snapshot_ref (priv->snapshot);
+    job->prefix = g_strdup (priv->prefix_key);
+    if (job->prefix == NULL) {
+        filter_job_free (job);
+        return FALSE;
+    }
+
+    priv->filter_cancellable = g_cancellable_new ();
+
+    task = g_task_new (livesearch, priv->filter_cancellable,
+                       on_filter_job_done, NULL);
+    g_task_set_task_data (task, job, (GDestroyNotify) filter_job_free);
+    g_task_run_in_thread (task, filter_job_thread);
+    g_object_unref (task);
+
+    return TRUE;
 }
 
 static gboolean
@@ -438,8 +1532,15 @@ on_entry_changed                                (GtkEntry *entry,
 
     g_free (priv->prefix);
     priv->prefix = g_strdup (text);
+    g_free (priv->prefix_key);
+    priv->prefix_key = index_normalize (text);
 
-    if (priv->run_async) {
+    if (priv->run_async && threaded_filter_start (livesearch)) {
+        if (priv->idle_filter_id != 0) {
+            g_source_remove (priv->idle_filter_id);
+            priv->idle_filter_id = 0;
+        }
+    } else if (priv->run_async) {
         if (priv->idle_filter_id == 0) {
             priv->idle_filter_id = gdk_threads_add_idle ((GSourceFunc) on_idle_refilter, livesearch);
         }
@@ -610,6 +1711,12 @@ hildon_live_search_get_property                 (GObject    *object,
     case PROP_TEXT:
         g_value_set_string (value, livesearch->priv->prefix);
         break;
+    case PROP_INDEXED:
+        g_value_set_boolean (value, livesearch->priv->indexed);
+        break;
+    case PROP_THREADED:
+        g_value_set_boolean (value, livesearch->priv->threaded);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -636,6 +1743,14 @@ hildon_live_search_set_property                 (GObject      *object,
         hildon_live_search_set_text (livesearch,
                                      g_value_get_string (value));
         break;
+    case PROP_INDEXED:
+        hildon_live_search_set_indexed (livesearch,
+                                        g_value_get_boolean (value));
+        break;
+    case PROP_THREADED:
+        hildon_live_search_set_threaded (livesearch,
+                                         g_value_get_boolean (value));
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -648,6 +1763,9 @@ hildon_live_search_dispose                      (GObject *object)
 
     hildon_live_search_widget_unhook (HILDON_LIVE_SEARCH (object));
 
+    index_destroy (priv);
+    threaded_destroy (HILDON_LIVE_SEARCH (object));
+
     if (priv->filter) {
         selection_map_destroy (priv);
         g_object_unref (priv->filter);
@@ -659,6 +1777,9 @@ hildon_live_search_dispose                      (GObject *object)
         priv->prefix = NULL;
     }
 
+    g_free (priv->prefix_key);
+    priv->prefix_key = NULL;
+
     if (priv->visible_destroy) {
         priv->visible_destroy (priv->visible_data);
         priv->visible_destroy = NULL;
@@ -735,6 +1856,42 @@ hildon_live_search_class_init                   (HildonLiveSearchClass *klass)
                                                        G_PARAM_READWRITE |
                                                        G_PARAM_STATIC_STRINGS));
 
+    /**
+     * HildonLiveSearch:indexed:
+     *
+     * Whether the default filtering function should use a sorted index
+     * of #HildonLiveSearch:text-column instead of checking every row.
+     *
+     * Since: 3.0
+     */
+    g_object_class_install_property (object_class,
+                                     PROP_INDEXED,
+                                     g_param_spec_boolean ("indexed",
+                                                           "Indexed",
+                                                           "Whether to filter "
+                                                           "using an index of the text column",
+                                                           FALSE,
+                                                           G_PARAM_READWRITE |
+                                                           G_PARAM_STATIC_STRINGS));
+
+    /**
+     * HildonLiveSearch:threaded:
+     *
+     * Whether the default filtering function should be evaluated in a
+     * worker thread when the text changes.
+     *
+     * Since: 3.0
+     */
+    g_object_class_install_property (object_class,
+                                     PROP_THREADED,
+                                     g_param_spec_boolean ("threaded",
+                                                           "Threaded",
+                                                           "Whether to filter "
+                                                           "in a worker thread",
+                                                           FALSE,
+                                                           G_PARAM_READWRITE |
+                                                           G_PARAM_STATIC_STRINGS));
+
   /**
    * HildonLiveSearch::refilter:
    * @livesearch: the object which received the signal
@@ -792,6 +1949,7 @@ hildon_live_search_init                         (HildonLiveSearch *self)
 
     priv->kb_focus_widget = NULL;
     priv->prefix = NULL;
+    priv->prefix_key = NULL;
 
     priv->visible_func = NULL;
     priv->visible_data = NULL;
@@ -802,6 +1960,19 @@ hildon_live_search_init                         (HildonLiveSearch *self)
     priv->selection_map = NULL;
     priv->run_async = TRUE;
 
+    priv->indexed = FALSE;
+    priv->index_model = NULL;
+    priv->index_rows = NULL;
+
+    priv->threaded = FALSE;
+    priv->snapshot_model = NULL;
+    priv->snapshot = NULL;
+    priv->snapshot_changes = NULL;
+    priv->snapshot_n_deleted = 0;
+    priv->filter_cancellable = NULL;
+    priv->thread_bitmap = NULL;
+    priv->thread_prefix = NULL;
+
     priv->text_column = -1;
 
     entry_container = gtk_tool_item_new ();
@@ -897,9 +2068,21 @@ visible_func                                    (GtkTreeModel *model,
         visible = (priv->visible_func) (model, iter,
                                         priv->prefix,
                                         priv->visible_data);
+    } else if (priv->index_rows && priv->refiltering) {
+        IndexEntry *entry = g_hash_table_lookup (priv->index_rows, ROW_KEY (iter));
+        visible = (entry != NULL && entry->visible);
+    } else if (priv->thread_bitmap && priv->refiltering) {
+        visible = snapshot_row_visible (priv, iter);
     } else {
+        /* Rows are compared the same way in every mode, so the index
+         * and the worker thread match the same rows as this. */
+        gchar *key;
+
         gtk_tree_model_get (model, iter, priv->text_column, &string, -1);
-        visible = (string != NULL && g_str_has_prefix (string, priv->prefix));
+        key = index_normalize (string);
+        visible = (key != NULL && priv->prefix_key != NULL &&
+                   g_str_has_prefix (key, priv->prefix_key));
+        g_free (key);
         g_free (string);
     }
 
@@ -929,6 +2112,9 @@ hildon_live_search_set_filter                   (HildonLiveSearch   *livesearch,
     if (filter == priv->filter)
         return;
 
+    index_destroy (priv);
+    threaded_destroy (livesearch);
+
     if (filter)
         g_object_ref (filter);
 
@@ -1005,6 +2191,8 @@ hildon_live_search_set_text_column              (HildonLiveSearch *livesearch,
         return;
 
     priv->text_column = text_column;
+    index_destroy (priv);
+    threaded_destroy (livesearch);
 
     if (priv->visible_func_set == FALSE) {
         gtk_tree_model_filter_set_visible_func (priv->filter,
@@ -1203,6 +2391,8 @@ hildon_live_search_set_visible_func             (HildonLiveSearch           *liv
     priv->visible_func = func;
     priv->visible_data = data;
     priv->visible_destroy = destroy;
+    index_destroy (priv);
+    threaded_destroy (livesearch);
 
     if (priv->visible_func_set == FALSE) {
         gtk_tree_model_filter_set_visible_func (priv->filter,
@@ -1243,3 +2433,124 @@ hildon_live_search_clean_selection_map (HildonLiveSearch * livesearch)
         selection_map_update_map_from_selection (livesearch->priv);
     }
 }
+
+/**
+ * hildon_live_search_set_indexed:
+ * @livesearch: a #HildonLiveSearch
+ * @indexed: whether to filter using an index
+ *
+ * Sets whether the default filtering method should keep a sorted
+ * index of #HildonLiveSearch:text-column. The index is built the
+ * first time the model is filtered and is then kept up to date as
+ * rows are inserted, changed or deleted, so that each change of the
+ * text only needs a binary search instead of a comparison against
+ * every row. Typing further characters only searches among the
+ * previous matches.
+ *
+ * Strings are compared after Unicode normalization. The index is only
+ * used when the child model of the filter is a #GtkListStore or a
+ * #GtkTreeStore, and has no effect when a visible function is set with
+ * hildon_live_search_set_visible_func().
+ *
+ * Since: 3.0
+ **/
+void
+hildon_live_search_set_indexed                  (HildonLiveSearch *livesearch,
+                                                 gboolean          indexed)
+{
+    HildonLiveSearchPrivate *priv;
+
+    g_return_if_fail (HILDON_IS_LIVE_SEARCH (livesearch));
+
+    priv = livesearch->priv;
+    indexed = indexed ? TRUE : FALSE;
+
+    if (priv->indexed == indexed)
+        return;
+
+    priv->indexed = indexed;
+    if (!indexed)
+        index_destroy (priv);
+
+    g_object_notify (G_OBJECT (livesearch), "indexed");
+}
+
+/**
+ * hildon_live_search_get_indexed:
+ * @livesearch: a #HildonLiveSearch
+ *
+ * Returns whether @livesearch filters using an index of its text
+ * column. See hildon_live_search_set_indexed().
+ *
+ * Returns: %TRUE if indexed filtering is enabled
+ *
+ * Since: 3.0
+ **/
+gboolean
+hildon_live_search_get_indexed                  (HildonLiveSearch *livesearch)
+{
+    g_return_val_if_fail (HILDON_IS_LIVE_SEARCH (livesearch), FALSE);
+
+    return livesearch->priv->indexed;
+}
+
+/**
+ * hildon_live_search_set_threaded:
+ * @livesearch: a #HildonLiveSearch
+ * @threaded: whether to filter in a worker thread
+ *
+ * Sets whether the default filtering method should run in a worker
+ * thread. The contents of #HildonLiveSearch:text-column are copied
+ * once, and each change of the text is matched against that copy in
+ * the background. A change of the text cancels the pending
+ * evaluation, and the model filter is only refiltered once the result
+ * for the latest text is available, so typing is not held up by long
+ * lists.
+ *
+ * Strings are compared after Unicode normalization. Threaded filtering
+ * is only used when the child model of the filter is a #GtkListStore
+ * or a #GtkTreeStore, and has no effect when a visible function is set
+ * with hildon_live_search_set_visible_func() or when
+ * #HildonLiveSearch:indexed is enabled.
+ *
+ * Since: 3.0
+ **/
+void
+hildon_live_search_set_threaded                 (HildonLiveSearch *livesearch,
+                                                 gboolean          threaded)
+{
+    HildonLiveSearchPrivate *priv;
+
+    g_return_if_fail (HILDON_IS_LIVE_SEARCH (livesearch));
+
+    priv = livesearch->priv;
+    threaded = threaded ? TRUE : FALSE;
+
+    if (priv->threaded == threaded)
+        return;
+
+    priv->threaded = threaded;
+    if (!threaded)
+        threaded_destroy (livesearch);
+
+    g_object_notify (G_OBJECT (livesearch), "threaded");
+}
+
+/**
+ * hildon_live_search_get_threaded:
+ * @livesearch: a #HildonLiveSearch
+ *
+ * Returns whether @livesearch filters in a worker thread. See
+ * hildon_live_search_set_threaded().
+ *
+ * Returns: %TRUE if threaded filtering is enabled
+ *
+ * Since: 3.0
+ **/
+gboolean
+hildon_live_search_get_threaded                 (HildonLiveSearch *livesearch)
+{
+    g_return_val_if_fail (HILDON_IS_LIVE_SEARCH (livesearch), FALSE);
+
+    return livesearch->priv->threaded;
+}
@@ -141,6 +141,20 @@ hildon_live_search_set_visible_func              (HildonLiveSearch           *li
 void
 hildon_live_search_clean_selection_map           (HildonLiveSearch * livesearch);
 
+void
+hildon_live_search_set_indexed                  (HildonLiveSearch *livesearch,
+                                                 gboolean          indexed);
+
+gboolean
+hildon_live_search_get_indexed                  (HildonLiveSearch *livesearch);
+
+void
+hildon_live_search_set_threaded                 (HildonLiveSearch *livesearch,
+                                                 gboolean          threaded);
+
+gboolean
+hildon_live_search_get_threaded                 (HildonLiveSearch *livesearch);
+
 G_END_DECLS
 
 #endif                                          /* __HILDON_LIVE_SEARCH__ */
@@ -36,11 +36,17 @@
  * continue from the initial motion by gradually slowing down to an eventual stop.
  * The motion can also be stopped immediately by pressing the touchscreen over the
  * pannable area.
+ *
+ * For long lists of widgets, instead of adding a child, use
+ * hildon_pannable_area_set_item_factory(): the widgets are then created
+ * only for the items close to the visible region, and reused as the
+ * list is panned.
  */
 
 #undef HILDON_DISABLE_DEPRECATED
 
 #include <math.h>
+#include <string.h>
 #include <cairo.h>
 #include <gdk/gdk.h>
 
@@ -52,7 +58,8 @@
 #define RATIO_TOLERANCE 0.000001
 #define SCROLL_FADE_IN_TIMEOUT 50
 #define SCROLL_FADE_TIMEOUT 100
-#define MOTION_EVENTS_PER_SECOND 25
+#define MOTION_SAMPLES 16
+#define VELOCITY_SAMPLE_WINDOW 100
 #define CURSOR_STOPPED_TIMEOUT 200
 #define MAX_SPEED_THRESHOLD 280
 #define PANNABLE_MAX_WIDTH 788
@@ -61,6 +68,20 @@
 #define MIN_ACCEL_THRESHOLD 40
 #define FAST_CLICK 125
 
+/* A pre-rendered scroll indicator, painted over the contents */
+typedef struct {
+  cairo_surface_t *surface;
+  gint width;
+  gint height;
+} HildonPannableAreaIndicator;
+
+/* A pointer position, as reported by a motion event */
+typedef struct {
+  gdouble x;
+  gdouble y;
+  guint32 time;
+} HildonPannableAreaSample;
+
 struct _HildonPannableAreaPrivate {
   HildonPannableAreaMode mode;
   HildonMovementMode mov_mode;
@@ -92,8 +113,8 @@ struct _HildonPannableAreaPrivate {
   guint bounce_steps;
   guint force;
   guint direction_error_margin;
-  gdouble vel_x;
-  gdouble vel_y;
+  gdouble vel_x;		/* Kinetic velocity, in adjustment units per step, */
+  gdouble vel_y;		/* where a step lasts 1/sps seconds */
   gdouble old_vel_x;
   gdouble old_vel_y;
   GdkWindow *child;
@@ -103,20 +124,22 @@ struct _HildonPannableAreaPrivate {
   gint iy;
   gint cx;			/* Initial click child window mouse co-ordinates */
   gint cy;
-  guint idle_id;
+  gboolean panning;		/* The kinetic engine owns the adjustments */
   gdouble scroll_to_x;
   gdouble scroll_to_y;
   gdouble motion_x;
   gdouble motion_y;
-  gint overshot_dist_x;
-  gint overshot_dist_y;
-  gint overshooting_y;
-  gint overshooting_x;
+  gdouble overshot_dist_x;	/* Signed distance past the adjustment limits */
+  gdouble overshot_dist_y;
+  gdouble overshooting_y;	/* Steps spent going outwards while overshot */
+  gdouble overshooting_x;
   gdouble scroll_indicator_alpha;
-  gint motion_event_scroll_timeout;
-  gint scroll_indicator_timeout;
-  gint scroll_indicator_event_interrupt;
-  gint scroll_delay_counter;
+  HildonPannableAreaSample samples[MOTION_SAMPLES];
+  guint n_samples;
+  guint sample_head;		/* Where the next sample is stored */
+  gboolean motion_pending;	/* The last sample is not applied yet */
+  gint64 indicator_visible_until;	/* Frame time the fade out starts */
+  gint64 indicator_frame_time;
   gint vovershoot_max;
   gint hovershoot_max;
   gboolean fade_in;
@@ -130,17 +153,39 @@ struct _HildonPannableAreaPrivate {
   gboolean vscroll_visible;
   GdkRectangle hscroll_rect;
   GdkRectangle vscroll_rect;
+  HildonPannableAreaIndicator hindicator;
+  HildonPannableAreaIndicator vindicator;
   guint indicator_width;
 
   GtkAdjustment *hadjust;
   GtkAdjustment *vadjust;
-  gint x_offset;
+  gint x_offset;		/* Overshoot offset currently applied to the child */
   gint y_offset;
+  GtkAllocation child_allocation;
+
+  GtkGesture *drag;
+  gdouble drag_start_hvalue;
+  gdouble drag_start_vvalue;
+
+  HildonPannableAreaItemFactory item_factory;
+  gpointer item_factory_data;
+  GDestroyNotify item_factory_destroy;
+  GtkWidget *item_layout;
+  guint n_items;
+  gint item_height;
+  gint item_width;
+  gint prefetch_margin;
+  guint first_item;		/* Index of the first item in items */
+  GPtrArray *items;		/* Widgets of the items in the visible region */
+  GQueue spare_items;		/* Hidden widgets, ready to be recycled */
+  guint items_tick_id;		/* Pending update of the items */
+  gboolean items_rebind;	/* Whether the pending update rebinds all items */
+  gboolean item_factory_failed;	/* The factory returned no widget */
 
   GtkPolicyType vscrollbar_policy;
   GtkPolicyType hscrollbar_policy;
 
-  GdkColor scroll_color;
+  GdkRGBA scroll_color;
 
   gboolean center_on_child_focus;
   gboolean center_on_child_focus_pending;
@@ -164,6 +209,8 @@ struct _HildonPannableAreaPrivate {
   guint duration;
   gint64 start_time;
   gint64 end_time;
+  gboolean tweening;
+  gint64 last_frame_time;
   guint tick_id;
   GdkFrameClock *clock;
 };
@@ -206,6 +253,7 @@ enum {
   PROP_HADJUSTMENT,
   PROP_VADJUSTMENT,
   PROP_CENTER_ON_CHILD_FOCUS,
+  PROP_PREFETCH_MARGIN,
   PROP_LAST
 };
 
@@ -235,6 +283,35 @@ static void hildon_pannable_area_remove (GtkContainer *container, GtkWidget *chi
 static void hildon_pannable_area_set_focus_child (GtkContainer *container,
                                                  GtkWidget *child);
 static void hildon_pannable_area_center_on_child_focus (HildonPannableArea *area);
+static void hildon_pannable_area_size_allocate (GtkWidget *widget,
+                                                GtkAllocation *allocation);
+static void hildon_pannable_area_unrealize (GtkWidget *widget);
+static gboolean hildon_pannable_area_draw (GtkWidget *widget,
+                                           cairo_t *cr);
+static void hildon_pannable_area_style_updated (GtkWidget *widget);
+static void hildon_pannable_area_adjust_value_changed (GtkAdjustment *adjust,
+                                                       HildonPannableArea *area);
+static void hildon_pannable_area_adjust_changed (GtkAdjustment *adjust,
+                                                 HildonPannableArea *area);
+static void hildon_pannable_area_compute_indicators (HildonPannableArea *area);
+static void hildon_pannable_area_free_indicators (HildonPannableArea *area);
+static void hildon_pannable_area_queue_update_items (HildonPannableArea *area,
+                                                     gboolean rebind);
+static void hildon_pannable_area_clear_items (HildonPannableArea *area);
+static void hildon_pannable_area_drag_begin (GtkGestureDrag *gesture,
+                                             gdouble start_x,
+                                             gdouble start_y,
+                                             HildonPannableArea *area);
+static void hildon_pannable_area_drag_update (GtkGestureDrag *gesture,
+                                              gdouble offset_x,
+                                              gdouble offset_y,
+                                              HildonPannableArea *area);
+static void hildon_pannable_area_drag_end (GtkGestureDrag *gesture,
+                                           gdouble offset_x,
+                                           gdouble offset_y,
+                                           HildonPannableArea *area);
+static gboolean hildon_pannable_area_begin_updating (HildonPannableArea *area);
+static void hildon_pannable_area_end_updating (HildonPannableArea *area);
 
 
 static void
@@ -243,10 +320,11 @@ hildon_pannable_area_finalize (GObject *object)
   HildonPannableArea *area = HILDON_PANNABLE_AREA (object);
   HildonPannableAreaPrivate *priv = area->priv;
 
-  if (priv->tick_id)
-    g_signal_handler_disconnect (priv->clock, priv->tick_id);
-  if (priv->clock)
-    g_object_unref (priv->clock);
+  hildon_pannable_area_end_updating (area);
+
+  g_object_unref (priv->drag);
+
+  hildon_pannable_area_free_indicators (area);
 
   G_OBJECT_CLASS (hildon_pannable_area_parent_class)->finalize (object);
 }
@@ -263,6 +341,11 @@ hildon_pannable_area_class_init (HildonPannableAreaClass * class)
   object_class->set_property = hildon_pannable_area_set_property;
   object_class->get_property = hildon_pannable_area_get_property;
 
+  widget_class->size_allocate = hildon_pannable_area_size_allocate;
+  widget_class->unrealize = hildon_pannable_area_unrealize;
+  widget_class->draw = hildon_pannable_area_draw;
+  widget_class->style_updated = hildon_pannable_area_style_updated;
+
 //FIXME: Breaks scrolling.  Not adding viewport?
 /*  container_class->add = hildon_pannable_area_add;
   container_class->remove = hildon_pannable_area_remove;
@@ -537,6 +620,25 @@ hildon_pannable_area_class_init (HildonPannableAreaClass * class)
                                                          G_PARAM_READWRITE |
                                                          G_PARAM_CONSTRUCT));
 
+  /**
+   * HildonPannableArea:prefetch-margin:
+   *
+   * Distance, in pixels, above and below the visible region in which
+   * the items of hildon_pannable_area_set_item_factory() are created
+   * before they become visible.
+   *
+   * Since: 3.0
+   */
+  g_object_class_install_property (object_class,
+                                   PROP_PREFETCH_MARGIN,
+                                   g_param_spec_int ("prefetch-margin",
+                                                     "Prefetch margin",
+                                                     "Distance out of the visible region where the items "
+                                                     "of the item factory are already created.",
+                                                     0, G_MAXINT, 200,
+                                                     G_PARAM_READWRITE |
+                                                     G_PARAM_CONSTRUCT));
+
 
   gtk_widget_class_install_style_property (widget_class,
 					   g_param_spec_uint
@@ -652,7 +754,7 @@ hildon_pannable_area_init (HildonPannableArea * area)
   HildonPannableAreaPrivate *priv;
   priv = area->priv = hildon_pannable_area_get_instance_private (area);
   area->priv->duration = 200;
-  area->priv->clock = gtk_widget_get_frame_clock (GTK_WIDGET (area));
+  area->priv->clock = NULL;
 
   gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (area),
                                   GTK_POLICY_NEVER,
@@ -660,6 +762,44 @@ hildon_pannable_area_init (HildonPannableArea * area)
   gtk_scrolled_window_set_hadjustment (GTK_SCROLLED_WINDOW (area), NULL);
   gtk_scrolled_window_set_vadjustment (GTK_SCROLLED_WINDOW (area), NULL);
 
+  /* We do the kinetic scrolling ourselves, GtkScrolledWindow's own
+   * implementation ignores all the tuning properties below */
+  gtk_scrolled_window_set_kinetic_scrolling (GTK_SCROLLED_WINDOW (area), FALSE);
+
+  /* The scroll indicators are drawn over the contents instead of the
+   * scrollbars, they follow the adjustments of the scrolled window */
+  gtk_widget_set_no_show_all (gtk_scrolled_window_get_hscrollbar (GTK_SCROLLED_WINDOW (area)), TRUE);
+  gtk_widget_set_no_show_all (gtk_scrolled_window_get_vscrollbar (GTK_SCROLLED_WINDOW (area)), TRUE);
+  gtk_widget_hide (gtk_scrolled_window_get_hscrollbar (GTK_SCROLLED_WINDOW (area)));
+  gtk_widget_hide (gtk_scrolled_window_get_vscrollbar (GTK_SCROLLED_WINDOW (area)));
+
+  g_signal_connect_object (gtk_scrolled_window_get_hadjustment (GTK_SCROLLED_WINDOW (area)),
+                           "value-changed",
+                           G_CALLBACK (hildon_pannable_area_adjust_value_changed), area, 0);
+  g_signal_connect_object (gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (area)),
+                           "value-changed",
+                           G_CALLBACK (hildon_pannable_area_adjust_value_changed), area, 0);
+  g_signal_connect_object (gtk_scrolled_window_get_hadjustment (GTK_SCROLLED_WINDOW (area)),
+                           "changed",
+                           G_CALLBACK (hildon_pannable_area_adjust_changed), area, 0);
+  g_signal_connect_object (gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (area)),
+                           "changed",
+                           G_CALLBACK (hildon_pannable_area_adjust_changed), area, 0);
+
+  /* Listen in the capture phase, so we see the presses before the
+   * children do and can take the sequence once the user pans */
+  priv->drag = gtk_gesture_drag_new (GTK_WIDGET (area));
+  gtk_gesture_single_set_button (GTK_GESTURE_SINGLE (priv->drag), GDK_BUTTON_PRIMARY);
+  gtk_event_controller_set_propagation_phase (GTK_EVENT_CONTROLLER (priv->drag),
+                                              GTK_PHASE_CAPTURE);
+  g_signal_connect (priv->drag, "drag-begin",
+                    G_CALLBACK (hildon_pannable_area_drag_begin), area);
+  g_signal_connect (priv->drag, "drag-update",
+                    G_CALLBACK (hildon_pannable_area_drag_update), area);
+  g_signal_connect (priv->drag, "drag-end",
+                    G_CALLBACK (hildon_pannable_area_drag_end), area);
+
+  priv->enabled = TRUE;
   priv->moved = FALSE;
   priv->button_pressed = FALSE;
   priv->last_time = 0;
@@ -668,22 +808,36 @@ hildon_pannable_area_init (HildonPannableArea * area)
   priv->vscroll_visible = TRUE;
   priv->hscroll_visible = TRUE;
   priv->indicator_width = 6;
+  priv->hindicator.surface = NULL;
+  priv->vindicator.surface = NULL;
+  priv->item_factory = NULL;
+  priv->item_layout = NULL;
+  priv->items = NULL;
+  priv->n_items = 0;
+  priv->first_item = 0;
+  g_queue_init (&priv->spare_items);
+  priv->items_tick_id = 0;
+  priv->items_rebind = FALSE;
+  priv->item_factory_failed = FALSE;
   priv->overshot_dist_x = 0;
   priv->overshot_dist_y = 0;
   priv->overshooting_y = 0;
   priv->overshooting_x = 0;
   priv->accel_vel_x = 0;
   priv->accel_vel_y = 0;
-  priv->idle_id = 0;
+  priv->panning = FALSE;
+  priv->tweening = FALSE;
+  priv->last_frame_time = 0;
   priv->vel_x = 0;
   priv->vel_y = 0;
   priv->old_vel_x = 0;
   priv->old_vel_y = 0;
   priv->scroll_indicator_alpha = 0.0;
-  priv->scroll_indicator_timeout = 0;
-  priv->motion_event_scroll_timeout = 0;
-  priv->scroll_indicator_event_interrupt = 0;
-  priv->scroll_delay_counter = 0;
+  priv->indicator_visible_until = 0;
+  priv->indicator_frame_time = 0;
+  priv->n_samples = 0;
+  priv->sample_head = 0;
+  priv->motion_pending = FALSE;
   priv->scrollbar_fade_delay = 0;
   priv->scroll_to_x = -1;
   priv->scroll_to_y = -1;
@@ -799,6 +953,9 @@ hildon_pannable_area_get_property (GObject * object,
   case PROP_CENTER_ON_CHILD_FOCUS:
     g_value_set_boolean (value, priv->center_on_child_focus);
     break;
+  case PROP_PREFETCH_MARGIN:
+    g_value_set_int (value, priv->prefetch_margin);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -817,12 +974,9 @@ hildon_pannable_area_set_property (GObject * object,
   case PROP_ENABLED:
     enabled = g_value_get_boolean (value);
 
-    if ((priv->enabled != enabled) && (gtk_widget_get_realized (GTK_WIDGET (object)))) {
-      if (enabled)
-	gdk_window_raise (priv->event_window);
-      else
-	gdk_window_lower (priv->event_window);
-    }
+    if (priv->enabled != enabled)
+      gtk_event_controller_set_propagation_phase (GTK_EVENT_CONTROLLER (priv->drag),
+                                                  enabled ? GTK_PHASE_CAPTURE : GTK_PHASE_NONE);
 
     priv->enabled = enabled;
     break;
@@ -935,6 +1089,10 @@ hildon_pannable_area_set_property (GObject * object,
   case PROP_CENTER_ON_CHILD_FOCUS:
     priv->center_on_child_focus = g_value_get_boolean (value);
     break;
+  case PROP_PREFETCH_MARGIN:
+    hildon_pannable_area_set_prefetch_margin (HILDON_PANNABLE_AREA (object),
+                                              g_value_get_int (value));
+    break;
 
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -949,6 +1107,9 @@ hildon_pannable_area_dispose (GObject * object)
 
   hildon_pannable_area_remove_timeouts (GTK_WIDGET (object));
 
+  hildon_pannable_area_clear_items (HILDON_PANNABLE_AREA (object));
+  child = gtk_bin_get_child (GTK_BIN (object));
+
   if (child) {
     g_signal_handlers_disconnect_by_func (child,
                                           hildon_pannable_area_child_mapped,
@@ -975,21 +1136,20 @@ hildon_pannable_area_remove_timeouts (GtkWidget * widget)
 {
   HildonPannableAreaPrivate *priv = HILDON_PANNABLE_AREA (widget)->priv;
 
-  if (priv->idle_id) {
+  if (priv->panning) {
+    priv->panning = FALSE;
+    priv->vel_x = 0;
+    priv->vel_y = 0;
     g_signal_emit (widget, pannable_area_signals[PANNING_FINISHED], 0);
-    g_source_remove (priv->idle_id);
-    priv->idle_id = 0;
   }
 
-  if (priv->scroll_indicator_timeout){
-    g_source_remove (priv->scroll_indicator_timeout);
-    priv->scroll_indicator_timeout = 0;
-  }
+  priv->tweening = FALSE;
+  hildon_pannable_area_end_updating (HILDON_PANNABLE_AREA (widget));
 
-  if (priv->motion_event_scroll_timeout){
-    g_source_remove (priv->motion_event_scroll_timeout);
-    priv->motion_event_scroll_timeout = 0;
-  }
+  priv->fade_in = FALSE;
+  priv->scroll_indicator_alpha = 0.0;
+
+  priv->motion_pending = FALSE;
 }
 
 static GdkWindow *
@@ -1225,17 +1385,24 @@ hildon_pannable_area_add_with_viewport (HildonPannableArea * area,
 static void hildon_pannable_area_on_frame_clock_update (GdkFrameClock *clock,
                                                         HildonPannableArea *area);
 
-static void
+static gboolean
 hildon_pannable_area_begin_updating (HildonPannableArea *area)
 {
   HildonPannableAreaPrivate *priv = area->priv;
 
   if (priv->tick_id == 0)
     {
+      priv->clock = gtk_widget_get_frame_clock (GTK_WIDGET (area));
+
+      if (priv->clock == NULL)
+        return FALSE;
+
       priv->tick_id = g_signal_connect (priv->clock, "update",
                                         G_CALLBACK (hildon_pannable_area_on_frame_clock_update), area);
       gdk_frame_clock_begin_updating (priv->clock);
     }
+
+  return TRUE;
 }
 
 static void
@@ -1249,6 +1416,8 @@ hildon_pannable_area_end_updating (HildonPannableArea *area)
       priv->tick_id = 0;
       gdk_frame_clock_end_updating (priv->clock);
     }
+
+  priv->clock = NULL;
 }
 
 /* From clutter-easing.c, based on Robert Penner's
@@ -1263,14 +1432,10 @@ ease_out_cubic (gdouble t)
 }
 
 static void
-hildon_pannable_area_on_frame_clock_update (GdkFrameClock *clock,
-                                            HildonPannableArea *area)
+hildon_pannable_area_tween_step (HildonPannableArea *area,
+                                 gint64 now)
 {
   HildonPannableAreaPrivate *priv = area->priv;
-  gint64 now;
-
-  now = gdk_frame_clock_get_frame_time (clock);
-
   GtkAdjustment *hadj;
   GtkAdjustment *vadj;
 
@@ -1290,8 +1455,877 @@ hildon_pannable_area_on_frame_clock_update (GdkFrameClock *clock,
     {
       gtk_adjustment_set_value (hadj, priv->htarget);
       gtk_adjustment_set_value (vadj, priv->vtarget);
-      hildon_pannable_area_end_updating (area);
+      priv->tweening = FALSE;
+    }
+}
+
+/* Moves the child away from its real allocation by the current
+ * overshoot distance, this is what makes the rubberband effect
+ * visible. Only the child is reallocated, nothing is queued. */
+static void
+hildon_pannable_area_apply_overshoot (HildonPannableArea *area)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  GtkWidget *child = gtk_bin_get_child (GTK_BIN (area));
+  GtkAllocation allocation;
+  gint x_offset, y_offset;
+
+  if (child == NULL || !gtk_widget_get_visible (child))
+    return;
+
+  x_offset = (gint) priv->overshot_dist_x;
+  y_offset = (gint) priv->overshot_dist_y;
+
+  if ((x_offset == priv->x_offset) && (y_offset == priv->y_offset))
+    return;
+
+  priv->x_offset = x_offset;
+  priv->y_offset = y_offset;
+
+  allocation = priv->child_allocation;
+  allocation.x -= x_offset;
+  allocation.y -= y_offset;
+
+  gtk_widget_size_allocate (child, &allocation);
+}
+
+/* Sets the adjustment to the position the pointer is dragging it
+ * to, the part out of the limits becomes overshoot */
+static void
+hildon_pannable_axis_drag (GtkAdjustment *adjust,
+                           gdouble value,
+                           gdouble *overshot_dist,
+                           gint overshoot_max)
+{
+  gdouble lower = gtk_adjustment_get_lower (adjust);
+  gdouble upper = MAX (lower, gtk_adjustment_get_upper (adjust) -
+                       gtk_adjustment_get_page_size (adjust));
+
+  if (value < lower) {
+    *overshot_dist = MAX (value - lower, -overshoot_max);
+    value = lower;
+  } else if (value > upper) {
+    *overshot_dist = MIN (value - upper, overshoot_max);
+    value = upper;
+  } else {
+    *overshot_dist = 0;
+  }
+
+  gtk_adjustment_set_value (adjust, value);
+}
+
+/* Advances one axis of the kinetic movement @steps steps (a step
+ * lasts 1/sps seconds, it is the unit the velocity properties use).
+ * Returns whether the axis still needs more frames. */
+static gboolean
+hildon_pannable_axis_scroll (HildonPannableArea *area,
+                             GtkAdjustment *adjust,
+                             gdouble *vel,
+                             gdouble *overshot_dist,
+                             gdouble *overshooting,
+                             gint overshoot_max,
+                             gdouble steps)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  gdouble lower = gtk_adjustment_get_lower (adjust);
+  gdouble upper = MAX (lower, gtk_adjustment_get_upper (adjust) -
+                       gtk_adjustment_get_page_size (adjust));
+  gdouble value;
+
+  if (*overshot_dist == 0) {
+    value = gtk_adjustment_get_value (adjust) + (*vel) * steps;
+
+    if ((value < lower) || (value > upper)) {
+      /* We hit the edge, the rest of the movement becomes the
+       * beginning of the overshoot */
+      if ((overshoot_max != 0) && (!priv->button_pressed)) {
+        *overshot_dist = (value < lower) ? value - lower : value - upper;
+        *overshot_dist = CLAMP (*overshot_dist, -overshoot_max, overshoot_max);
+        *vel = CLAMP (*vel, -priv->vmax_overshooting, priv->vmax_overshooting);
+        *overshooting = 0;
+      } else {
+        *vel = 0;
+      }
+
+      value = CLAMP (value, lower, upper);
+    } else if ((!priv->button_pressed) && (!priv->low_friction_mode)) {
+      *vel *= pow (priv->decel, steps);
+    }
+
+    gtk_adjustment_set_value (adjust, value);
+
+    if ((!priv->button_pressed) && (ABS (*vel) < 1.0))
+      *vel = 0;
+  } else {
+    gdouble dist;
+
+    /* When the overshoot has started we continue for
+     * PROP_BOUNCE_STEPS more steps into the overshoot before we
+     * reverse direction, braking harder the further we are from the
+     * edge. Then we return to the edge, never slower than 10 pixels
+     * per step */
+    *overshooting += steps;
+
+    if ((*overshooting < priv->bounce_steps) && ((*vel) * (*overshot_dist) > 0)) {
+      *vel *= pow (1.0 - ABS (*overshot_dist) / overshoot_max, steps);
+    } else {
+      *vel = MAX (ABS (*overshot_dist) * 0.8, 10.0);
+      if (*overshot_dist > 0)
+        *vel *= -1;
+    }
+
+    dist = *overshot_dist + (*vel) * steps;
+
+    if ((dist * (*overshot_dist)) <= 0) {
+      *overshot_dist = 0;
+      *overshooting = 0;
+      *vel = 0;
+    } else {
+      *overshot_dist = CLAMP (dist, -overshoot_max, overshoot_max);
+    }
+  }
+
+  return ((*vel != 0) || (*overshot_dist != 0));
+}
+
+static void
+hildon_pannable_area_kinetic_step (HildonPannableArea *area,
+                                   gint64 now)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  gboolean moving = FALSE;
+  gdouble steps;
+
+  steps = (now - priv->last_frame_time) * priv->sps / (gdouble) G_USEC_PER_SEC;
+  priv->last_frame_time = now;
+
+  /* Do not jump after a stall, the movement just goes on slower */
+  steps = CLAMP (steps, 0.0, 4.0);
+
+  if (priv->mov_mode & HILDON_MOVEMENT_MODE_HORIZ)
+    moving |= hildon_pannable_axis_scroll (area,
+                                           gtk_scrolled_window_get_hadjustment (GTK_SCROLLED_WINDOW (area)),
+                                           &priv->vel_x,
+                                           &priv->overshot_dist_x,
+                                           &priv->overshooting_x,
+                                           priv->hovershoot_max,
+                                           steps);
+
+  if (priv->mov_mode & HILDON_MOVEMENT_MODE_VERT)
+    moving |= hildon_pannable_axis_scroll (area,
+                                           gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (area)),
+                                           &priv->vel_y,
+                                           &priv->overshot_dist_y,
+                                           &priv->overshooting_y,
+                                           priv->vovershoot_max,
+                                           steps);
+
+  hildon_pannable_area_apply_overshoot (area);
+
+  /* In acceleration mode the movement goes on while the pointer is
+   * pressed, even if it is stopped at an edge */
+  if (!moving && !priv->button_pressed) {
+    priv->panning = FALSE;
+    g_signal_emit (area, pannable_area_signals[PANNING_FINISHED], 0);
+  }
+}
+
+static void hildon_pannable_area_launch (HildonPannableArea *area);
+
+static void
+hildon_pannable_area_push_sample (HildonPannableArea *area,
+                                  gdouble x,
+                                  gdouble y,
+                                  guint32 time)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  HildonPannableAreaSample *sample = &priv->samples[priv->sample_head];
+
+  sample->x = x;
+  sample->y = y;
+  sample->time = time;
+
+  priv->sample_head = (priv->sample_head + 1) % MOTION_SAMPLES;
+  priv->n_samples = MIN (priv->n_samples + 1, MOTION_SAMPLES);
+}
+
+static HildonPannableAreaSample *
+hildon_pannable_area_get_sample (HildonPannableArea *area,
+                                 guint age)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+
+  g_assert (age < priv->n_samples);
+
+  return &priv->samples[(priv->sample_head + MOTION_SAMPLES - 1 - age) % MOTION_SAMPLES];
+}
+
+/* Calculates the launch velocity as the slope of a weighted least
+ * squares fit of the positions in the last VELOCITY_SAMPLE_WINDOW
+ * miliseconds. Each older sample weights drag_inertia times the
+ * following one, so a single noisy event can not spoil the flick. */
+static void
+hildon_pannable_area_get_drag_velocity (HildonPannableArea *area,
+                                        gdouble *vel_x,
+                                        gdouble *vel_y)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  HildonPannableAreaSample *last;
+  gdouble sw = 0, st = 0, stt = 0, sx = 0, sy = 0, stx = 0, sty = 0;
+  gdouble w = 1.0, decay, den;
+  guint i;
+
+  *vel_x = 0;
+  *vel_y = 0;
+
+  if (priv->n_samples < 2)
+    return;
+
+  decay = CLAMP (priv->drag_inertia, 0.1, 1.0);
+  last = hildon_pannable_area_get_sample (area, 0);
+
+  for (i = 0; i < priv->n_samples; i++) {
+    HildonPannableAreaSample *sample = hildon_pannable_area_get_sample (area, i);
+    gdouble t = (gint32) (sample->time - last->time);
+
+    if (-t > VELOCITY_SAMPLE_WINDOW)
+      break;
+
+    sw += w;
+    st += w * t;
+    stt += w * t * t;
+    sx += w * sample->x;
+    sy += w * sample->y;
+    stx += w * t * sample->x;
+    sty += w * t * sample->y;
+
+    w *= decay;
+  }
+
+  den = sw * stt - st * st;
+
+  if ((i < 2) || (den <= 0))
+    return;
+
+  /* The contents move against the pointer, the slope is in pixels
+   * per milisecond and force turns it into pixels per step */
+  *vel_x = -((sw * stx - st * sx) / den) * priv->force;
+  *vel_y = -((sw * sty - st * sy) / den) * priv->force;
+
+  *vel_x = CLAMP (*vel_x, -priv->vmax, priv->vmax);
+  *vel_y = CLAMP (*vel_y, -priv->vmax, priv->vmax);
+}
+
+/* Applies the newest pointer position, all the motion events
+ * received since the previous frame end up in a single update */
+static void
+hildon_pannable_area_motion_step (HildonPannableArea *area)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  HildonPannableAreaSample *sample;
+
+  priv->motion_pending = FALSE;
+
+  if (priv->n_samples == 0)
+    return;
+
+  sample = hildon_pannable_area_get_sample (area, 0);
+
+  switch (priv->mode) {
+  case HILDON_PANNABLE_AREA_MODE_ACCEL:
+    {
+      GtkAllocation allocation;
+      gdouble dx = sample->x - priv->ix;
+      gdouble dy = sample->y - priv->iy;
+
+      /* Set acceleration relative to the initial click */
+      gtk_widget_get_allocation (GTK_WIDGET (area), &allocation);
+
+      if ((priv->mov_mode & HILDON_MOVEMENT_MODE_HORIZ) && (allocation.width > 0))
+        priv->vel_x = ((dx > 0) ? -1 : 1) *
+          (((ABS (dx) / (gdouble) allocation.width) *
+            (priv->vmax - priv->vmin)) + priv->vmin);
+
+      if ((priv->mov_mode & HILDON_MOVEMENT_MODE_VERT) && (allocation.height > 0))
+        priv->vel_y = ((dy > 0) ? -1 : 1) *
+          (((ABS (dy) / (gdouble) allocation.height) *
+            (priv->vmax - priv->vmin)) + priv->vmin);
+
+      hildon_pannable_area_launch (area);
+    }
+    break;
+  case HILDON_PANNABLE_AREA_MODE_PUSH:
+  case HILDON_PANNABLE_AREA_MODE_AUTO:
+    if (priv->mov_mode & HILDON_MOVEMENT_MODE_HORIZ)
+      hildon_pannable_axis_drag (gtk_scrolled_window_get_hadjustment (GTK_SCROLLED_WINDOW (area)),
+                                 priv->drag_start_hvalue - (sample->x - priv->motion_x),
+                                 &priv->overshot_dist_x,
+                                 priv->hovershoot_max);
+
+    if (priv->mov_mode & HILDON_MOVEMENT_MODE_VERT)
+      hildon_pannable_axis_drag (gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (area)),
+                                 priv->drag_start_vvalue - (sample->y - priv->motion_y),
+                                 &priv->overshot_dist_y,
+                                 priv->vovershoot_max);
+
+    hildon_pannable_area_apply_overshoot (area);
+    break;
+  default:
+    break;
+  }
+}
+
+/* Places the scroll indicators according to the adjustments, in
+ * widget coordinates */
+static void
+hildon_pannable_area_compute_indicators (HildonPannableArea *area)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  GtkAllocation allocation;
+  GtkAdjustment *hadj;
+  GtkAdjustment *vadj;
+  gdouble range, page;
+
+  gtk_widget_get_allocation (GTK_WIDGET (area), &allocation);
+
+  hadj = gtk_scrolled_window_get_hadjustment (GTK_SCROLLED_WINDOW (area));
+  vadj = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (area));
+
+  range = gtk_adjustment_get_upper (vadj) - gtk_adjustment_get_lower (vadj);
+  page = gtk_adjustment_get_page_size (vadj);
+  priv->vscroll_visible = (priv->vscrollbar_policy != GTK_POLICY_NEVER) &&
+    ((priv->vscrollbar_policy == GTK_POLICY_ALWAYS) ||
+     (range - page > RATIO_TOLERANCE));
+
+  if (priv->vscroll_visible) {
+    gdouble value = gtk_adjustment_get_value (vadj) - gtk_adjustment_get_lower (vadj);
+
+    priv->vscroll_rect.width = priv->indicator_width;
+    priv->vscroll_rect.height = (range > 0) ?
+      MAX (SCROLL_BAR_MIN_SIZE, allocation.height * page / range) : allocation.height;
+    priv->vscroll_rect.height = MIN (priv->vscroll_rect.height, allocation.height);
+    priv->vscroll_rect.x = allocation.width - priv->indicator_width;
+    priv->vscroll_rect.y = (range - page > RATIO_TOLERANCE) ?
+      (allocation.height - priv->vscroll_rect.height) * CLAMP (value / (range - page), 0, 1) : 0;
+  }
+
+  range = gtk_adjustment_get_upper (hadj) - gtk_adjustment_get_lower (hadj);
+  page = gtk_adjustment_get_page_size (hadj);
+  priv->hscroll_visible = (priv->hscrollbar_policy != GTK_POLICY_NEVER) &&
+    ((priv->hscrollbar_policy == GTK_POLICY_ALWAYS) ||
+     (range - page > RATIO_TOLERANCE));
+
+  if (priv->hscroll_visible) {
+    gdouble value = gtk_adjustment_get_value (hadj) - gtk_adjustment_get_lower (hadj);
+    gint length = allocation.width - (priv->vscroll_visible ? priv->indicator_width : 0);
+
+    priv->hscroll_rect.height = priv->indicator_width;
+    priv->hscroll_rect.width = (range > 0) ?
+      MAX (SCROLL_BAR_MIN_SIZE, length * page / range) : length;
+    priv->hscroll_rect.width = MIN (priv->hscroll_rect.width, length);
+    priv->hscroll_rect.y = allocation.height - priv->indicator_width;
+    priv->hscroll_rect.x = (range - page > RATIO_TOLERANCE) ?
+      (length - priv->hscroll_rect.width) * CLAMP (value / (range - page), 0, 1) : 0;
+  }
+}
+
+/* Only the indicators are redrawn, not the contents below them */
+static void
+hildon_pannable_area_invalidate_indicators (HildonPannableArea *area)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  GtkWidget *widget = GTK_WIDGET (area);
+
+  if (priv->scroll_indicator_alpha <= 0.0)
+    return;
+
+  if (priv->vscroll_visible)
+    gtk_widget_queue_draw_area (widget,
+                                priv->vscroll_rect.x, priv->vscroll_rect.y,
+                                priv->vscroll_rect.width, priv->vscroll_rect.height);
+
+  if (priv->hscroll_visible)
+    gtk_widget_queue_draw_area (widget,
+                                priv->hscroll_rect.x, priv->hscroll_rect.y,
+                                priv->hscroll_rect.width, priv->hscroll_rect.height);
+}
+
+static void
+hildon_pannable_area_free_indicators (HildonPannableArea *area)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+
+  g_clear_pointer (&priv->vindicator.surface, cairo_surface_destroy);
+  g_clear_pointer (&priv->hindicator.surface, cairo_surface_destroy);
+}
+
+/* Makes the indicators fully visible, they start fading out
+ * scrollbar_fade_delay miliseconds after the last call */
+static void
+hildon_pannable_area_show_indicators (HildonPannableArea *area)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  gboolean running;
+  gint64 now;
+
+  if (!priv->vscroll_visible && !priv->hscroll_visible)
+    return;
+
+  running = (priv->scroll_indicator_alpha > 0.0) || priv->fade_in;
+
+  if (!hildon_pannable_area_begin_updating (area))
+    return;
+
+  now = gdk_frame_clock_get_frame_time (priv->clock);
+
+  if (!running)
+    priv->indicator_frame_time = now;
+
+  priv->indicator_visible_until = now +
+    (gint64) priv->scrollbar_fade_delay * SCROLL_FADE_TIMEOUT * 1000;
+
+  if (priv->scroll_indicator_alpha < 1.0)
+    priv->fade_in = TRUE;
+}
+
+/* Advances the fading of the indicators. The alpha changes 0.2 every
+ * SCROLL_FADE_IN_TIMEOUT when appearing and 0.1 every
+ * SCROLL_FADE_TIMEOUT when disappearing. */
+static void
+hildon_pannable_area_indicator_step (HildonPannableArea *area,
+                                     gint64 now)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  gdouble elapsed, alpha;
+
+  elapsed = (now - priv->indicator_frame_time) / 1000.0;
+  priv->indicator_frame_time = now;
+
+  alpha = priv->scroll_indicator_alpha;
+
+  if (priv->fade_in) {
+    alpha = MIN (1.0, alpha + elapsed * 0.2 / SCROLL_FADE_IN_TIMEOUT);
+    if (alpha >= 1.0)
+      priv->fade_in = FALSE;
+  } else if ((now >= priv->indicator_visible_until) &&
+             !priv->button_pressed && !priv->panning) {
+    alpha = MAX (0.0, alpha - elapsed * 0.1 / SCROLL_FADE_TIMEOUT);
+  }
+
+  if (alpha != priv->scroll_indicator_alpha) {
+    /* Invalidate before and after, so the last frame is cleared */
+    hildon_pannable_area_invalidate_indicators (area);
+    priv->scroll_indicator_alpha = alpha;
+    hildon_pannable_area_invalidate_indicators (area);
+  }
+}
+
+static void
+hildon_pannable_area_adjust_value_changed (GtkAdjustment *adjust,
+                                           HildonPannableArea *area)
+{
+  if (gtk_widget_in_destruction (GTK_WIDGET (area)))
+    return;
+
+  hildon_pannable_area_invalidate_indicators (area);
+  hildon_pannable_area_compute_indicators (area);
+  hildon_pannable_area_invalidate_indicators (area);
+
+  if (adjust == gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (area)))
+    hildon_pannable_area_queue_update_items (area, FALSE);
+
+  if (gtk_widget_get_mapped (GTK_WIDGET (area)))
+    hildon_pannable_area_show_indicators (area);
+}
+
+static void
+hildon_pannable_area_adjust_changed (GtkAdjustment *adjust,
+                                     HildonPannableArea *area)
+{
+  if (gtk_widget_in_destruction (GTK_WIDGET (area)))
+    return;
+
+  hildon_pannable_area_invalidate_indicators (area);
+  hildon_pannable_area_compute_indicators (area);
+  hildon_pannable_area_invalidate_indicators (area);
+}
+
+static void
+hildon_pannable_area_paint_indicator (HildonPannableArea *area,
+                                      cairo_t *cr,
+                                      HildonPannableAreaIndicator *indicator,
+                                      GdkRectangle *rect)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+
+  if ((rect->width <= 0) || (rect->height <= 0))
+    return;
+
+  /* The bar only needs rendering again when its size changes,
+   * moving and fading just paints the cached surface */
+  if ((indicator->surface == NULL) ||
+      (indicator->width != rect->width) ||
+      (indicator->height != rect->height)) {
+    gdouble radius = MIN (rect->width, rect->height) / 2.0;
+    cairo_t *icr;
+
+    if (indicator->surface)
+      cairo_surface_destroy (indicator->surface);
+
+    indicator->surface =
+      gdk_window_create_similar_surface (gtk_widget_get_window (GTK_WIDGET (area)),
+                                         CAIRO_CONTENT_COLOR_ALPHA,
+                                         rect->width, rect->height);
+    indicator->width = rect->width;
+    indicator->height = rect->height;
+
+    icr = cairo_create (indicator->surface);
+    cairo_new_sub_path (icr);
+    cairo_arc (icr, rect->width - radius, radius, radius, -G_PI_2, 0);
+    cairo_arc (icr, rect->width - radius, rect->height - radius, radius, 0, G_PI_2);
+    cairo_arc (icr, radius, rect->height - radius, radius, G_PI_2, G_PI);
+    cairo_arc (icr, radius, radius, radius, G_PI, 3 * G_PI_2);
+    cairo_close_path (icr);
+    gdk_cairo_set_source_rgba (icr, &priv->scroll_color);
+    cairo_fill (icr);
+    cairo_destroy (icr);
+  }
+
+  cairo_set_source_surface (cr, indicator->surface, rect->x, rect->y);
+  cairo_paint_with_alpha (cr, priv->scroll_indicator_alpha);
+}
+
+static gboolean
+hildon_pannable_area_draw (GtkWidget *widget,
+                           cairo_t *cr)
+{
+  HildonPannableArea *area = HILDON_PANNABLE_AREA (widget);
+  HildonPannableAreaPrivate *priv = area->priv;
+
+  GTK_WIDGET_CLASS (hildon_pannable_area_parent_class)->draw (widget, cr);
+
+  if (priv->scroll_indicator_alpha > 0.0) {
+    cairo_save (cr);
+
+    if (priv->vscroll_visible)
+      hildon_pannable_area_paint_indicator (area, cr, &priv->vindicator,
+                                            &priv->vscroll_rect);
+
+    if (priv->hscroll_visible)
+      hildon_pannable_area_paint_indicator (area, cr, &priv->hindicator,
+                                            &priv->hscroll_rect);
+
+    cairo_restore (cr);
+  }
+
+  return FALSE;
+}
+
+static void
+hildon_pannable_area_style_updated (GtkWidget *widget)
+{
+  HildonPannableAreaPrivate *priv = HILDON_PANNABLE_AREA (widget)->priv;
+  GtkStyleContext *context;
+
+  GTK_WIDGET_CLASS (hildon_pannable_area_parent_class)->style_updated (widget);
+
+  context = gtk_widget_get_style_context (widget);
+  gtk_style_context_get_color (context, gtk_widget_get_state_flags (widget),
+                               &priv->scroll_color);
+  gtk_widget_style_get (widget, "indicator-width", &priv->indicator_width, NULL);
+
+  hildon_pannable_area_free_indicators (HILDON_PANNABLE_AREA (widget));
+  hildon_pannable_area_compute_indicators (HILDON_PANNABLE_AREA (widget));
+}
+
+static void
+hildon_pannable_area_on_frame_clock_update (GdkFrameClock *clock,
+                                            HildonPannableArea *area)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  gint64 now;
+
+  now = gdk_frame_clock_get_frame_time (clock);
+
+  if (priv->tweening)
+    hildon_pannable_area_tween_step (area, now);
+
+  if (priv->motion_pending)
+    hildon_pannable_area_motion_step (area);
+
+  if (priv->panning)
+    hildon_pannable_area_kinetic_step (area, now);
+
+  if ((priv->scroll_indicator_alpha > 0.0) || priv->fade_in)
+    hildon_pannable_area_indicator_step (area, now);
+
+  /* Keep the clock running while the pointer is pressed, so the
+   * motion does not need to restart it on every event */
+  if (!priv->tweening && !priv->panning && !priv->button_pressed &&
+      (priv->scroll_indicator_alpha <= 0.0) && !priv->fade_in)
+    hildon_pannable_area_end_updating (area);
+}
+
+/* Hands the adjustments to the kinetic engine, the velocity and
+ * overshoot already stored in the private struct are used as the
+ * initial state */
+static void
+hildon_pannable_area_launch (HildonPannableArea *area)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+
+  priv->tweening = FALSE;
+
+  if (!hildon_pannable_area_begin_updating (area)) {
+    if (priv->panning) {
+      priv->panning = FALSE;
+      g_signal_emit (area, pannable_area_signals[PANNING_FINISHED], 0);
+    }
+    return;
+  }
+
+  if (!priv->panning)
+    priv->last_frame_time = gdk_frame_clock_get_frame_time (priv->clock);
+
+  priv->panning = TRUE;
+}
+
+static void
+hildon_pannable_area_size_allocate (GtkWidget *widget,
+                                    GtkAllocation *allocation)
+{
+  HildonPannableAreaPrivate *priv = HILDON_PANNABLE_AREA (widget)->priv;
+  GtkWidget *child;
+
+  GTK_WIDGET_CLASS (hildon_pannable_area_parent_class)->size_allocate (widget, allocation);
+
+  child = gtk_bin_get_child (GTK_BIN (widget));
+
+  if (child && gtk_widget_get_visible (child)) {
+    gtk_widget_get_allocation (child, &priv->child_allocation);
+    priv->x_offset = 0;
+    priv->y_offset = 0;
+    hildon_pannable_area_apply_overshoot (HILDON_PANNABLE_AREA (widget));
+  }
+
+  hildon_pannable_area_compute_indicators (HILDON_PANNABLE_AREA (widget));
+  hildon_pannable_area_queue_update_items (HILDON_PANNABLE_AREA (widget), FALSE);
+}
+
+static void
+hildon_pannable_area_unrealize (GtkWidget *widget)
+{
+  HildonPannableAreaPrivate *priv = HILDON_PANNABLE_AREA (widget)->priv;
+
+  /* The frame clock goes away with the window */
+  hildon_pannable_area_remove_timeouts (widget);
+
+  priv->overshot_dist_x = 0;
+  priv->overshot_dist_y = 0;
+  priv->overshooting_x = 0;
+  priv->overshooting_y = 0;
+
+  hildon_pannable_area_free_indicators (HILDON_PANNABLE_AREA (widget));
+
+  GTK_WIDGET_CLASS (hildon_pannable_area_parent_class)->unrealize (widget);
+}
+
+static guint32
+hildon_pannable_area_get_gesture_time (GtkGesture *gesture)
+{
+  GdkEventSequence *sequence;
+  const GdkEvent *event;
+
+  sequence = gtk_gesture_single_get_current_sequence (GTK_GESTURE_SINGLE (gesture));
+  event = gtk_gesture_get_last_event (gesture, sequence);
+
+  return event ? gdk_event_get_time ((GdkEvent *) event) : GDK_CURRENT_TIME;
+}
+
+static void
+hildon_pannable_area_drag_begin (GtkGestureDrag *gesture,
+                                 gdouble start_x,
+                                 gdouble start_y,
+                                 HildonPannableArea *area)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  gboolean fast;
+
+  /* A press stops the movement, if it was fast enough the user just
+   * wanted to stop it, so the children do not get the click */
+  fast = priv->panning &&
+    (MAX (ABS (priv->vel_x), ABS (priv->vel_y)) > priv->vmax * priv->vfast_factor);
+
+  priv->tweening = FALSE;
+  if (priv->panning) {
+    priv->panning = FALSE;
+    g_signal_emit (area, pannable_area_signals[PANNING_FINISHED], 0);
+  }
+
+  priv->vel_x = 0;
+  priv->vel_y = 0;
+  priv->overshooting_x = 0;
+  priv->overshooting_y = 0;
+
+  priv->button_pressed = TRUE;
+  priv->moved = FALSE;
+  priv->ix = start_x;
+  priv->iy = start_y;
+  priv->x = start_x;
+  priv->y = start_y;
+  priv->motion_x = start_x;
+  priv->motion_y = start_y;
+  priv->last_time = hildon_pannable_area_get_gesture_time (GTK_GESTURE (gesture));
+  priv->last_press_time = priv->last_time;
+  priv->n_samples = 0;
+  priv->motion_pending = FALSE;
+
+  /* Grabbing the contents while overshooting keeps them where they
+   * are, the overshoot is part of the dragged distance */
+  priv->drag_start_hvalue = priv->overshot_dist_x +
+    gtk_adjustment_get_value (gtk_scrolled_window_get_hadjustment (GTK_SCROLLED_WINDOW (area)));
+  priv->drag_start_vvalue = priv->overshot_dist_y +
+    gtk_adjustment_get_value (gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (area)));
+
+  if (fast) {
+    priv->moved = TRUE;
+    gtk_gesture_set_state (GTK_GESTURE (gesture), GTK_EVENT_SEQUENCE_CLAIMED);
+  }
+}
+
+/* Decides if the motion is a panning gesture, emitting the gesture
+ * signals. Returns TRUE if the pannable area takes the sequence. */
+static gboolean
+hildon_pannable_area_check_move (HildonPannableArea *area,
+                                 GtkGesture *gesture,
+                                 gdouble offset_x,
+                                 gdouble offset_y)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  gboolean vertical, allowed, stop = FALSE;
+
+  if ((ABS (offset_x) < priv->panning_threshold) &&
+      (ABS (offset_y) < priv->panning_threshold))
+    return FALSE;
+
+  vertical = ABS (offset_y) >= ABS (offset_x);
+
+  if (vertical) {
+    g_signal_emit (area, pannable_area_signals[VERTICAL_MOVEMENT], 0,
+                   (offset_y > 0) ? HILDON_MOVEMENT_DOWN : HILDON_MOVEMENT_UP,
+                   (gdouble) priv->ix, (gdouble) priv->iy);
+    allowed = (priv->mov_mode & HILDON_MOVEMENT_MODE_VERT) ||
+      (ABS (offset_x) + priv->direction_error_margin >= ABS (offset_y));
+  } else {
+    g_signal_emit (area, pannable_area_signals[HORIZONTAL_MOVEMENT], 0,
+                   (offset_x > 0) ? HILDON_MOVEMENT_RIGHT : HILDON_MOVEMENT_LEFT,
+                   (gdouble) priv->ix, (gdouble) priv->iy);
+    allowed = (priv->mov_mode & HILDON_MOVEMENT_MODE_HORIZ) ||
+      (ABS (offset_y) + priv->direction_error_margin >= ABS (offset_x));
+  }
+
+  if (allowed)
+    g_signal_emit (area, pannable_area_signals[PANNING_STARTED], 0, &stop);
+
+  if (!allowed || stop) {
+    gtk_gesture_set_state (gesture, GTK_EVENT_SEQUENCE_DENIED);
+    return FALSE;
+  }
+
+  gtk_gesture_set_state (gesture, GTK_EVENT_SEQUENCE_CLAIMED);
+
+  return TRUE;
+}
+
+static void
+hildon_pannable_area_drag_update (GtkGestureDrag *gesture,
+                                  gdouble offset_x,
+                                  gdouble offset_y,
+                                  HildonPannableArea *area)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  gdouble x, y;
+  guint32 time;
+
+  x = priv->ix + offset_x;
+  y = priv->iy + offset_y;
+  time = hildon_pannable_area_get_gesture_time (GTK_GESTURE (gesture));
+
+  if (!priv->moved) {
+    if (!hildon_pannable_area_check_move (area, GTK_GESTURE (gesture),
+                                          offset_x, offset_y))
+      return;
+
+    /* Start from here, not from the press, so the contents do not
+     * jump the panning threshold */
+    priv->moved = TRUE;
+    priv->motion_x = x;
+    priv->motion_y = y;
+    priv->n_samples = 0;
+  }
+
+  /* Nothing is scrolled here, the sample is applied in the next
+   * frame clock update */
+  hildon_pannable_area_push_sample (area, x, y, time);
+  priv->x = x;
+  priv->y = y;
+  priv->last_time = time;
+
+  if (!priv->motion_pending) {
+    priv->motion_pending = TRUE;
+
+    if (!hildon_pannable_area_begin_updating (area))
+      hildon_pannable_area_motion_step (area);
+  }
+}
+
+static void
+hildon_pannable_area_drag_end (GtkGestureDrag *gesture,
+                               gdouble offset_x,
+                               gdouble offset_y,
+                               HildonPannableArea *area)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  guint32 time;
+
+  time = hildon_pannable_area_get_gesture_time (GTK_GESTURE (gesture));
+
+  /* Move all the way to the last position now */
+  if (priv->motion_pending)
+    hildon_pannable_area_motion_step (area);
+
+  priv->button_pressed = FALSE;
+
+  if (priv->mode != HILDON_PANNABLE_AREA_MODE_ACCEL) {
+    hildon_pannable_area_get_drag_velocity (area, &priv->vel_x, &priv->vel_y);
+
+    if (!(priv->mov_mode & HILDON_MOVEMENT_MODE_HORIZ))
+      priv->vel_x = 0;
+    if (!(priv->mov_mode & HILDON_MOVEMENT_MODE_VERT))
+      priv->vel_y = 0;
+
+    /* The cursor stopped before the release, it was not a flick */
+    if ((priv->mode == HILDON_PANNABLE_AREA_MODE_PUSH) ||
+        (time - priv->last_time > CURSOR_STOPPED_TIMEOUT)) {
+      priv->vel_x = 0;
+      priv->vel_y = 0;
     }
+
+    if (ABS (priv->vel_x) < priv->vmin)
+      priv->vel_x = 0;
+    if (ABS (priv->vel_y) < priv->vmin)
+      priv->vel_y = 0;
+  }
+
+  if ((priv->vel_x != 0) || (priv->vel_y != 0) ||
+      (priv->overshot_dist_x != 0) || (priv->overshot_dist_y != 0)) {
+    hildon_pannable_area_launch (area);
+  } else if (priv->panning) {
+    priv->panning = FALSE;
+    g_signal_emit (area, pannable_area_signals[PANNING_FINISHED], 0);
+  } else if (priv->moved) {
+    g_signal_emit (area, pannable_area_signals[PANNING_FINISHED], 0);
+  }
 }
 
 
@@ -1329,11 +2363,18 @@ static void hildon_pannable_area_set_value_internal (HildonPannableArea *area,
       hvalue = MAX (hvalue, gtk_adjustment_get_lower(hadj));
     }
 
-  area->priv->clock = gtk_widget_get_frame_clock (GTK_WIDGET (area));
-  
-  if (animate && priv->duration != 0 && priv->clock != NULL)
+  /* Programmatic scrolling stops any kinetic movement */
+  if (priv->panning)
+    {
+      priv->panning = FALSE;
+      priv->vel_x = 0;
+      priv->vel_y = 0;
+      g_signal_emit (area, pannable_area_signals[PANNING_FINISHED], 0);
+    }
+
+  if (animate && priv->duration != 0 && hildon_pannable_area_begin_updating (area))
     {
-      if (priv->tick_id && priv->htarget == hvalue && priv->vtarget == vvalue)
+      if (priv->tweening && priv->htarget == hvalue && priv->vtarget == vvalue)
         return;
 
       priv->vsource = gtk_adjustment_get_value (vadj);
@@ -1342,10 +2383,11 @@ static void hildon_pannable_area_set_value_internal (HildonPannableArea *area,
       priv->htarget = hvalue;
       priv->start_time = gdk_frame_clock_get_frame_time (priv->clock);
       priv->end_time = priv->start_time + 1000 * priv->duration;
-      hildon_pannable_area_begin_updating (area);
+      priv->tweening = TRUE;
     }
   else
     {
+      priv->tweening = FALSE;
       hildon_pannable_area_end_updating (area);
       gtk_adjustment_set_value (vadj, vvalue);
       gtk_adjustment_set_value (hadj, hvalue);
@@ -1775,3 +2817,332 @@ hildon_pannable_area_set_center_on_child_focus  (HildonPannableArea *area,
 
   area->priv->center_on_child_focus = value;
 }
+
+static GtkWidget *
+hildon_pannable_area_create_item (HildonPannableArea *area,
+                                  guint index,
+                                  GtkWidget *recycled)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  GtkWidget *item;
+
+  item = priv->item_factory (area, index, recycled, priv->item_factory_data);
+
+  if ((recycled != NULL) && (item != recycled))
+    gtk_widget_destroy (recycled);
+
+  /* Only complain once, the factory is not asked again until the
+   * items change */
+  if (item == NULL)
+    priv->item_factory_failed = TRUE;
+  g_return_val_if_fail (GTK_IS_WIDGET (item), NULL);
+
+  if (gtk_widget_get_parent (item) == NULL)
+    gtk_layout_put (GTK_LAYOUT (priv->item_layout), item, 0, index * priv->item_height);
+  else
+    gtk_layout_move (GTK_LAYOUT (priv->item_layout), item, 0, index * priv->item_height);
+
+  gtk_widget_set_size_request (item, priv->item_width, priv->item_height);
+  gtk_widget_show (item);
+
+  return item;
+}
+
+/* Makes sure the items in the visible region plus the prefetch
+ * margin, and only those, have a widget. Widgets scrolling out are
+ * hidden and kept for the items scrolling in. */
+static void
+hildon_pannable_area_update_items (HildonPannableArea *area,
+                                   gboolean rebind)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+  GtkAdjustment *vadj;
+  guint old_first, old_last, first, last, i;
+  gdouble top, bottom;
+  gint width;
+
+  if ((priv->item_layout == NULL) || priv->item_factory_failed)
+    return;
+
+  vadj = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (area));
+  top = gtk_adjustment_get_value (vadj) - priv->prefetch_margin;
+  bottom = gtk_adjustment_get_value (vadj) + gtk_adjustment_get_page_size (vadj) +
+    priv->prefetch_margin;
+
+  first = (top > 0) ? MIN ((guint) (top / priv->item_height), priv->n_items) : 0;
+  last = (bottom > 0) ? MIN ((guint) ceil (bottom / priv->item_height), priv->n_items) : 0;
+  last = MAX (first, last);
+
+  width = gtk_widget_get_allocated_width (priv->item_layout);
+  if (width != priv->item_width) {
+    priv->item_width = width;
+    rebind = TRUE;
+  }
+
+  if (!rebind && (first == priv->first_item) && (last - first == priv->items->len))
+    return;
+
+  /* Release the items leaving the range, they are the ones the
+   * factory gets to recycle */
+  old_first = priv->first_item;
+  old_last = old_first + priv->items->len;
+
+  for (i = 0; i < priv->items->len; i++) {
+    GtkWidget *item = g_ptr_array_index (priv->items, i);
+
+    if ((item != NULL) &&
+        ((old_first + i < first) || (old_first + i >= last) ||
+         (old_first + i >= priv->n_items))) {
+      gtk_widget_hide (item);
+      g_queue_push_tail (&priv->spare_items, item);
+      g_ptr_array_index (priv->items, i) = NULL;
+    }
+  }
+
+  /* Move the items kept to their new slots, in place: the array only
+   * grows when the visible region does */
+  if ((first >= old_last) || (last <= old_first)) {
+    g_ptr_array_set_size (priv->items, 0);
+  } else if (first > old_first) {
+    g_ptr_array_remove_range (priv->items, 0, first - old_first);
+  } else if (first < old_first) {
+    guint len = priv->items->len;
+
+    g_ptr_array_set_size (priv->items, len + old_first - first);
+    memmove (priv->items->pdata + old_first - first, priv->items->pdata,
+             len * sizeof (gpointer));
+    memset (priv->items->pdata, 0, (old_first - first) * sizeof (gpointer));
+  }
+
+  g_ptr_array_set_size (priv->items, last - first);
+  priv->first_item = first;
+
+  for (i = 0; i < priv->items->len; i++) {
+    GtkWidget *item = g_ptr_array_index (priv->items, i);
+
+    if (item == NULL)
+      item = hildon_pannable_area_create_item (area, first + i,
+                                               g_queue_pop_head (&priv->spare_items));
+    else if (rebind)
+      item = hildon_pannable_area_create_item (area, first + i, item);
+
+    g_ptr_array_index (priv->items, i) = item;
+
+    if (item == NULL)
+      return;
+  }
+}
+
+static gboolean
+hildon_pannable_area_items_tick (GtkWidget *widget,
+                                 GdkFrameClock *frame_clock,
+                                 gpointer user_data)
+{
+  HildonPannableAreaPrivate *priv = HILDON_PANNABLE_AREA (widget)->priv;
+  gboolean rebind = priv->items_rebind;
+
+  priv->items_tick_id = 0;
+  priv->items_rebind = FALSE;
+
+  hildon_pannable_area_update_items (HILDON_PANNABLE_AREA (widget), rebind);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Item widgets are created and placed before the next frame is laid
+ * out, never while @area is being allocated or scrolled, and a
+ * single update covers all the changes in between */
+static void
+hildon_pannable_area_queue_update_items (HildonPannableArea *area,
+                                         gboolean rebind)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+
+  if (priv->item_layout == NULL)
+    return;
+
+  priv->items_rebind |= rebind;
+
+  if (priv->items_tick_id == 0)
+    priv->items_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (area),
+                                                        hildon_pannable_area_items_tick,
+                                                        NULL, NULL);
+}
+
+static void
+hildon_pannable_area_clear_items (HildonPannableArea *area)
+{
+  HildonPannableAreaPrivate *priv = area->priv;
+
+  if (priv->item_factory_destroy)
+    priv->item_factory_destroy (priv->item_factory_data);
+
+  priv->item_factory = NULL;
+  priv->item_factory_data = NULL;
+  priv->item_factory_destroy = NULL;
+  priv->item_factory_failed = FALSE;
+
+  if (priv->items_tick_id != 0) {
+    gtk_widget_remove_tick_callback (GTK_WIDGET (area), priv->items_tick_id);
+    priv->items_tick_id = 0;
+  }
+  priv->items_rebind = FALSE;
+
+  if (priv->items) {
+    g_ptr_array_free (priv->items, TRUE);
+    priv->items = NULL;
+  }
+  g_queue_clear (&priv->spare_items);
+
+  /* The item widgets go away with the layout */
+  if (priv->item_layout) {
+    GtkWidget *layout = priv->item_layout;
+
+    priv->item_layout = NULL;
+    gtk_widget_destroy (layout);
+  }
+
+  priv->n_items = 0;
+  priv->first_item = 0;
+}
+
+/**
+ * hildon_pannable_area_set_item_factory:
+ * @area: A #HildonPannableArea.
+ * @n_items: the number of items.
+ * @item_height: the height, in pixels, of every item.
+ * @factory: (allow-none): a #HildonPannableAreaItemFactory, or %NULL
+ * to stop using one.
+ * @data: user data to pass to @factory.
+ * @destroy: (allow-none): destroy notifier for @data.
+ *
+ * Makes @area show a vertical list of @n_items items of
+ * @item_height pixels, which widgets are created on demand by
+ * @factory. Only the items intersecting the visible region, plus the
+ * #HildonPannableArea:prefetch-margin, have a widget at any moment:
+ * the widgets of the items scrolling out are hidden and passed back
+ * to @factory to be reused for the items scrolling in.
+ *
+ * This is useful for long lists of widgets, e.g. a settings screen
+ * with hundreds of buttons, where creating all the widgets up front
+ * dominates the startup time and memory usage.
+ *
+ * @area must not have a child when this function is called, it
+ * manages its own child until this function is called again with a
+ * %NULL @factory.
+ *
+ * Since: 3.0
+ **/
+void
+hildon_pannable_area_set_item_factory (HildonPannableArea *area,
+                                       guint n_items,
+                                       gint item_height,
+                                       HildonPannableAreaItemFactory factory,
+                                       gpointer data,
+                                       GDestroyNotify destroy)
+{
+  HildonPannableAreaPrivate *priv;
+
+  g_return_if_fail (HILDON_IS_PANNABLE_AREA (area));
+  g_return_if_fail (factory == NULL || item_height > 0);
+
+  priv = area->priv;
+
+  hildon_pannable_area_clear_items (area);
+
+  if (factory == NULL)
+    return;
+
+  g_return_if_fail (gtk_bin_get_child (GTK_BIN (area)) == NULL);
+
+  priv->item_factory = factory;
+  priv->item_factory_data = data;
+  priv->item_factory_destroy = destroy;
+  priv->n_items = n_items;
+  priv->item_height = item_height;
+  priv->item_width = -1;
+  priv->items = g_ptr_array_new ();
+
+  priv->item_layout = gtk_layout_new (NULL, NULL);
+  gtk_layout_set_size (GTK_LAYOUT (priv->item_layout), 1, n_items * item_height);
+  gtk_container_add (GTK_CONTAINER (area), priv->item_layout);
+  gtk_widget_show (priv->item_layout);
+
+  hildon_pannable_area_queue_update_items (area, FALSE);
+}
+
+/**
+ * hildon_pannable_area_items_changed:
+ * @area: A #HildonPannableArea with an item factory.
+ * @n_items: the new number of items.
+ *
+ * Tells @area the items set with
+ * hildon_pannable_area_set_item_factory() changed. The widgets of the
+ * items currently in the visible region are passed to the factory
+ * again to be updated.
+ *
+ * Since: 3.0
+ **/
+void
+hildon_pannable_area_items_changed (HildonPannableArea *area,
+                                    guint n_items)
+{
+  HildonPannableAreaPrivate *priv;
+
+  g_return_if_fail (HILDON_IS_PANNABLE_AREA (area));
+
+  priv = area->priv;
+
+  g_return_if_fail (priv->item_layout != NULL);
+
+  priv->n_items = n_items;
+  gtk_layout_set_size (GTK_LAYOUT (priv->item_layout), 1, n_items * priv->item_height);
+
+  /* The factory gets another chance with the new items */
+  priv->item_factory_failed = FALSE;
+  hildon_pannable_area_queue_update_items (area, TRUE);
+}
+
+/**
+ * hildon_pannable_area_get_prefetch_margin:
+ * @area: A #HildonPannableArea
+ *
+ * Gets the @area #HildonPannableArea:prefetch-margin property value.
+ *
+ * Returns: the @area #HildonPannableArea:prefetch-margin value
+ *
+ * Since: 3.0
+ **/
+gint
+hildon_pannable_area_get_prefetch_margin (HildonPannableArea *area)
+{
+  g_return_val_if_fail (HILDON_IS_PANNABLE_AREA (area), 0);
+
+  return area->priv->prefetch_margin;
+}
+
+/**
+ * hildon_pannable_area_set_prefetch_margin:
+ * @area: A #HildonPannableArea
+ * @margin: the new value, in pixels
+ *
+ * Sets the @area #HildonPannableArea:prefetch-margin property to
+ * @margin.
+ *
+ * Since: 3.0
+ **/
+void
+hildon_pannable_area_set_prefetch_margin (HildonPannableArea *area,
+                                          gint margin)
+{
+  g_return_if_fail (HILDON_IS_PANNABLE_AREA (area));
+  g_return_if_fail (margin >= 0);
+
+  if (area->priv->prefetch_margin == margin)
+    return;
+
+  area->priv->prefetch_margin = margin;
+  hildon_pannable_area_queue_update_items (area, FALSE);
+
+  g_object_notify (G_OBJECT (area), "prefetch-margin");
+}
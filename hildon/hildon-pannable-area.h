@@ -146,6 +146,26 @@ struct                                          _HildonPannableAreaClass
                               gdouble x, gdouble y);
 };
 
+/**
+ * HildonPannableAreaItemFactory:
+ * @area: the #HildonPannableArea
+ * @index: the index of the item that is going to become visible
+ * @recycled: (allow-none): a widget of an item no longer visible, or %NULL
+ * @user_data: the data passed to hildon_pannable_area_set_item_factory()
+ *
+ * Provides the widget for the item @index. When @recycled is not
+ * %NULL the function should update it to show the item @index and
+ * return it, returning a different widget destroys @recycled.
+ *
+ * Returns: the widget for the item @index
+ *
+ * Since: 3.0
+ */
+typedef GtkWidget * (*HildonPannableAreaItemFactory) (HildonPannableArea *area,
+                                                      guint index,
+                                                      GtkWidget *recycled,
+                                                      gpointer user_data);
+
 GType hildon_pannable_area_get_type             (void) G_GNUC_CONST;
 
 GtkWidget* hildon_pannable_area_new             (void);
@@ -174,6 +194,17 @@ GtkAdjustment* hildon_pannable_area_get_vadjustment (HildonPannableArea *area);
 gboolean hildon_pannable_area_get_center_on_child_focus (HildonPannableArea *area);
 void hildon_pannable_area_set_center_on_child_focus (HildonPannableArea *area,
                                                      gboolean value);
+void hildon_pannable_area_set_item_factory      (HildonPannableArea *area,
+                                                 guint n_items,
+                                                 gint item_height,
+                                                 HildonPannableAreaItemFactory factory,
+                                                 gpointer data,
+                                                 GDestroyNotify destroy);
+void hildon_pannable_area_items_changed         (HildonPannableArea *area,
+                                                 guint n_items);
+gint hildon_pannable_area_get_prefetch_margin   (HildonPannableArea *area);
+void hildon_pannable_area_set_prefetch_margin   (HildonPannableArea *area,
+                                                 gint margin);
 
 G_END_DECLS
 
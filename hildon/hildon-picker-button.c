@@ -31,6 +31,20 @@
  * the common use cases of buttons to select date and time, you can use #HildonDateButton
  * and #HildonTimeButton.
  *
+ * Building a #HildonTouchSelector is expensive, and most buttons on a
+ * screen are never clicked. Instead of a selector, a
+ * #HildonPickerButtonSelectorFactory can be set with
+ * hildon_picker_button_set_selector_factory(). The selector is then
+ * only built the first time it is needed, usually when the button is
+ * clicked. Until then, the value label shows whatever is set with
+ * hildon_button_set_value(). With hildon_picker_button_set_selector_timeout(),
+ * the selector is destroyed again some time after the dialog is
+ * closed.
+ *
+ * All the #HildonPickerButton<!-- -->s in a window share a single
+ * #HildonPickerDialog, which is kept after it is closed and only gets
+ * the selector and title of the button clicked.
+ *
  * <example>
  * <programlisting>
  * GtkWidget *
@@ -71,6 +85,7 @@
 #include "hildon-picker-button.h"
 #include "hildon-picker-button-private.h"
 #include "hildon-picker-dialog.h"
+#include "hildon-picker-dialog-private.h"
 
 G_DEFINE_TYPE (HildonPickerButton, hildon_picker_button, HILDON_TYPE_BUTTON)
 
@@ -79,12 +94,30 @@ G_DEFINE_TYPE (HildonPickerButton, hildon_picker_button, HILDON_TYPE_BUTTON)
 
 typedef struct _HildonPickerButtonPrivate HildonPickerButtonPrivate;
 
+/* State of the picker dialog shared by all the buttons of a
+   toplevel, stored on the dialog itself */
+#define PICKER_DIALOG_POOL_KEY "hildon-picker-dialog-pool"
+
+typedef struct
+{
+  HildonPickerButton *owner;    /* button whose selector is in the dialog */
+  gchar *default_done_label;
+} PickerDialogPool;
+
 struct _HildonPickerButtonPrivate
 {
   GtkWidget *selector;
-  GtkWidget *dialog;
+  GtkWidget *dialog;            /* weak pointer to the pooled dialog */
   gchar *done_button_text;
   guint disable_value_changed : 1;
+
+  HildonPickerButtonSelectorFactory factory;
+  gpointer factory_data;
+  GDestroyNotify factory_destroy;
+
+  guint selector_timeout;       /* seconds, 0 to keep the selector */
+  guint release_id;
+  GArray *released_active;      /* active rows of the last released selector */
 };
 
 /* Signals */
@@ -97,7 +130,8 @@ enum
 enum
 {
   PROP_SELECTOR = 1,
-  PROP_DONE_BUTTON_TEXT
+  PROP_DONE_BUTTON_TEXT,
+  PROP_SELECTOR_TIMEOUT
 };
 
 static guint picker_button_signals[LAST_SIGNAL] = { 0 };
@@ -114,6 +148,17 @@ static void
 hildon_picker_button_selector_columns_changed   (HildonTouchSelector * selector,
                                                  gpointer user_data);
 
+static void
+_set_selector                                   (HildonPickerButton  *button,
+                                                 HildonTouchSelector *selector,
+                                                 gboolean             update_value);
+
+static void
+_release_selector                               (HildonPickerButton *button);
+
+static void
+_detach_dialog                                  (HildonPickerButton *button);
+
 
 static void
 hildon_picker_button_get_property (GObject * object, guint property_id,
@@ -128,6 +173,10 @@ hildon_picker_button_get_property (GObject * object, guint property_id,
     g_value_set_string (value,
                         hildon_picker_button_get_done_button_text (HILDON_PICKER_BUTTON (object)));
     break;
+  case PROP_SELECTOR_TIMEOUT:
+    g_value_set_uint (value,
+                      hildon_picker_button_get_selector_timeout (HILDON_PICKER_BUTTON (object)));
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -146,6 +195,10 @@ hildon_picker_button_set_property (GObject * object, guint property_id,
     hildon_picker_button_set_done_button_text (HILDON_PICKER_BUTTON (object),
                                                g_value_get_string (value));
     break;
+  case PROP_SELECTOR_TIMEOUT:
+    hildon_picker_button_set_selector_timeout (HILDON_PICKER_BUTTON (object),
+                                               g_value_get_uint (value));
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -158,6 +211,24 @@ hildon_picker_button_finalize (GObject * object)
 
   priv = GET_PRIVATE (object);
 
+  if (priv->release_id) {
+    g_source_remove (priv->release_id);
+    priv->release_id = 0;
+  }
+
+  if (priv->factory_destroy)
+    priv->factory_destroy (priv->factory_data);
+  priv->factory = NULL;
+  priv->factory_data = NULL;
+  priv->factory_destroy = NULL;
+
+  if (priv->released_active) {
+    g_array_free (priv->released_active, TRUE);
+    priv->released_active = NULL;
+  }
+
+  _detach_dialog (HILDON_PICKER_BUTTON (object));
+
   if (priv->selector) {
     g_signal_handlers_disconnect_by_func (priv->selector,
                                           hildon_picker_button_selector_selection_changed,
@@ -169,7 +240,7 @@ hildon_picker_button_finalize (GObject * object)
     priv->selector = NULL;
   }
   if (priv->dialog) {
-    gtk_widget_destroy (priv->dialog);
+    g_object_remove_weak_pointer (G_OBJECT (priv->dialog), (gpointer *) &priv->dialog);
     priv->dialog = NULL;
   }
 
@@ -212,13 +283,27 @@ hildon_picker_button_disable_value_changed      (HildonPickerButton *button,
   priv->disable_value_changed = disable;
 }
 
+/* Whether the pooled dialog is open with the selector of @button */
+static gboolean
+_dialog_shows_selector (HildonPickerButton *button)
+{
+  HildonPickerButtonPrivate *priv = GET_PRIVATE (button);
+  PickerDialogPool *pool;
+
+  if (priv->dialog == NULL || !gtk_widget_get_visible (priv->dialog))
+    return FALSE;
+
+  pool = g_object_get_data (G_OBJECT (priv->dialog), PICKER_DIALOG_POOL_KEY);
+
+  return pool->owner == button;
+}
+
 static void
 _selection_changed (HildonPickerButton *button)
 {
   HildonPickerButtonPrivate *priv = GET_PRIVATE (button);
 
-  if (!GTK_IS_WINDOW (priv->dialog) ||
-      !gtk_widget_get_visible (GTK_WIDGET (priv->dialog))) {
+  if (!_dialog_shows_selector (button)) {
     gchar *value = hildon_touch_selector_get_current_text (HILDON_TOUCH_SELECTOR (priv->selector));
     if (value) {
       hildon_button_set_value (HILDON_BUTTON (button), value);
@@ -228,6 +313,180 @@ _selection_changed (HildonPickerButton *button)
   }
 }
 
+/* Builds the selector with the factory, if there is one and the
+   selector does not exist yet */
+static void
+_ensure_selector (HildonPickerButton *button)
+{
+  HildonPickerButtonPrivate *priv = GET_PRIVATE (button);
+  HildonTouchSelector *selector;
+
+  if (priv->selector != NULL || priv->factory == NULL)
+    return;
+
+  selector = priv->factory (button, priv->factory_data);
+  g_return_if_fail (HILDON_IS_TOUCH_SELECTOR (selector));
+
+  /* The value label already shows the right text, and the selector
+     was built with the current value: nothing changes for the user */
+  priv->disable_value_changed = TRUE;
+
+  if (priv->released_active) {
+    gint i, n_columns;
+
+    n_columns = MIN (hildon_touch_selector_get_num_columns (selector),
+                     priv->released_active->len);
+    for (i = 0; i < n_columns; i++) {
+      gint active = g_array_index (priv->released_active, gint, i);
+
+      if (active >= 0)
+        hildon_touch_selector_set_active (selector, i, active);
+    }
+
+    g_array_free (priv->released_active, TRUE);
+    priv->released_active = NULL;
+  }
+
+  _set_selector (button, selector, FALSE);
+
+  priv->disable_value_changed = FALSE;
+}
+
+/* Destroys the selector built by the factory. The
+   active row of each column is kept, so that the next selector built
+   shows the same selection. */
+static void
+_release_selector (HildonPickerButton *button)
+{
+  HildonPickerButtonPrivate *priv = GET_PRIVATE (button);
+  HildonTouchSelector *selector;
+  gint i, n_columns;
+
+  if (priv->factory == NULL || priv->selector == NULL)
+    return;
+
+  selector = HILDON_TOUCH_SELECTOR (priv->selector);
+
+  /* Several selected rows can not be restored from the active rows */
+  if (hildon_touch_selector_has_multiple_selection (selector))
+    return;
+
+  n_columns = hildon_touch_selector_get_num_columns (selector);
+  if (priv->released_active == NULL)
+    priv->released_active = g_array_sized_new (FALSE, FALSE, sizeof (gint), n_columns);
+  g_array_set_size (priv->released_active, 0);
+  for (i = 0; i < n_columns; i++) {
+    gint active = hildon_touch_selector_get_active (selector, i);
+
+    g_array_append_val (priv->released_active, active);
+  }
+
+  _set_selector (button, NULL, FALSE);
+}
+
+static gboolean
+_release_selector_timeout (HildonPickerButton *button)
+{
+  HildonPickerButtonPrivate *priv = GET_PRIVATE (button);
+
+  priv->release_id = 0;
+
+  if (!_dialog_shows_selector (button))
+    _release_selector (button);
+
+  return FALSE;
+}
+
+static void
+picker_dialog_pool_free (PickerDialogPool *pool)
+{
+  g_free (pool->default_done_label);
+  g_slice_free (PickerDialogPool, pool);
+}
+
+/* Takes the selector of @button out of the pooled dialog, if it is
+   there */
+static void
+_detach_dialog (HildonPickerButton *button)
+{
+  HildonPickerButtonPrivate *priv = GET_PRIVATE (button);
+  PickerDialogPool *pool;
+
+  if (priv->dialog == NULL)
+    return;
+
+  pool = g_object_get_data (G_OBJECT (priv->dialog), PICKER_DIALOG_POOL_KEY);
+  if (pool->owner != button)
+    return;
+
+  gtk_widget_hide (priv->dialog);
+  hildon_picker_dialog_unset_selector (HILDON_PICKER_DIALOG (priv->dialog));
+  pool->owner = NULL;
+}
+
+static void
+hildon_picker_button_on_dialog_response (GtkDialog *dialog,
+                                         gint       response,
+                                         gpointer   user_data);
+
+static void
+picker_dialog_pool_response (GtkDialog        *dialog,
+                             gint              response,
+                             PickerDialogPool *pool)
+{
+  if (pool->owner != NULL)
+    hildon_picker_button_on_dialog_response (dialog, response, pool->owner);
+  else
+    gtk_widget_hide (GTK_WIDGET (dialog));
+}
+
+/* Returns the dialog shared by the buttons of the toplevel of
+   @button, creating it the first time. The toplevel keeps the dialog
+   alive. A button outside of a window gets a dialog of its own. */
+static GtkWidget *
+_get_pooled_dialog (HildonPickerButton *button)
+{
+  HildonPickerButtonPrivate *priv = GET_PRIVATE (button);
+  GtkWidget *parent;
+  GtkWidget *dialog;
+  GObject *holder;
+  PickerDialogPool *pool;
+
+  parent = gtk_widget_get_toplevel (GTK_WIDGET (button));
+  holder = gtk_widget_is_toplevel (parent) ? G_OBJECT (parent) : G_OBJECT (button);
+
+  dialog = g_object_get_data (holder, PICKER_DIALOG_POOL_KEY);
+  if (dialog == NULL) {
+    dialog = hildon_picker_dialog_new (gtk_widget_is_toplevel (parent) ?
+                                       GTK_WINDOW (parent) : NULL);
+
+    pool = g_slice_new0 (PickerDialogPool);
+    pool->default_done_label =
+      g_strdup (hildon_picker_dialog_get_done_label (HILDON_PICKER_DIALOG (dialog)));
+    g_object_set_data_full (G_OBJECT (dialog), PICKER_DIALOG_POOL_KEY, pool,
+                            (GDestroyNotify) picker_dialog_pool_free);
+
+    g_signal_connect (dialog, "response",
+                      G_CALLBACK (picker_dialog_pool_response), pool);
+    g_signal_connect (dialog, "delete-event",
+                      G_CALLBACK (gtk_widget_hide_on_delete), NULL);
+
+    g_object_set_data_full (holder, PICKER_DIALOG_POOL_KEY, dialog,
+                            (GDestroyNotify) gtk_widget_destroy);
+  }
+
+  if (priv->dialog != dialog) {
+    if (priv->dialog) {
+      _detach_dialog (button);
+      g_object_remove_weak_pointer (G_OBJECT (priv->dialog), (gpointer *) &priv->dialog);
+    }
+    priv->dialog = dialog;
+    g_object_add_weak_pointer (G_OBJECT (priv->dialog), (gpointer *) &priv->dialog);
+  }
+
+  return dialog;
+}
+
 static void
 hildon_picker_button_on_dialog_response (GtkDialog *dialog,
                                          gint       response,
@@ -249,50 +508,66 @@ hildon_picker_button_on_dialog_response (GtkDialog *dialog,
   }
 
   gtk_widget_hide (GTK_WIDGET (dialog));
+
+  if (priv->factory && priv->selector_timeout > 0 && priv->release_id == 0) {
+    priv->release_id = g_timeout_add_seconds (priv->selector_timeout,
+                                              (GSourceFunc) _release_selector_timeout,
+                                              button);
+  }
 }
 
 static void
 hildon_picker_button_clicked (GtkButton * button)
 {
   GtkWidget *parent;
+  GtkWidget *dialog;
+  PickerDialogPool *pool;
   HildonPickerButtonPrivate *priv;
 
   priv = GET_PRIVATE (HILDON_PICKER_BUTTON (button));
 
+  if (priv->release_id) {
+    g_source_remove (priv->release_id);
+    priv->release_id = 0;
+  }
+
+  _ensure_selector (HILDON_PICKER_BUTTON (button));
+
   g_return_if_fail (HILDON_IS_TOUCH_SELECTOR (priv->selector));
 
-  /* Create the dialog if it doesn't exist already.  */
-  if (!priv->dialog) {
-    parent = gtk_widget_get_toplevel (GTK_WIDGET (button));
-    if (gtk_widget_is_toplevel (parent)) {
-      priv->dialog = hildon_picker_dialog_new (GTK_WINDOW (parent));
-    } else {
-      priv->dialog = hildon_picker_dialog_new (NULL);
-    }
+  dialog = _get_pooled_dialog (HILDON_PICKER_BUTTON (button));
+  pool = g_object_get_data (G_OBJECT (dialog), PICKER_DIALOG_POOL_KEY);
+
+  /* Another button of the same window is still using the dialog */
+  if (pool->owner != HILDON_PICKER_BUTTON (button) && gtk_widget_get_visible (dialog))
+    gtk_dialog_response (GTK_DIALOG (dialog), GTK_RESPONSE_DELETE_EVENT);
+
+  pool->owner = HILDON_PICKER_BUTTON (button);
 
-    hildon_picker_dialog_set_selector (HILDON_PICKER_DIALOG (priv->dialog),
+  /* Only swap what changed: the dialog stays realized between uses */
+  if (hildon_picker_dialog_get_selector (HILDON_PICKER_DIALOG (dialog)) !=
+      HILDON_TOUCH_SELECTOR (priv->selector)) {
+    hildon_picker_dialog_set_selector (HILDON_PICKER_DIALOG (dialog),
                                        HILDON_TOUCH_SELECTOR (priv->selector));
-    if (priv->done_button_text) {
-      hildon_picker_dialog_set_done_label (HILDON_PICKER_DIALOG (priv->dialog),
-                                           priv->done_button_text);
-    }
+  }
+
+  hildon_picker_dialog_set_done_label (HILDON_PICKER_DIALOG (dialog),
+                                       priv->done_button_text ?
+                                       priv->done_button_text :
+                                       pool->default_done_label);
 
-    gtk_window_set_modal (GTK_WINDOW (priv->dialog),
+  parent = gtk_widget_get_toplevel (GTK_WIDGET (button));
+  if (gtk_widget_is_toplevel (parent)) {
+    gtk_window_set_modal (GTK_WINDOW (dialog),
                           gtk_window_get_modal (GTK_WINDOW (parent)));
-    gtk_window_set_title (GTK_WINDOW (priv->dialog),
-                          hildon_button_get_title (HILDON_BUTTON (button)));
-    g_signal_connect (priv->dialog, "response",
-                      G_CALLBACK (hildon_picker_button_on_dialog_response),
-                      button);
-    g_signal_connect (priv->dialog, "delete-event",
-                      G_CALLBACK (gtk_widget_hide_on_delete),
-                      NULL);
   }
+  gtk_window_set_title (GTK_WINDOW (dialog),
+                        hildon_button_get_title (HILDON_BUTTON (button)));
 
   if (_current_selector_empty (HILDON_PICKER_BUTTON (button))) {
     g_warning ("There are no elements in the selector. Nothing to show.");
   } {
-    gtk_window_present (GTK_WINDOW (priv->dialog));
+    gtk_window_present (GTK_WINDOW (dialog));
   }
 }
 
@@ -342,6 +617,26 @@ hildon_picker_button_class_init (HildonPickerButtonClass * klass)
                                                         NULL,
                                                         G_PARAM_READWRITE));
 
+  /**
+   * HildonPickerButton:selector-timeout:
+   *
+   * Number of seconds after the #HildonPickerDialog is closed before
+   * the selector built by the #HildonPickerButtonSelectorFactory is
+   * destroyed, or 0 to keep it. The dialog itself is shared by the
+   * buttons of the window and is kept. Ignored if no factory is set.
+   *
+   * Since: 3.0
+   */
+  g_object_class_install_property (object_class,
+                                   PROP_SELECTOR_TIMEOUT,
+                                   g_param_spec_uint ("selector-timeout",
+                                                      "Selector timeout",
+                                                      "Seconds before destroying the selector "
+                                                      "built by the factory once the dialog is "
+                                                      "closed, or 0 to keep it",
+                                                      0, G_MAXUINT, 0,
+                                                      G_PARAM_READWRITE));
+
   /**
    * HildonPickerButton::value-changed:
    * @widget: the widget that received the signal
@@ -371,6 +666,12 @@ hildon_picker_button_init (HildonPickerButton * self)
   priv->selector = NULL;
   priv->done_button_text = NULL;
   priv->disable_value_changed = FALSE;
+  priv->factory = NULL;
+  priv->factory_data = NULL;
+  priv->factory_destroy = NULL;
+  priv->selector_timeout = 0;
+  priv->release_id = 0;
+  priv->released_active = NULL;
 
   hildon_button_set_style (HILDON_BUTTON (self),
                            HILDON_BUTTON_STYLE_PICKER);
@@ -445,18 +746,44 @@ hildon_picker_button_set_selector (HildonPickerButton * button,
                                    HildonTouchSelector * selector)
 {
   HildonPickerButtonPrivate *priv;
-  gchar *value = NULL;
-  GtkWidget *old_selector = NULL;
 
   g_return_if_fail (HILDON_IS_PICKER_BUTTON (button));
   g_return_if_fail (!selector || HILDON_IS_TOUCH_SELECTOR (selector));
 
   priv = GET_PRIVATE (button);
 
+  /* An explicit selector replaces the factory */
+  if (priv->factory_destroy)
+    priv->factory_destroy (priv->factory_data);
+  priv->factory = NULL;
+  priv->factory_data = NULL;
+  priv->factory_destroy = NULL;
+
+  if (priv->released_active) {
+    g_array_free (priv->released_active, TRUE);
+    priv->released_active = NULL;
+  }
+
+  _set_selector (button, selector, TRUE);
+}
+
+static void
+_set_selector                                   (HildonPickerButton  *button,
+                                                 HildonTouchSelector *selector,
+                                                 gboolean             update_value)
+{
+  HildonPickerButtonPrivate *priv;
+  gchar *value = NULL;
+  GtkWidget *old_selector = NULL;
+
+  priv = GET_PRIVATE (button);
+
   if (priv->selector == (GtkWidget*) selector) {
       return;
   }
 
+  _detach_dialog (button);
+
   if (priv->selector) {
     g_signal_handlers_disconnect_by_func (priv->selector,
                                           hildon_picker_button_selector_selection_changed,
@@ -480,14 +807,17 @@ hildon_picker_button_set_selector (HildonPickerButton * button,
                       G_CALLBACK (hildon_picker_button_selector_columns_changed),
                       button);
 
-    value = hildon_touch_selector_get_current_text (HILDON_TOUCH_SELECTOR (priv->selector));
+    if (update_value)
+      value = hildon_touch_selector_get_current_text (HILDON_TOUCH_SELECTOR (priv->selector));
   }
 
-  if (!value)
-    value = g_strdup ("");
+  if (update_value) {
+    if (!value)
+      value = g_strdup ("");
 
-  hildon_button_set_value (HILDON_BUTTON (button), value);
-  hildon_picker_button_value_changed (button);
+    hildon_button_set_value (HILDON_BUTTON (button), value);
+    hildon_picker_button_value_changed (button);
+  }
 
   if (old_selector) {
       g_object_unref (old_selector);
@@ -500,7 +830,9 @@ hildon_picker_button_set_selector (HildonPickerButton * button,
  * hildon_picker_button_get_selector:
  * @button: a #HildonPickerButton
  *
- * Retrieves the #HildonTouchSelector associated to @button.
+ * Retrieves the #HildonTouchSelector associated to @button. If a
+ * #HildonPickerButtonSelectorFactory is set and the selector does not
+ * exist yet, it is built.
  *
  * Returns: a #HildonTouchSelector
  *
@@ -515,6 +847,8 @@ hildon_picker_button_get_selector (HildonPickerButton * button)
 
   priv = GET_PRIVATE (button);
 
+  _ensure_selector (button);
+
   return HILDON_TOUCH_SELECTOR (priv->selector);
 }
 
@@ -672,7 +1006,124 @@ hildon_picker_button_set_done_button_text (HildonPickerButton *button,
   priv->done_button_text = g_strdup (done_button_text);
 
   if (priv->dialog) {
-    hildon_picker_dialog_set_done_label (HILDON_PICKER_DIALOG (priv->dialog),
-                                         priv->done_button_text);
+    PickerDialogPool *pool = g_object_get_data (G_OBJECT (priv->dialog),
+                                                PICKER_DIALOG_POOL_KEY);
+
+    if (pool->owner == button)
+      hildon_picker_dialog_set_done_label (HILDON_PICKER_DIALOG (priv->dialog),
+                                           priv->done_button_text);
   }
 }
+
+/**
+ * hildon_picker_button_set_selector_factory:
+ * @button: a #HildonPickerButton
+ * @factory: a #HildonPickerButtonSelectorFactory, or %NULL
+ * @user_data: data to pass to @factory
+ * @destroy_func: destroy notifier for @user_data, or %NULL
+ *
+ * Sets the function used to build the #HildonTouchSelector of
+ * @button. Any current selector is dropped, and @factory is only
+ * called when the selector is needed: when @button is clicked or
+ * hildon_picker_button_get_selector() is called. The selector
+ * returned by @factory must show the current value of @button.
+ *
+ * Until the selector is built, the value label of @button is not
+ * taken from a selector: set it with hildon_button_set_value().
+ *
+ * See also hildon_picker_button_set_selector_timeout().
+ *
+ * Since: 3.0
+ **/
+void
+hildon_picker_button_set_selector_factory       (HildonPickerButton                *button,
+                                                 HildonPickerButtonSelectorFactory  factory,
+                                                 gpointer                           user_data,
+                                                 GDestroyNotify                     destroy_func)
+{
+  HildonPickerButtonPrivate *priv;
+
+  g_return_if_fail (HILDON_IS_PICKER_BUTTON (button));
+
+  priv = GET_PRIVATE (button);
+
+  if (priv->release_id) {
+    g_source_remove (priv->release_id);
+    priv->release_id = 0;
+  }
+
+  if (priv->released_active) {
+    g_array_free (priv->released_active, TRUE);
+    priv->released_active = NULL;
+  }
+
+  if (priv->factory_destroy)
+    priv->factory_destroy (priv->factory_data);
+
+  priv->factory = factory;
+  priv->factory_data = user_data;
+  priv->factory_destroy = destroy_func;
+
+  _set_selector (button, NULL, FALSE);
+}
+
+/**
+ * hildon_picker_button_set_selector_timeout:
+ * @button: a #HildonPickerButton
+ * @seconds: seconds to wait, or 0 to keep the selector
+ *
+ * Sets how long the selector built by the factory set with
+ * hildon_picker_button_set_selector_factory() is kept after its
+ * #HildonPickerDialog is closed. After that time, the selector is
+ * destroyed to reclaim memory, and built again the next time @button
+ * is clicked. The dialog is shared by all the buttons of the window
+ * and is not destroyed. The active row of each column is kept and
+ * selected again in the new selector. Selectors allowing multiple
+ * selection are never destroyed.
+ *
+ * Since: 3.0
+ **/
+void
+hildon_picker_button_set_selector_timeout       (HildonPickerButton *button,
+                                                 guint               seconds)
+{
+  HildonPickerButtonPrivate *priv;
+
+  g_return_if_fail (HILDON_IS_PICKER_BUTTON (button));
+
+  priv = GET_PRIVATE (button);
+
+  if (priv->selector_timeout == seconds)
+    return;
+
+  priv->selector_timeout = seconds;
+
+  if (priv->release_id) {
+    g_source_remove (priv->release_id);
+    priv->release_id = 0;
+  }
+
+  g_object_notify (G_OBJECT (button), "selector-timeout");
+}
+
+/**
+ * hildon_picker_button_get_selector_timeout:
+ * @button: a #HildonPickerButton
+ *
+ * Gets the value set with hildon_picker_button_set_selector_timeout().
+ *
+ * Returns: the number of seconds, or 0 if the selector is kept
+ *
+ * Since: 3.0
+ **/
+guint
+hildon_picker_button_get_selector_timeout       (HildonPickerButton *button)
+{
+  HildonPickerButtonPrivate *priv;
+
+  g_return_val_if_fail (HILDON_IS_PICKER_BUTTON (button), 0);
+
+  priv = GET_PRIVATE (button);
+
+  return priv->selector_timeout;
+}
@@ -58,6 +58,9 @@ struct                                          _HildonPickerButtonClass
   HildonButtonClass parent_class;
 };
 
+typedef HildonTouchSelector * (*HildonPickerButtonSelectorFactory) (HildonPickerButton *button,
+                                                                    gpointer            user_data);
+
 GType
 hildon_picker_button_get_type                   (void);
 
@@ -97,6 +100,19 @@ hildon_picker_button_set_done_button_text       (HildonPickerButton *button,
 void
 hildon_picker_button_value_changed              (HildonPickerButton *button);
 
+void
+hildon_picker_button_set_selector_factory       (HildonPickerButton                *button,
+                                                 HildonPickerButtonSelectorFactory  factory,
+                                                 gpointer                           user_data,
+                                                 GDestroyNotify                     destroy_func);
+
+void
+hildon_picker_button_set_selector_timeout       (HildonPickerButton *button,
+                                                 guint               seconds);
+
+guint
+hildon_picker_button_get_selector_timeout       (HildonPickerButton *button);
+
 G_END_DECLS
 
 #endif /* __HILDON_PICKER_BUTTON__ */
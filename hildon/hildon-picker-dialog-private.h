@@ -0,0 +1,29 @@
+/*
+ * This file is a part of hildon
+ *
+ * Copyright (C) 2009 Nokia Corporation, all rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation; version 2 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser Public License for more details.
+ *
+ */
+
+#ifndef                                         __HILDON_PICKER_DIALOG_PRIVATE__
+#define                                         __HILDON_PICKER_DIALOG_PRIVATE__
+
+#include "hildon-picker-dialog.h"
+
+G_BEGIN_DECLS
+
+G_GNUC_INTERNAL void
+hildon_picker_dialog_unset_selector             (HildonPickerDialog *dialog);
+
+G_END_DECLS
+
+#endif /* __HILDON_PICKER_DIALOG_PRIVATE__ */
@@ -51,6 +51,7 @@
 #include "hildon-touch-selector.h"
 #include "hildon-touch-selector-entry.h"
 #include "hildon-picker-dialog.h"
+#include "hildon-picker-dialog-private.h"
 
 #define _(String)  dgettext("hildon-libs", String)
 
@@ -67,7 +68,7 @@ struct _HildonPickerDialogPrivate
   gulong signal_columns_changed_id;
 
   gboolean center_on_show;
-  GSList *current_selection;
+  HildonTouchSelectorSnapshot *current_selection;
   gchar *current_text;
 };
 
@@ -598,19 +599,11 @@ hildon_picker_dialog_get_done_label (HildonPickerDialog * dialog)
   return gtk_button_get_label (GTK_BUTTON (priv->button));
 }
 
-static void
-free_path_list (GList *list)
-{
-  g_list_foreach (list, (GFunc) gtk_tree_path_free, NULL);
-  g_list_free (list);
-}
-
 static void
 _clean_current_selection (HildonPickerDialog *dialog)
 {
   if (dialog->priv->current_selection) {
-    g_slist_foreach (dialog->priv->current_selection, (GFunc) free_path_list, NULL);
-    g_slist_free (dialog->priv->current_selection);
+    hildon_touch_selector_snapshot_free (dialog->priv->current_selection);
     dialog->priv->current_selection = NULL;
   }
   if (dialog->priv->current_text) {
@@ -623,18 +616,12 @@ static void
 _save_current_selection (HildonPickerDialog *dialog)
 {
   HildonTouchSelector *selector;
-  gint i, columns;
 
   selector = HILDON_TOUCH_SELECTOR (dialog->priv->selector);
 
   _clean_current_selection (dialog);
 
-  columns = hildon_touch_selector_get_num_columns (selector);
-  for (i = 0; i  < columns; i++) {
-    dialog->priv->current_selection
-      = g_slist_append (dialog->priv->current_selection,
-                        hildon_touch_selector_get_selected_rows (selector, i));
-  }
+  dialog->priv->current_selection = hildon_touch_selector_take_snapshot (selector);
   if (HILDON_IS_TOUCH_SELECTOR_ENTRY (selector)) {
 	  HildonEntry *entry = hildon_touch_selector_entry_get_entry (HILDON_TOUCH_SELECTOR_ENTRY (selector));
 	  dialog->priv->current_text = g_strdup (gtk_entry_get_text (GTK_ENTRY (entry)));
@@ -644,13 +631,8 @@ _save_current_selection (HildonPickerDialog *dialog)
 static void
 _restore_current_selection (HildonPickerDialog *dialog)
 {
-  GSList *current_selection, *iter;
-  GList *selected, *selected_iter;
-  GtkTreePath *current_path;
+  HildonTouchSelectorSnapshot *current_selection;
   HildonTouchSelector *selector;
-  GtkTreeModel *model;
-  GtkTreeIter tree_iter;
-  gint i;
 
   if (dialog->priv->current_selection == NULL)
     return;
@@ -659,7 +641,7 @@ _restore_current_selection (HildonPickerDialog *dialog)
   selector = HILDON_TOUCH_SELECTOR (dialog->priv->selector);
 
   if (hildon_touch_selector_get_num_columns (selector) !=
-      g_slist_length (current_selection)) {
+      hildon_touch_selector_snapshot_get_n_columns (current_selection)) {
     /* We conclude that if the current selection has the same
        numbers of columns that the selector, all this ok
        Anyway this shouldn't happen. */
@@ -671,21 +653,16 @@ _restore_current_selection (HildonPickerDialog *dialog)
 
   if (dialog->priv->signal_changed_id)
     g_signal_handler_block (selector, dialog->priv->signal_changed_id);
-  for (iter = current_selection, i = 0; iter; iter = g_slist_next (iter), i++) {
-    selected = (GList *) (iter->data);
-    model = hildon_touch_selector_get_model (selector, i);
-    if (selected)
-        hildon_touch_selector_unselect_all (selector, i);
-    for (selected_iter = selected; selected_iter; selected_iter = g_list_next (selected_iter)) {
-      current_path = (GtkTreePath *) selected_iter->data;
-      if (gtk_tree_model_get_iter (model, &tree_iter, current_path))
-          hildon_touch_selector_select_iter (selector, i, &tree_iter, FALSE);
-    }
-  }
+
+  /* Emit a single HildonTouchSelector::changed per column */
+  hildon_touch_selector_begin_update (selector);
+  hildon_touch_selector_restore_snapshot (selector, current_selection);
   if (HILDON_IS_TOUCH_SELECTOR_ENTRY (selector) && dialog->priv->current_text != NULL) {
     HildonEntry *entry = hildon_touch_selector_entry_get_entry (HILDON_TOUCH_SELECTOR_ENTRY (selector));
     gtk_entry_set_text (GTK_ENTRY (entry), dialog->priv->current_text);
   }
+  hildon_touch_selector_end_update (selector);
+
   if (dialog->priv->signal_changed_id)
     g_signal_handler_unblock (selector, dialog->priv->signal_changed_id);
 }
@@ -713,6 +690,7 @@ setup_interaction_mode (HildonPickerDialog * dialog)
   if (dialog->priv->signal_changed_id) {
     g_signal_handler_disconnect (dialog->priv->selector,
                                  dialog->priv->signal_changed_id);
+    dialog->priv->signal_changed_id = 0;
   }
 
   if (requires_done_button (dialog) == FALSE) {
@@ -756,14 +734,7 @@ _hildon_picker_dialog_set_selector (HildonPickerDialog * dialog,
   g_object_ref (selector);
 
   /* Remove the old selector, if any */
-  if (dialog->priv->selector != NULL) {
-    gtk_container_remove (GTK_CONTAINER (gtk_dialog_get_content_area (GTK_DIALOG (dialog))),
-                          dialog->priv->selector);
-    if (dialog->priv->signal_columns_changed_id) {
-            g_signal_handler_disconnect (dialog->priv->selector,
-                                         dialog->priv->signal_columns_changed_id);
-    }
-  }
+  hildon_picker_dialog_unset_selector (dialog);
 
   dialog->priv->selector = GTK_WIDGET (selector);
 
@@ -786,6 +757,33 @@ _hildon_picker_dialog_set_selector (HildonPickerDialog * dialog,
   return TRUE;
 }
 
+/* Removes the selector from @dialog, so that it can be shown again
+   later with another selector */
+G_GNUC_INTERNAL void
+hildon_picker_dialog_unset_selector             (HildonPickerDialog *dialog)
+{
+  HildonPickerDialogPrivate *priv = dialog->priv;
+
+  if (priv->selector == NULL)
+    return;
+
+  if (priv->signal_changed_id) {
+    g_signal_handler_disconnect (priv->selector, priv->signal_changed_id);
+    priv->signal_changed_id = 0;
+  }
+
+  if (priv->signal_columns_changed_id) {
+    g_signal_handler_disconnect (priv->selector, priv->signal_columns_changed_id);
+    priv->signal_columns_changed_id = 0;
+  }
+
+  _clean_current_selection (dialog);
+
+  gtk_container_remove (GTK_CONTAINER (gtk_dialog_get_content_area (GTK_DIALOG (dialog))),
+                        priv->selector);
+  priv->selector = NULL;
+}
+
 /**
  * hildon_picker_dialog_set_selector:
  * @dialog: a #HildonPickerDialog
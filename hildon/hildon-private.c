@@ -28,6 +28,8 @@
 #include                                        <config.h>
 #endif
 
+#include                                        <locale.h>
+
 #include                                        "hildon-private.h"
 #include                                        "hildon-date-editor.h"
 #include                                        "hildon-time-editor.h"
@@ -155,3 +157,47 @@ hildon_gtk_window_set_flag                                        (GtkWindow
          g_signal_connect (window, "realize", G_CALLBACK (func), userdata);
      }
 }
+
+/* Models shared by the date and time selectors, keyed by the caller's
+ * key plus the current locale. The table does not own the models: an
+ * entry goes away when the last widget using its model drops it. */
+static GHashTable *shared_models = NULL;
+
+static void
+shared_model_finalized                          (gpointer  key,
+                                                 GObject  *model)
+{
+    g_hash_table_remove (shared_models, key);
+}
+
+G_GNUC_INTERNAL GtkTreeModel *
+hildon_private_get_shared_model                 (const gchar            *key,
+                                                 HildonModelCreateFunc   create_func,
+                                                 gpointer                data)
+{
+    GtkTreeModel *model;
+    gchar *full_key;
+
+    g_return_val_if_fail (key != NULL, NULL);
+    g_return_val_if_fail (create_func != NULL, NULL);
+
+    if (G_UNLIKELY (shared_models == NULL))
+        shared_models = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+    /* Labels are translated and formatted with strftime(), so a locale
+       change at runtime must not hand out models built for the old one */
+    full_key = g_strconcat (key, "|", setlocale (LC_MESSAGES, NULL),
+                            "|", setlocale (LC_TIME, NULL), NULL);
+
+    model = g_hash_table_lookup (shared_models, full_key);
+    if (model != NULL) {
+        g_free (full_key);
+        return g_object_ref (model);
+    }
+
+    model = (*create_func) (data);
+    g_hash_table_insert (shared_models, full_key, model);
+    g_object_weak_ref (G_OBJECT (model), (GWeakNotify) shared_model_finalized, full_key);
+
+    return model;
+}
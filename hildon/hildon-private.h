@@ -58,6 +58,13 @@ hildon_gtk_window_set_flag                                        (GtkWindow
                                                                    HildonFlagFunc  func,
                                                                    gpointer        userdata);
 
+typedef GtkTreeModel * (*HildonModelCreateFunc) (gpointer data);
+
+G_GNUC_INTERNAL GtkTreeModel *
+hildon_private_get_shared_model                 (const gchar            *key,
+                                                 HildonModelCreateFunc   create_func,
+                                                 gpointer                data);
+
 G_END_DECLS
 
 #endif                                          /* __HILDON_PRIVATE_H__ */
@@ -0,0 +1,78 @@
+/*
+ * This file is a part of hildon
+ *
+ * Copyright (C) 2009 Nokia Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef                                         __HILDON_RANGE_MODEL_PRIVATE_H__
+#define                                         __HILDON_RANGE_MODEL_PRIVATE_H__
+
+#include                                        <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+#define                                         HILDON_TYPE_RANGE_MODEL \
+                                                (hildon_range_model_get_type ())
+
+#define                                         HILDON_RANGE_MODEL(obj) \
+                                                (G_TYPE_CHECK_INSTANCE_CAST ((obj), \
+                                                HILDON_TYPE_RANGE_MODEL, HildonRangeModel))
+
+#define                                         HILDON_IS_RANGE_MODEL(obj) \
+                                                (G_TYPE_CHECK_INSTANCE_TYPE ((obj), \
+                                                HILDON_TYPE_RANGE_MODEL))
+
+typedef struct                                  _HildonRangeModel HildonRangeModel;
+
+typedef struct                                  _HildonRangeModelClass HildonRangeModelClass;
+
+/* The struct tm field the values of the model are stored in before
+   formatting them with strftime() */
+typedef enum
+{
+    HILDON_RANGE_MODEL_DAY,
+    HILDON_RANGE_MODEL_MONTH,
+    HILDON_RANGE_MODEL_YEAR,
+    HILDON_RANGE_MODEL_HOUR,
+    HILDON_RANGE_MODEL_MINUTE
+}                                               HildonRangeModelField;
+
+/* Model columns */
+enum
+{
+    HILDON_RANGE_MODEL_COLUMN_LABEL,
+    HILDON_RANGE_MODEL_COLUMN_VALUE,
+    HILDON_RANGE_MODEL_N_COLUMNS
+};
+
+GType G_GNUC_INTERNAL
+hildon_range_model_get_type                     (void) G_GNUC_CONST;
+
+GtkTreeModel * G_GNUC_INTERNAL
+hildon_range_model_new                          (gint                   min,
+                                                 gint                   max,
+                                                 const gchar           *format,
+                                                 HildonRangeModelField  field);
+
+void G_GNUC_INTERNAL
+hildon_range_model_set_range                    (HildonRangeModel *model,
+                                                 gint              min,
+                                                 gint              max);
+
+G_END_DECLS
+
+#endif                                          /* __HILDON_RANGE_MODEL_PRIVATE_H__ */
@@ -0,0 +1,470 @@
+/*
+ * This file is a part of hildon
+ *
+ * Copyright (C) 2009 Nokia Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*
+ * HildonRangeModel is a list model with one row for each integer in
+ * [min, max]. Rows are not stored: the value of a row is computed from
+ * its position, and its label is formatted with strftime() only when
+ * it is asked for. The last labels used are kept in a small LRU cache,
+ * as tree views ask for the same visible rows over and over.
+ *
+ * Iters hold the value of their row, so they stay valid as long as the
+ * value stays in the range. Changing the range only emits signals for
+ * the rows that enter or leave it.
+ */
+
+#ifdef                                          HAVE_CONFIG_H
+#include                                        <config.h>
+#endif
+
+#include                                        <time.h>
+
+#include                                        "hildon-range-model-private.h"
+
+#define                                         LABEL_CACHE_SIZE 32
+
+#define                                         LABEL_MAX_LENGTH 255
+
+struct                                          _HildonRangeModel
+{
+    GObject parent;
+
+    gint stamp;
+    gint min;
+    gint max;                                   /* max < min if empty */
+
+    gchar *format;
+    HildonRangeModelField field;
+
+    GQueue label_lru;                           /* LabelCacheEntry, most recent first */
+    GHashTable *labels;                         /* value -> link in label_lru */
+};
+
+struct                                          _HildonRangeModelClass
+{
+    GObjectClass parent_class;
+};
+
+typedef struct
+{
+    gint value;
+    gchar *label;
+} LabelCacheEntry;
+
+static void
+hildon_range_model_tree_model_init              (GtkTreeModelIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (HildonRangeModel, hildon_range_model, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                                hildon_range_model_tree_model_init))
+
+#define                                         VALID_ITER(model, iter) \
+                                                ((iter) != NULL && \
+                                                 (iter)->stamp == (model)->stamp && \
+                                                 GPOINTER_TO_INT ((iter)->user_data) >= (model)->min && \
+                                                 GPOINTER_TO_INT ((iter)->user_data) <= (model)->max)
+
+static void
+label_cache_clear                               (HildonRangeModel *model)
+{
+    LabelCacheEntry *entry;
+
+    while ((entry = g_queue_pop_head (&model->label_lru)) != NULL) {
+        g_free (entry->label);
+        g_slice_free (LabelCacheEntry, entry);
+    }
+
+    g_hash_table_remove_all (model->labels);
+}
+
+static const gchar *
+label_cache_lookup                              (HildonRangeModel *model,
+                                                 gint              value)
+{
+    LabelCacheEntry *entry;
+    GList *link;
+    struct tm tm = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    gchar label[LABEL_MAX_LENGTH];
+
+    link = g_hash_table_lookup (model->labels, GINT_TO_POINTER (value));
+    if (link != NULL) {
+        /* Move to the front */
+        g_queue_unlink (&model->label_lru, link);
+        g_queue_push_head_link (&model->label_lru, link);
+        return ((LabelCacheEntry *) link->data)->label;
+    }
+
+    switch (model->field) {
+    case HILDON_RANGE_MODEL_DAY:
+        tm.tm_mday = value;
+        break;
+    case HILDON_RANGE_MODEL_MONTH:
+        tm.tm_mon = value;
+        break;
+    case HILDON_RANGE_MODEL_YEAR:
+        tm.tm_year = value - 1900;
+        break;
+    case HILDON_RANGE_MODEL_HOUR:
+        tm.tm_hour = value;
+        break;
+    case HILDON_RANGE_MODEL_MINUTE:
+        tm.tm_min = value;
+        break;
+    }
+
+    if (strftime (label, LABEL_MAX_LENGTH, model->format, &tm) == 0)
+        label[0] = '\0';
+
+    if (g_queue_get_length (&model->label_lru) >= LABEL_CACHE_SIZE) {
+        entry = g_queue_pop_tail (&model->label_lru);
+        g_hash_table_remove (model->labels, GINT_TO_POINTER (entry->value));
+        g_free (entry->label);
+    } else {
+        entry = g_slice_new (LabelCacheEntry);
+    }
+
+    entry->value = value;
+    entry->label = g_strdup (label);
+    g_queue_push_head (&model->label_lru, entry);
+    g_hash_table_insert (model->labels, GINT_TO_POINTER (value),
+                         g_queue_peek_head_link (&model->label_lru));
+
+    return entry->label;
+}
+
+static void
+hildon_range_model_finalize                     (GObject *object)
+{
+    HildonRangeModel *model = HILDON_RANGE_MODEL (object);
+
+    label_cache_clear (model);
+    g_hash_table_destroy (model->labels);
+    g_free (model->format);
+
+    G_OBJECT_CLASS (hildon_range_model_parent_class)->finalize (object);
+}
+
+static void
+hildon_range_model_class_init                   (HildonRangeModelClass *klass)
+{
+    GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+    gobject_class->finalize = hildon_range_model_finalize;
+}
+
+static void
+hildon_range_model_init                         (HildonRangeModel *model)
+{
+    do {
+        model->stamp = g_random_int ();
+    } while (model->stamp == 0);
+
+    model->min = 0;
+    model->max = -1;
+    model->format = NULL;
+    model->field = HILDON_RANGE_MODEL_DAY;
+
+    g_queue_init (&model->label_lru);
+    model->labels = g_hash_table_new (g_direct_hash, g_direct_equal);
+}
+
+/* GtkTreeModel implementation */
+
+static GtkTreeModelFlags
+hildon_range_model_get_flags                    (GtkTreeModel *tree_model)
+{
+    return GTK_TREE_MODEL_LIST_ONLY | GTK_TREE_MODEL_ITERS_PERSIST;
+}
+
+static gint
+hildon_range_model_get_n_columns                (GtkTreeModel *tree_model)
+{
+    return HILDON_RANGE_MODEL_N_COLUMNS;
+}
+
+static GType
+hildon_range_model_get_column_type              (GtkTreeModel *tree_model,
+                                                 gint          index)
+{
+    g_return_val_if_fail (index >= 0 && index < HILDON_RANGE_MODEL_N_COLUMNS,
+                          G_TYPE_INVALID);
+
+    return index == HILDON_RANGE_MODEL_COLUMN_LABEL ? G_TYPE_STRING : G_TYPE_INT;
+}
+
+static gboolean
+hildon_range_model_iter_nth_child               (GtkTreeModel *tree_model,
+                                                 GtkTreeIter  *iter,
+                                                 GtkTreeIter  *parent,
+                                                 gint          n)
+{
+    HildonRangeModel *model = HILDON_RANGE_MODEL (tree_model);
+
+    if (parent != NULL || n < 0 || n > model->max - model->min)
+        return FALSE;
+
+    iter->stamp = model->stamp;
+    iter->user_data = GINT_TO_POINTER (model->min + n);
+
+    return TRUE;
+}
+
+static gboolean
+hildon_range_model_get_iter                     (GtkTreeModel *tree_model,
+                                                 GtkTreeIter  *iter,
+                                                 GtkTreePath  *path)
+{
+    if (gtk_tree_path_get_depth (path) != 1)
+        return FALSE;
+
+    return hildon_range_model_iter_nth_child (tree_model, iter, NULL,
+                                              gtk_tree_path_get_indices (path)[0]);
+}
+
+static GtkTreePath *
+hildon_range_model_get_path                     (GtkTreeModel *tree_model,
+                                                 GtkTreeIter  *iter)
+{
+    HildonRangeModel *model = HILDON_RANGE_MODEL (tree_model);
+
+    g_return_val_if_fail (VALID_ITER (model, iter), NULL);
+
+    return gtk_tree_path_new_from_indices (GPOINTER_TO_INT (iter->user_data) - model->min, -1);
+}
+
+static void
+hildon_range_model_get_value                    (GtkTreeModel *tree_model,
+                                                 GtkTreeIter  *iter,
+                                                 gint          column,
+                                                 GValue       *value)
+{
+    HildonRangeModel *model = HILDON_RANGE_MODEL (tree_model);
+    gint row_value;
+
+    g_return_if_fail (VALID_ITER (model, iter));
+    g_return_if_fail (column >= 0 && column < HILDON_RANGE_MODEL_N_COLUMNS);
+
+    row_value = GPOINTER_TO_INT (iter->user_data);
+
+    if (column == HILDON_RANGE_MODEL_COLUMN_LABEL) {
+        g_value_init (value, G_TYPE_STRING);
+        g_value_set_string (value, label_cache_lookup (model, row_value));
+    } else {
+        g_value_init (value, G_TYPE_INT);
+        g_value_set_int (value, row_value);
+    }
+}
+
+static gboolean
+hildon_range_model_iter_next                    (GtkTreeModel *tree_model,
+                                                 GtkTreeIter  *iter)
+{
+    HildonRangeModel *model = HILDON_RANGE_MODEL (tree_model);
+    gint row_value;
+
+    g_return_val_if_fail (VALID_ITER (model, iter), FALSE);
+
+    row_value = GPOINTER_TO_INT (iter->user_data);
+    if (row_value >= model->max) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    iter->user_data = GINT_TO_POINTER (row_value + 1);
+
+    return TRUE;
+}
+
+static gboolean
+hildon_range_model_iter_previous                (GtkTreeModel *tree_model,
+                                                 GtkTreeIter  *iter)
+{
+    HildonRangeModel *model = HILDON_RANGE_MODEL (tree_model);
+    gint row_value;
+
+    g_return_val_if_fail (VALID_ITER (model, iter), FALSE);
+
+    row_value = GPOINTER_TO_INT (iter->user_data);
+    if (row_value <= model->min) {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    iter->user_data = GINT_TO_POINTER (row_value - 1);
+
+    return TRUE;
+}
+
+static gboolean
+hildon_range_model_iter_children                (GtkTreeModel *tree_model,
+                                                 GtkTreeIter  *iter,
+                                                 GtkTreeIter  *parent)
+{
+    return hildon_range_model_iter_nth_child (tree_model, iter, parent, 0);
+}
+
+static gboolean
+hildon_range_model_iter_has_child               (GtkTreeModel *tree_model,
+                                                 GtkTreeIter  *iter)
+{
+    return FALSE;
+}
+
+static gint
+hildon_range_model_iter_n_children              (GtkTreeModel *tree_model,
+                                                 GtkTreeIter  *iter)
+{
+    HildonRangeModel *model = HILDON_RANGE_MODEL (tree_model);
+
+    if (iter != NULL)
+        return 0;
+
+    return model->max - model->min + 1;
+}
+
+static gboolean
+hildon_range_model_iter_parent                  (GtkTreeModel *tree_model,
+                                                 GtkTreeIter  *iter,
+                                                 GtkTreeIter  *child)
+{
+    return FALSE;
+}
+
+static void
+hildon_range_model_tree_model_init              (GtkTreeModelIface *iface)
+{
+    iface->get_flags       = hildon_range_model_get_flags;
+    iface->get_n_columns   = hildon_range_model_get_n_columns;
+    iface->get_column_type = hildon_range_model_get_column_type;
+    iface->get_iter        = hildon_range_model_get_iter;
+    iface->get_path        = hildon_range_model_get_path;
+    iface->get_value       = hildon_range_model_get_value;
+    iface->iter_next       = hildon_range_model_iter_next;
+    iface->iter_previous   = hildon_range_model_iter_previous;
+    iface->iter_children   = hildon_range_model_iter_children;
+    iface->iter_has_child  = hildon_range_model_iter_has_child;
+    iface->iter_n_children = hildon_range_model_iter_n_children;
+    iface->iter_nth_child  = hildon_range_model_iter_nth_child;
+    iface->iter_parent     = hildon_range_model_iter_parent;
+}
+
+/* Emits the signal for the row of @value, already added to the model */
+static void
+emit_row_inserted                               (HildonRangeModel *model,
+                                                 gint              value)
+{
+    GtkTreeIter iter;
+    GtkTreePath *path;
+
+    iter.stamp = model->stamp;
+    iter.user_data = GINT_TO_POINTER (value);
+    path = gtk_tree_path_new_from_indices (value - model->min, -1);
+    gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, &iter);
+    gtk_tree_path_free (path);
+}
+
+static void
+emit_row_deleted                                (HildonRangeModel *model,
+                                                 gint              position)
+{
+    GtkTreePath *path;
+
+    path = gtk_tree_path_new_from_indices (position, -1);
+    gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
+    gtk_tree_path_free (path);
+}
+
+/**
+ * hildon_range_model_new:
+ * @min: the value of the first row
+ * @max: the value of the last row
+ * @format: a strftime() format for the labels of the rows
+ * @field: the field of a struct tm the values are formatted as
+ *
+ * Creates a list model with a row for each integer between @min and
+ * @max, both included. The %HILDON_RANGE_MODEL_COLUMN_LABEL column
+ * holds the value formatted with @format, and the
+ * %HILDON_RANGE_MODEL_COLUMN_VALUE column the value itself.
+ *
+ * Returns: a new #GtkTreeModel
+ **/
+GtkTreeModel * G_GNUC_INTERNAL
+hildon_range_model_new                          (gint                   min,
+                                                 gint                   max,
+                                                 const gchar           *format,
+                                                 HildonRangeModelField  field)
+{
+    HildonRangeModel *model;
+
+    g_return_val_if_fail (format != NULL, NULL);
+
+    model = g_object_new (HILDON_TYPE_RANGE_MODEL, NULL);
+    model->min = min;
+    model->max = MAX (max, min - 1);
+    model->format = g_strdup (format);
+    model->field = field;
+
+    return GTK_TREE_MODEL (model);
+}
+
+/**
+ * hildon_range_model_set_range:
+ * @model: a #HildonRangeModel
+ * @min: the new value of the first row
+ * @max: the new value of the last row
+ *
+ * Changes the range of values in @model. Only the rows that leave or
+ * enter the range are deleted or inserted, rows whose value is in both
+ * ranges are kept, with their iters.
+ **/
+void G_GNUC_INTERNAL
+hildon_range_model_set_range                    (HildonRangeModel *model,
+                                                 gint              min,
+                                                 gint              max)
+{
+    g_return_if_fail (HILDON_IS_RANGE_MODEL (model));
+
+    max = MAX (max, min - 1);
+
+    /* Drop the rows out of the new range, from the end first */
+    while (model->max >= model->min && model->max > max) {
+        model->max--;
+        emit_row_deleted (model, model->max - model->min + 1);
+    }
+    while (model->max >= model->min && model->min < min) {
+        model->min++;
+        emit_row_deleted (model, 0);
+    }
+
+    /* Disjoint ranges: start again from an empty model */
+    if (model->max < model->min) {
+        model->min = min;
+        model->max = min - 1;
+    }
+
+    while (model->min > min) {
+        model->min--;
+        emit_row_inserted (model, model->min);
+    }
+    while (model->max < max) {
+        model->max++;
+        emit_row_inserted (model, model->max);
+    }
+}
@@ -131,7 +131,10 @@ hildon_time_button_new_step (HildonSizeType          size,
                        "title", _("wdgt_ti_time"),
                        "arrangement", arrangement,
                        "size", size,
-                       "touch-selector", hildon_time_selector_new_step (minutes_step),
+                       "touch-selector", g_object_new (HILDON_TYPE_TIME_SELECTOR,
+                                                       "minutes-step", minutes_step,
+                                                       "lazy-construction", TRUE,
+                                                       NULL),
                        NULL);
 }
 
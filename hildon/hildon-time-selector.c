@@ -50,6 +50,7 @@
 #include "hildon-enum-types.h"
 #include "hildon-time-selector.h"
 #include "hildon-touch-selector-private.h"
+#include "hildon-private.h"
 
 #define HILDON_TIME_SELECTOR_GET_PRIVATE(obj)                           \
   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), HILDON_TYPE_TIME_SELECTOR, HildonTimeSelectorPrivate))
@@ -84,7 +85,8 @@ enum
 {
   PROP_0,
   PROP_MINUTES_STEP,
-  PROP_TIME_FORMAT_POLICY
+  PROP_TIME_FORMAT_POLICY,
+  PROP_LAZY_CONSTRUCTION
 };
 
 struct _HildonTimeSelectorPrivate
@@ -101,6 +103,11 @@ struct _HildonTimeSelectorPrivate
 
   gint creation_hours;
   gint creation_minutes;
+
+  gboolean lazy_construction;
+  gboolean ui_constructed;
+  guint hours;
+  guint minutes;                /* active time until the UI is constructed */
 };
 
 static void hildon_time_selector_finalize (GObject * object);
@@ -115,6 +122,8 @@ static void hildon_time_selector_set_property (GObject *object,
                                                guint param_id,
                                                const GValue *value,
                                                GParamSpec *pspec);
+static void hildon_time_selector_parent_set (GtkWidget *widget,
+                                             GtkWidget *previous_parent);
 
 /* private functions */
 static GtkTreeModel *_create_hours_model (HildonTimeSelector * selector);
@@ -182,7 +191,28 @@ hildon_time_selector_class_init (HildonTimeSelectorClass * class)
                                                       HILDON_TIME_SELECTOR_FORMAT_POLICY_AUTOMATIC,
                                                       G_PARAM_READWRITE|G_PARAM_CONSTRUCT));
 
+  /**
+   * HildonTimeSelector:lazy-construction:
+   *
+   * Whether the columns of the selector are only built when they are
+   * first needed: when the selector is added to a container, usually
+   * the #HildonPickerDialog opened by a #HildonTimeButton, or when
+   * the #HildonTouchSelector API is first used on its columns. Until
+   * then, the time is kept by the #HildonTimeSelector API alone.
+   *
+   * Since: 3.0
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_LAZY_CONSTRUCTION,
+                                   g_param_spec_boolean ("lazy-construction",
+                                                         "Lazy construction",
+                                                         "Whether the columns are only built"
+                                                         " when the selector gets a parent",
+                                                         FALSE,
+                                                         G_PARAM_READWRITE|G_PARAM_CONSTRUCT_ONLY));
+
   /* GtkWidget */
+  widget_class->parent_set = hildon_time_selector_parent_set;
 
   /* GtkContainer */
 
@@ -191,24 +221,12 @@ hildon_time_selector_class_init (HildonTimeSelectorClass * class)
   g_type_class_add_private (class, sizeof (HildonTimeSelectorPrivate));
 }
 
-/* FIXME: the constructor was required because as we need the initial values
-   of the properties passed on g_object_new. But, probably use the method
-   constructed could be easier */
-static GObject*
-hildon_time_selector_constructor (GType type,
-                                  guint n_construct_properties,
-                                  GObjectConstructParam *construct_params)
+static void
+hildon_time_selector_construct_ui (HildonTimeSelector *selector)
 {
-  GObject *object;
-  HildonTimeSelector *selector;
   HildonTouchSelectorColumn *column;
 
-  object = (* G_OBJECT_CLASS (hildon_time_selector_parent_class)->constructor)
-    (type, n_construct_properties, construct_params);
-
-  selector = HILDON_TIME_SELECTOR (object);
-
-  g_object_set (object, "live-search", FALSE, NULL);
+  selector->priv->ui_constructed = TRUE;
 
   selector->priv->hours_model = _create_hours_model (selector);
 
@@ -216,9 +234,6 @@ hildon_time_selector_constructor (GType type,
                                                      selector->priv->hours_model, TRUE);
   hildon_touch_selector_column_set_text_column (column, 0);
 
-  /* we need initialization parameters in order to create minute models*/
-  selector->priv->minutes_step = selector->priv->minutes_step ? selector->priv->minutes_step : 1;
-
   selector->priv->minutes_model = _create_minutes_model (selector->priv->minutes_step);
 
   column = hildon_touch_selector_append_text_column (HILDON_TOUCH_SELECTOR (selector),
@@ -235,7 +250,49 @@ hildon_time_selector_constructor (GType type,
                       "changed", G_CALLBACK (_manage_ampm_selection_cb),
                       NULL);
   }
+}
+
+/* Builds the columns of a lazily constructed selector, once they are
+   needed, with the time stored until then */
+static void
+hildon_time_selector_build_lazy_ui (HildonTouchSelector *touch_selector)
+{
+  HildonTimeSelector *selector = HILDON_TIME_SELECTOR (touch_selector);
+
+  /* The time does not change here, so nobody has to be told */
+  hildon_touch_selector_block_changed (touch_selector);
+  hildon_time_selector_construct_ui (selector);
+  hildon_time_selector_set_time (selector, selector->priv->hours,
+                                 selector->priv->minutes);
+  hildon_touch_selector_unblock_changed (touch_selector);
+}
+
+/* FIXME: the constructor was required because as we need the initial values
+   of the properties passed on g_object_new. But, probably use the method
+   constructed could be easier */
+static GObject*
+hildon_time_selector_constructor (GType type,
+                                  guint n_construct_properties,
+                                  GObjectConstructParam *construct_params)
+{
+  GObject *object;
+  HildonTimeSelector *selector;
+
+  object = (* G_OBJECT_CLASS (hildon_time_selector_parent_class)->constructor)
+    (type, n_construct_properties, construct_params);
+
+  selector = HILDON_TIME_SELECTOR (object);
 
+  g_object_set (object, "live-search", FALSE, NULL);
+
+  /* we need initialization parameters in order to create minute models*/
+  selector->priv->minutes_step = selector->priv->minutes_step ? selector->priv->minutes_step : 1;
+
+  if (selector->priv->lazy_construction)
+    hildon_touch_selector_set_build_func (HILDON_TOUCH_SELECTOR (selector),
+                                          hildon_time_selector_build_lazy_ui);
+  else
+    hildon_time_selector_construct_ui (selector);
 
   /* By default we should select the current day */
   hildon_time_selector_set_time (selector,
@@ -246,6 +303,17 @@ hildon_time_selector_constructor (GType type,
 
 }
 
+static void
+hildon_time_selector_parent_set (GtkWidget *widget,
+                                 GtkWidget *previous_parent)
+{
+  if (GTK_WIDGET_CLASS (hildon_time_selector_parent_class)->parent_set)
+    GTK_WIDGET_CLASS (hildon_time_selector_parent_class)->parent_set (widget, previous_parent);
+
+  if (gtk_widget_get_parent (widget) != NULL)
+    hildon_touch_selector_build_columns (HILDON_TOUCH_SELECTOR (widget));
+}
+
 static void
 hildon_time_selector_init (HildonTimeSelector * selector)
 {
@@ -263,6 +331,9 @@ hildon_time_selector_init (HildonTimeSelector * selector)
 
   _get_real_time (&selector->priv->creation_hours,
                   &selector->priv->creation_minutes);
+
+  selector->priv->lazy_construction = FALSE;
+  selector->priv->ui_constructed = FALSE;
 }
 
 static void
@@ -281,6 +352,9 @@ hildon_time_selector_get_property (GObject *object,
     case PROP_TIME_FORMAT_POLICY:
       g_value_set_enum (value, priv->format_policy);
       break;
+    case PROP_LAZY_CONSTRUCTION:
+      g_value_set_boolean (value, priv->lazy_construction);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
       break;
@@ -304,6 +378,9 @@ hildon_time_selector_set_property (GObject *object,
       update_format_policy (HILDON_TIME_SELECTOR (object),
                             g_value_get_enum (value));
       break;
+    case PROP_LAZY_CONSTRUCTION:
+      priv->lazy_construction = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
       break;
@@ -369,9 +446,12 @@ _custom_print_func (HildonTouchSelector * touch_selector,
   return result;
 }
 
+/* The models of the columns are never modified once built, so they
+   are shared by all the selectors using the same locale and options */
 static GtkTreeModel *
-_create_minutes_model (guint minutes_step)
+_new_minutes_model (gpointer data)
 {
+  guint minutes_step = GPOINTER_TO_UINT (data);
   GtkListStore *store_minutes = NULL;
   gint i = 0;
   static gchar label[255];
@@ -392,8 +472,23 @@ _create_minutes_model (guint minutes_step)
 }
 
 static GtkTreeModel *
-_create_hours_model (HildonTimeSelector * selector)
+_create_minutes_model (guint minutes_step)
 {
+  GtkTreeModel *model;
+  gchar *key;
+
+  key = g_strdup_printf ("time-selector-minutes:%u", minutes_step);
+  model = hildon_private_get_shared_model (key, _new_minutes_model,
+                                           GUINT_TO_POINTER (minutes_step));
+  g_free (key);
+
+  return model;
+}
+
+static GtkTreeModel *
+_new_hours_model (gpointer data)
+{
+  gboolean ampm_format = GPOINTER_TO_INT (data);
   GtkListStore *store_hours = NULL;
   gint i = 0;
   GtkTreeIter iter;
@@ -406,7 +501,7 @@ _create_hours_model (HildonTimeSelector * selector)
   gint num_elements = 0;
   gchar *format_string = NULL;
 
-  if (selector->priv->ampm_format) {
+  if (ampm_format) {
     range = range_12h;
     num_elements = 12;
     format_string = N_("wdgt_va_12h_hours");
@@ -430,7 +525,19 @@ _create_hours_model (HildonTimeSelector * selector)
 }
 
 static GtkTreeModel *
-_create_ampm_model (HildonTimeSelector * selector)
+_create_hours_model (HildonTimeSelector * selector)
+{
+  gboolean ampm_format = selector->priv->ampm_format;
+
+  return hildon_private_get_shared_model (ampm_format ?
+                                          "time-selector-hours-12h" :
+                                          "time-selector-hours-24h",
+                                          _new_hours_model,
+                                          GINT_TO_POINTER (ampm_format));
+}
+
+static GtkTreeModel *
+_new_ampm_model (gpointer data)
 {
   GtkListStore *store_ampm = NULL;
   GtkTreeIter iter;
@@ -453,6 +560,13 @@ _create_ampm_model (HildonTimeSelector * selector)
   return GTK_TREE_MODEL (store_ampm);
 }
 
+static GtkTreeModel *
+_create_ampm_model (HildonTimeSelector * selector)
+{
+  return hildon_private_get_shared_model ("time-selector-ampm",
+                                          _new_ampm_model, NULL);
+}
+
 static void
 _get_real_time (gint * hours, gint * minutes)
 {
@@ -534,7 +648,10 @@ update_format_policy                            (HildonTimeSelector *selector,
   gboolean prev_ampm_format = FALSE;
   gint num_columns = -1;
 
-  num_columns = hildon_touch_selector_get_num_columns (HILDON_TOUCH_SELECTOR (selector));
+  /* A lazily constructed selector builds its columns with the new
+     format later on, there is nothing to update yet */
+  if (selector->priv->ui_constructed)
+    num_columns = hildon_touch_selector_get_num_columns (HILDON_TOUCH_SELECTOR (selector));
   prev_ampm_format = selector->priv->ampm_format;
 
   if (new_policy != selector->priv->format_policy) {
@@ -677,6 +794,31 @@ hildon_time_selector_set_time (HildonTimeSelector * selector,
   g_return_val_if_fail (hours <= 23, FALSE);
   g_return_val_if_fail (minutes <= 59, FALSE);
 
+  if (!selector->priv->ui_constructed) {
+    gboolean hours_changed, minutes_changed;
+
+    minutes -= minutes % selector->priv->minutes_step;
+    hours_changed = (hours != selector->priv->hours);
+    minutes_changed = (minutes != selector->priv->minutes);
+
+    selector->priv->pm = hours >= 12;
+    selector->priv->hours = hours;
+    selector->priv->minutes = minutes;
+
+    /* Same emissions the columns would do, so that a
+       HildonPickerButton updates its value. A handler using the
+       column builds the columns first, see
+       hildon_touch_selector_set_build_func() */
+    if (hours_changed)
+      hildon_touch_selector_emit_value_changed (HILDON_TOUCH_SELECTOR (selector),
+                                                COLUMN_HOURS);
+    if (minutes_changed)
+      hildon_touch_selector_emit_value_changed (HILDON_TOUCH_SELECTOR (selector),
+                                                COLUMN_MINUTES);
+
+    return TRUE;
+  }
+
   _set_pm (selector, hours >= 12);
 
   if (selector->priv->ampm_format) {
@@ -721,6 +863,14 @@ hildon_time_selector_get_time (HildonTimeSelector * selector,
 
   g_return_if_fail (HILDON_IS_TIME_SELECTOR (selector));
 
+  if (!selector->priv->ui_constructed) {
+    if (hours != NULL)
+      *hours = selector->priv->hours;
+    if (minutes != NULL)
+      *minutes = selector->priv->minutes;
+    return;
+  }
+
   if (hours != NULL) {
     if (hildon_touch_selector_get_selected (HILDON_TOUCH_SELECTOR (selector),
                                             COLUMN_HOURS, &iter)) {
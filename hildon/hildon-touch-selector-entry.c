@@ -47,6 +47,7 @@
 #include "hildon-touch-selector.h"
 #include "hildon-touch-selector-entry.h"
 #include "hildon-entry.h"
+#include "hildon-helper.h"
 
 #include <string.h>
 
@@ -69,13 +70,30 @@ static void
 _text_column_modified (GObject *pspec, GParamSpec *gobject, gpointer data);
 
 
+typedef struct _HildonTouchSelectorEntryKey HildonTouchSelectorEntryKey;
+
 struct _HildonTouchSelectorEntryPrivate {
   gulong signal_id;
   GtkWidget *entry;
-  GIConv converter;
   gboolean smart_match;
+
+  GtkTreeModel *index_model;
+  HildonTouchSelectorEntryKey *keys;  /* model order */
+  gint *by_text;                      /* row numbers sorted by text */
+  gint *by_folded;                    /* row numbers sorted by folded text */
+  gint *text_first;                   /* lowest row of ranges of by_text */
+  gint *folded_first;                 /* lowest row of ranges of by_folded */
+  gint n_keys;
+  gint n_sorted;
+  gint index_text_column;
+  gboolean index_smart_match;
+  gboolean index_valid;
 };
 
+static void index_set_model (HildonTouchSelectorEntryPrivate *priv,
+                             GtkTreeModel *model,
+                             HildonTouchSelectorEntry *selector);
+
 enum {
   PROP_TEXT_COLUMN = 1,
   PROP_SMART_MATCH
@@ -144,7 +162,7 @@ hildon_touch_selector_entry_finalize (GObject *object)
 {
   HildonTouchSelectorEntryPrivate *priv;
   priv = HILDON_TOUCH_SELECTOR_ENTRY_GET_PRIVATE (object);
-  g_iconv_close (priv->converter);
+  index_set_model (priv, NULL, HILDON_TOUCH_SELECTOR_ENTRY (object));
   G_OBJECT_CLASS (hildon_touch_selector_entry_parent_class)->finalize (object);
 }
 
@@ -160,9 +178,9 @@ hildon_touch_selector_entry_class_init (HildonTouchSelectorEntryClass *klass)
   selector_class->has_multiple_selection = hildon_touch_selector_entry_has_multiple_selection;
 
   object_class->constructor  = hildon_touch_selector_entry_constructor;
+  object_class->finalize     = hildon_touch_selector_entry_finalize;
   object_class->get_property = hildon_touch_selector_entry_get_property;
   object_class->set_property = hildon_touch_selector_entry_set_property;
-  object_class->finalize     = hildon_touch_selector_entry_finalize;
 
   /**
    * HildonTouchSelectorEntry:text-column:
@@ -244,8 +262,6 @@ hildon_touch_selector_entry_init (HildonTouchSelectorEntry *self)
 
   priv = HILDON_TOUCH_SELECTOR_ENTRY_GET_PRIVATE (self);
 
-  priv->converter = g_iconv_open ("ascii//translit", "utf-8");
-
   priv->entry = hildon_entry_new (HILDON_SIZE_FINGER_HEIGHT);
   gtk_entry_set_activates_default (GTK_ENTRY (priv->entry), TRUE);
  
@@ -456,6 +472,243 @@ hildon_touch_selector_entry_get_input_mode (HildonTouchSelectorEntry * selector)
   return hildon_gtk_entry_get_input_mode (GTK_ENTRY (priv->entry));
 }
 
+/* Rows of the model, kept sorted by their text and by their text
+ * stripped of case and accentuation marks, so that the exact and the
+ * smart matches of the entry text are both binary searches. The index
+ * is built the first time it is needed and dropped on any change in
+ * the model. */
+
+struct _HildonTouchSelectorEntryKey {
+  gchar *text;
+  gchar *folded;
+};
+
+static gchar *
+fold_text (const gchar *text)
+{
+  gunichar *stripped;
+  gchar *folded;
+
+  if (text == NULL || text[0] == '\0')
+    return g_strdup ("");
+
+  stripped = hildon_helper_strip_string (text);
+  folded = g_ucs4_to_utf8 (stripped, -1, NULL, NULL, NULL);
+  g_free (stripped);
+
+  return folded ? folded : g_strdup ("");
+}
+
+static void
+index_clear (HildonTouchSelectorEntryPrivate *priv)
+{
+  gint i;
+
+  for (i = 0; i < priv->n_keys; i++) {
+    g_free (priv->keys[i].text);
+    g_free (priv->keys[i].folded);
+  }
+
+  g_free (priv->keys);
+  g_free (priv->by_text);
+  g_free (priv->by_folded);
+  g_free (priv->text_first);
+  g_free (priv->folded_first);
+  priv->keys = NULL;
+  priv->by_text = NULL;
+  priv->by_folded = NULL;
+  priv->text_first = NULL;
+  priv->folded_first = NULL;
+  priv->n_keys = 0;
+  priv->n_sorted = 0;
+  priv->index_valid = FALSE;
+}
+
+static void
+index_invalidate (HildonTouchSelectorEntry *selector)
+{
+  index_clear (HILDON_TOUCH_SELECTOR_ENTRY_GET_PRIVATE (selector));
+}
+
+static void
+index_set_model (HildonTouchSelectorEntryPrivate *priv,
+                 GtkTreeModel *model,
+                 HildonTouchSelectorEntry *selector)
+{
+  if (priv->index_model == model)
+    return;
+
+  index_clear (priv);
+
+  if (priv->index_model) {
+    g_signal_handlers_disconnect_by_func (priv->index_model,
+                                          index_invalidate, selector);
+    g_object_unref (priv->index_model);
+  }
+
+  priv->index_model = model ? g_object_ref (model) : NULL;
+
+  if (model) {
+    g_signal_connect_swapped (model, "row-inserted",
+                              G_CALLBACK (index_invalidate), selector);
+    g_signal_connect_swapped (model, "row-changed",
+                              G_CALLBACK (index_invalidate), selector);
+    g_signal_connect_swapped (model, "row-deleted",
+                              G_CALLBACK (index_invalidate), selector);
+    g_signal_connect_swapped (model, "rows-reordered",
+                              G_CALLBACK (index_invalidate), selector);
+  }
+}
+
+static gint
+compare_by_text (gconstpointer a, gconstpointer b, gpointer data)
+{
+  HildonTouchSelectorEntryKey *keys = data;
+  gint row1 = *(const gint *) a;
+  gint row2 = *(const gint *) b;
+  gint cmp = strcmp (keys[row1].text, keys[row2].text);
+
+  return cmp ? cmp : row1 - row2;
+}
+
+static gint
+compare_by_folded (gconstpointer a, gconstpointer b, gpointer data)
+{
+  HildonTouchSelectorEntryKey *keys = data;
+  gint row1 = *(const gint *) a;
+  gint row2 = *(const gint *) b;
+  gint cmp = strcmp (keys[row1].folded, keys[row2].folded);
+
+  return cmp ? cmp : row1 - row2;
+}
+
+/* The rows starting with a prefix are a range of the sorted array, but
+ * the lowest row of the range can be anywhere in it, since only the
+ * rows with the very same text are sorted by row. The lowest row of
+ * any range is found in O(log n) with a tree of minimums: the leaves
+ * n to 2n - 1 are the sorted rows, and node i holds the minimum of
+ * nodes 2i and 2i + 1. */
+static gint *
+index_build_first (const gint *sorted,
+                   gint n)
+{
+  gint *tree = g_new (gint, 2 * MAX (n, 1));
+  gint i;
+
+  memcpy (tree + n, sorted, n * sizeof (gint));
+  for (i = n - 1; i > 0; i--)
+    tree[i] = MIN (tree[2 * i], tree[2 * i + 1]);
+
+  return tree;
+}
+
+static gint
+index_range_first (const gint *tree,
+                   gint n,
+                   gint lo,
+                   gint hi)
+{
+  gint first = G_MAXINT;
+
+  for (lo += n, hi += n; lo < hi; lo /= 2, hi /= 2) {
+    if (lo & 1)
+      first = MIN (first, tree[lo++]);
+    if (hi & 1)
+      first = MIN (first, tree[--hi]);
+  }
+
+  return (first == G_MAXINT) ? -1 : first;
+}
+
+static void
+index_build (HildonTouchSelectorEntryPrivate *priv,
+             GtkTreeModel *model,
+             gint text_column)
+{
+  GtkTreeIter iter;
+  gint n_rows, row;
+
+  index_clear (priv);
+
+  n_rows = gtk_tree_model_iter_n_children (model, NULL);
+  priv->keys = g_new0 (HildonTouchSelectorEntryKey, n_rows);
+  priv->by_text = g_new (gint, n_rows);
+  priv->by_folded = g_new (gint, n_rows);
+
+  row = 0;
+  if (gtk_tree_model_get_iter_first (model, &iter)) {
+    do {
+      gchar *text;
+
+      gtk_tree_model_get (model, &iter, text_column, &text, -1);
+
+      /* Rows without text never match */
+      if (text != NULL) {
+        priv->keys[row].text = text;
+        priv->keys[row].folded = priv->smart_match ? fold_text (text) : NULL;
+        priv->by_text[priv->n_sorted] = row;
+        priv->by_folded[priv->n_sorted] = row;
+        priv->n_sorted++;
+      }
+      row++;
+    } while (row < n_rows && gtk_tree_model_iter_next (model, &iter));
+  }
+  priv->n_keys = row;
+
+  g_qsort_with_data (priv->by_text, priv->n_sorted, sizeof (gint),
+                     compare_by_text, priv->keys);
+  priv->text_first = index_build_first (priv->by_text, priv->n_sorted);
+  if (priv->smart_match) {
+    g_qsort_with_data (priv->by_folded, priv->n_sorted, sizeof (gint),
+                       compare_by_folded, priv->keys);
+    priv->folded_first = index_build_first (priv->by_folded, priv->n_sorted);
+  }
+
+  priv->index_text_column = text_column;
+  priv->index_smart_match = priv->smart_match;
+  priv->index_valid = TRUE;
+}
+
+/* Returns the first row, in model order, whose text (or folded text)
+ * starts with @prefix, or -1. The rows sharing a prefix are contiguous
+ * in the sorted array, and are found with two binary searches; the
+ * lowest of them comes from the tree of minimums. */
+static gint
+index_find_first (HildonTouchSelectorEntryPrivate *priv,
+                  gboolean folded,
+                  const gchar *prefix)
+{
+  const gint *sorted = folded ? priv->by_folded : priv->by_text;
+  gsize len = strlen (prefix);
+  gint lo = 0, hi = priv->n_sorted;
+  gint start;
+
+  while (lo < hi) {
+    gint mid = lo + (hi - lo) / 2;
+    HildonTouchSelectorEntryKey *key = &priv->keys[sorted[mid]];
+
+    if (strncmp (folded ? key->folded : key->text, prefix, len) < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  start = lo;
+
+  hi = priv->n_sorted;
+  while (lo < hi) {
+    gint mid = lo + (hi - lo) / 2;
+    HildonTouchSelectorEntryKey *key = &priv->keys[sorted[mid]];
+
+    if (strncmp (folded ? key->folded : key->text, prefix, len) <= 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return index_range_first (folded ? priv->folded_first : priv->text_first,
+                            priv->n_sorted, start, lo);
+}
+
 static void
 entry_on_text_changed (GtkEditable * editable,
                        gpointer userdata)
@@ -464,15 +717,10 @@ entry_on_text_changed (GtkEditable * editable,
   HildonTouchSelectorEntryPrivate *priv;
   GtkTreeModel *model;
   GtkTreeIter iter;
-  GtkTreeIter iter_suggested;
   GtkEntry *entry;
   const gchar *prefix;
-  gchar *text;
-  gboolean found = FALSE;
   gint text_column = -1;
-  gchar *ascii_prefix;
-  gint prefix_len;
-  gboolean found_suggestion = FALSE;
+  gint row;
 
   entry = GTK_ENTRY (editable);
   selector = HILDON_TOUCH_SELECTOR (userdata);
@@ -489,48 +737,42 @@ entry_on_text_changed (GtkEditable * editable,
 
   model = hildon_touch_selector_get_model (selector, 0);
 
-  if (!gtk_tree_model_get_iter_first (model, &iter)) {
+  if (model == NULL || text_column == -1) {
     return;
   }
 
-  if (priv->smart_match) {
-    ascii_prefix = g_convert_with_iconv (prefix, -1, priv->converter, NULL, NULL, NULL);
-    prefix_len = strlen (ascii_prefix);
+  index_set_model (priv, model, HILDON_TOUCH_SELECTOR_ENTRY (selector));
+  if (!priv->index_valid ||
+      priv->index_text_column != text_column ||
+      priv->index_smart_match != priv->smart_match) {
+    index_build (priv, model, text_column);
   }
 
-  do {
-    gtk_tree_model_get (model, &iter, text_column, &text, -1);
-    found = g_str_has_prefix (text, prefix);
-
-    if (!found && !found_suggestion && priv->smart_match) {
-      gchar *ascii_text = g_convert_with_iconv (text, -1, priv->converter, NULL, NULL, NULL);
-      found_suggestion = !g_ascii_strncasecmp (ascii_text, ascii_prefix, prefix_len);
-      if (found_suggestion) {
-        iter_suggested = iter;
-      }
-      g_free (ascii_text);
-    }
+  if (priv->n_keys == 0) {
+    return;
+  }
 
-    g_free (text);
-  } while (found != TRUE && gtk_tree_model_iter_next (model, &iter));
+  /* An exact match wins over a suggestion, which ignores case and
+     accentuation marks */
+  row = index_find_first (priv, FALSE, prefix);
+  if (row == -1 && priv->smart_match) {
+    gchar *folded = fold_text (prefix);
+    row = index_find_first (priv, TRUE, folded);
+    g_free (folded);
+  }
 
   g_signal_handler_block (selector, priv->signal_id);
   {
     /* We emit the HildonTouchSelector::changed signal because a change in the
        GtkEntry represents a change in current selection, and therefore, users
        should be notified. */
-    if (found) {
+    if (row != -1 &&
+        gtk_tree_model_iter_nth_child (model, &iter, NULL, row)) {
       hildon_touch_selector_select_iter (selector, 0, &iter, TRUE);
-    } else if (found_suggestion) {
-      hildon_touch_selector_select_iter (selector, 0, &iter_suggested, TRUE);
     }
     g_signal_emit_by_name (selector, "changed", 0);
   }
   g_signal_handler_unblock (selector, priv->signal_id);
-
-  if (priv->smart_match) {
-    g_free (ascii_prefix);
-  }
 }
 
 /* FIXME: This is actually a very ugly way to retrieve the text. Ideally,
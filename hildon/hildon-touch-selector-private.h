@@ -31,6 +31,19 @@ hildon_touch_selector_block_changed             (HildonTouchSelector *selector);
 void G_GNUC_INTERNAL
 hildon_touch_selector_unblock_changed           (HildonTouchSelector *selector);
 
+typedef void (*HildonTouchSelectorBuildFunc)    (HildonTouchSelector *selector);
+
+void G_GNUC_INTERNAL
+hildon_touch_selector_set_build_func            (HildonTouchSelector          *selector,
+                                                 HildonTouchSelectorBuildFunc  func);
+
+void G_GNUC_INTERNAL
+hildon_touch_selector_build_columns             (HildonTouchSelector *selector);
+
+void G_GNUC_INTERNAL
+hildon_touch_selector_emit_value_changed        (HildonTouchSelector *selector,
+                                                 gint                 column);
+
 G_END_DECLS
 
 #endif
@@ -205,29 +205,41 @@ struct _HildonTouchSelectorColumnPrivate
   GtkTreeView *tree_view;
   gulong realize_handler;
   GtkTreePath *initial_path;
-  GtkTreeModel *filter;
+  GtkTreeModel *filter;         /* only set while the column has a live search */
   GtkWidget *livesearch;
 
   GtkWidget *panarea;           /* the pannable widget */
   GtkWidget *vbox;
   GtkTreeRowReference *last_activated;
+  gint index;                   /* position in the parent's columns array */
+
+  gint estimated_rows;          /* row count of the cached height estimate */
+  gint estimated_height;
 };
 
 struct _HildonTouchSelectorPrivate
 {
-  GSList *columns;              /* the selection columns */
+  GPtrArray *columns;           /* the selection columns, owning a ref */
+  GHashTable *model_columns;    /* GtkTreeModel -> GPtrArray of the columns
+                                   showing it */
   GtkWidget *hbox;              /* the container for the selector's columns */
   gboolean initial_scroll;      /* whether initial fancy scrolling to selection */
   gboolean has_live_search;
-  GSList *norm_tokens;
+  HildonMatcher *matcher;       /* the live search text, prepared for matching */
 
   gboolean changed_blocked;
+  gint update_depth;            /* nesting of begin_update()/end_update() */
+  GArray *pending_changes;      /* columns changed during an update */
 
   HildonTouchSelectorPrintFunc print_func;
   gpointer print_user_data;
   GDestroyNotify print_destroy_func;
+  gint max_printed_items;       /* -1 to print every selected item */
 
   HildonUIMode hildon_ui_mode;
+
+  HildonTouchSelectorBuildFunc build_func; /* builds the columns of a
+                                              lazily constructed subclass */
 };
 
 enum
@@ -235,7 +247,8 @@ enum
   PROP_HAS_MULTIPLE_SELECTION = 1,
   PROP_INITIAL_SCROLL,
   PROP_HILDON_UI_MODE,
-  PROP_LIVE_SEARCH
+  PROP_LIVE_SEARCH,
+  PROP_MAX_PRINTED_ITEMS
 };
 
 enum
@@ -250,6 +263,9 @@ static gint hildon_touch_selector_signals[LAST_SIGNAL] = { 0 };
 static void
 hildon_touch_selector_dispose                   (GObject * object);
 
+static void
+hildon_touch_selector_finalize                  (GObject * object);
+
 static void
 hildon_touch_selector_get_property              (GObject * object,
                                                  guint prop_id,
@@ -310,10 +326,6 @@ _hildon_touch_selector_set_model                (HildonTouchSelector * selector,
 static gboolean
 _hildon_touch_selector_has_multiple_selection   (HildonTouchSelector * selector);
 
-static void
-hildon_touch_selector_emit_value_changed        (HildonTouchSelector *selector,
-                                                 gint column);
-
 /* GtkCellLayout implementation (HildonTouchSelectorColumn)*/
 static void hildon_touch_selector_column_cell_layout_init         (GtkCellLayoutIface      *iface);
 
@@ -356,6 +368,7 @@ hildon_touch_selector_class_init (HildonTouchSelectorClass * class)
 
   /* GObject */
   gobject_class->dispose = hildon_touch_selector_dispose;
+  gobject_class->finalize = hildon_touch_selector_finalize;
   gobject_class->get_property = hildon_touch_selector_get_property;
   gobject_class->set_property = hildon_touch_selector_set_property;
 
@@ -467,6 +480,26 @@ hildon_touch_selector_class_init (HildonTouchSelectorClass * class)
                                                          TRUE,
                                                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT));
 
+  /**
+   * HildonTouchSelector:max-printed-items:
+   *
+   * The maximum number of selected items that the default print
+   * function lists in %HILDON_TOUCH_SELECTOR_SELECTION_MODE_MULTIPLE.
+   * Past this number, it prints the number of selected items instead
+   * of their text. A value of -1 means no limit.
+   *
+   * Since: 3.0
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_MAX_PRINTED_ITEMS,
+                                   g_param_spec_int ("max-printed-items",
+                                                     "Maximum printed items",
+                                                     "Maximum number of selected items "
+                                                     "listed by the default print function, "
+                                                     "or -1 for no limit",
+                                                     -1, G_MAXINT, -1,
+                                                     G_PARAM_READWRITE));
+
   /* style properties */
   /* We need to ensure fremantle mode for the treeview in order to work
      properly. This is not about the appearance, this is about behaviour */
@@ -500,6 +533,9 @@ hildon_touch_selector_get_property (GObject * object,
     g_value_set_boolean (value,
                          hildon_touch_selector_get_live_search (HILDON_TOUCH_SELECTOR (object)));
     break;
+  case PROP_MAX_PRINTED_ITEMS:
+    g_value_set_int (value, priv->max_printed_items);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     break;
@@ -524,6 +560,10 @@ hildon_touch_selector_set_property (GObject *object, guint prop_id,
     hildon_touch_selector_set_live_search (HILDON_TOUCH_SELECTOR (object),
                                            g_value_get_boolean (value));
     break;
+  case PROP_MAX_PRINTED_ITEMS:
+    hildon_touch_selector_set_max_printed_items (HILDON_TOUCH_SELECTOR (object),
+                                                 g_value_get_int (value));
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     break;
@@ -539,9 +579,12 @@ hildon_touch_selector_init (HildonTouchSelector * selector)
   gtk_widget_set_has_window (GTK_WIDGET (selector), FALSE);
   gtk_widget_set_redraw_on_allocate (GTK_WIDGET (selector), FALSE);
 
-  selector->priv->columns = NULL;
+  selector->priv->columns = g_ptr_array_new_with_free_func (g_object_unref);
+  selector->priv->model_columns =
+    g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                           NULL, (GDestroyNotify) g_ptr_array_unref);
 
-  selector->priv->norm_tokens = NULL;
+  selector->priv->matcher = NULL;
   selector->priv->print_func = NULL;
   selector->priv->print_user_data = NULL;
   selector->priv->print_destroy_func = NULL;
@@ -549,8 +592,12 @@ hildon_touch_selector_init (HildonTouchSelector * selector)
   selector->priv->hbox = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
 
   selector->priv->changed_blocked = FALSE;
+  selector->priv->update_depth = 0;
+  selector->priv->pending_changes = NULL;
+  selector->priv->max_printed_items = -1;
 
   selector->priv->hildon_ui_mode = HILDON_UI_MODE_EDIT;
+  selector->priv->build_func = NULL;
 
   gtk_box_pack_end (GTK_BOX (selector), selector->priv->hbox,
                     TRUE, TRUE, 0);
@@ -566,10 +613,15 @@ hildon_touch_selector_dispose (GObject * object)
   hildon_touch_selector_set_print_func_full (selector,
                                              NULL, NULL, NULL);
 
-  if (selector->priv->norm_tokens != NULL) {
-      g_slist_foreach (selector->priv->norm_tokens, (GFunc) g_free, NULL);
-      g_slist_free (selector->priv->norm_tokens);
-      selector->priv->norm_tokens = NULL;
+  if (selector->priv->matcher != NULL) {
+      hildon_matcher_unref (selector->priv->matcher);
+      selector->priv->matcher = NULL;
+  }
+
+  if (selector->priv->pending_changes != NULL) {
+      g_array_free (selector->priv->pending_changes, TRUE);
+      selector->priv->pending_changes = NULL;
+      selector->priv->update_depth = 0;
   }
 
   gobject_class = G_OBJECT_CLASS (hildon_touch_selector_parent_class);
@@ -578,14 +630,64 @@ hildon_touch_selector_dispose (GObject * object)
     (* gobject_class->dispose) (object);
 }
 
+static void
+hildon_touch_selector_finalize                  (GObject * object)
+{
+  HildonTouchSelector *selector = HILDON_TOUCH_SELECTOR (object);
+
+  g_ptr_array_unref (selector->priv->columns);
+  g_hash_table_destroy (selector->priv->model_columns);
+
+  G_OBJECT_CLASS (hildon_touch_selector_parent_class)->finalize (object);
+}
+
+/* Row signals are connected once per model, and dispatched only to
+   the columns that show that model */
+static void
+model_columns_add                               (HildonTouchSelector *selector,
+                                                 HildonTouchSelectorColumn *col)
+{
+  GPtrArray *columns;
+
+  columns = g_hash_table_lookup (selector->priv->model_columns, col->priv->model);
+  if (columns == NULL) {
+    columns = g_ptr_array_new ();
+    g_hash_table_insert (selector->priv->model_columns, col->priv->model, columns);
+
+    g_signal_connect (col->priv->model, "row-changed",
+                      G_CALLBACK (on_row_changed), selector);
+    g_signal_connect_after (col->priv->model, "row-deleted",
+                            G_CALLBACK (on_row_deleted), selector);
+  }
+
+  g_ptr_array_add (columns, col);
+}
+
+static void
+model_columns_remove                            (HildonTouchSelector *selector,
+                                                 HildonTouchSelectorColumn *col)
+{
+  GPtrArray *columns;
+
+  columns = g_hash_table_lookup (selector->priv->model_columns, col->priv->model);
+  if (columns == NULL)
+    return;
+
+  g_ptr_array_remove (columns, col);
+  if (columns->len == 0) {
+    g_signal_handlers_disconnect_by_func (col->priv->model,
+                                          on_row_changed, selector);
+    g_signal_handlers_disconnect_by_func (col->priv->model,
+                                          on_row_deleted, selector);
+    g_hash_table_remove (selector->priv->model_columns, col->priv->model);
+  }
+}
+
 static void
 clean_column                                    (HildonTouchSelectorColumn *col,
                                                  HildonTouchSelector *selector)
 {
-  g_signal_handlers_disconnect_by_func (col->priv->model,
-                                        on_row_changed, selector);
-  g_signal_handlers_disconnect_by_func (col->priv->model,
-                                        on_row_deleted, selector);
+  model_columns_remove (selector, col);
 
   if (col->priv->last_activated != NULL) {
     gtk_tree_row_reference_free (col->priv->last_activated);
@@ -625,12 +727,8 @@ hildon_touch_selector_remove (GtkContainer * container, GtkWidget * widget)
 
   /* Remove the extra data related to the columns, if required. */
   if (widget == selector->priv->hbox) {
-    g_slist_foreach (selector->priv->columns, (GFunc) clean_column, selector);
-    g_slist_foreach (selector->priv->columns, (GFunc) g_object_unref, NULL);
-
-    g_slist_free (selector->priv->columns);
-
-    selector->priv->columns = NULL;
+    g_ptr_array_foreach (selector->priv->columns, (GFunc) clean_column, selector);
+    g_ptr_array_set_size (selector->priv->columns, 0);
   }
 
   /* Now remove the widget itself from the container */
@@ -650,7 +748,32 @@ hildon_touch_selector_unblock_changed           (HildonTouchSelector *selector)
   selector->priv->changed_blocked = FALSE;
 }
 
-static void
+/* Subclasses that build their columns lazily register the function
+   doing it here. It is run once, on the first call to the API that
+   needs the columns, so that the selector looks fully built to
+   anybody using it as a HildonTouchSelector */
+void
+hildon_touch_selector_set_build_func            (HildonTouchSelector          *selector,
+                                                 HildonTouchSelectorBuildFunc  func)
+{
+  selector->priv->build_func = func;
+}
+
+void
+hildon_touch_selector_build_columns             (HildonTouchSelector *selector)
+{
+  HildonTouchSelectorBuildFunc func = selector->priv->build_func;
+
+  if (func != NULL) {
+    selector->priv->build_func = NULL;
+    func (selector);
+  }
+}
+
+/* Every emission of HildonTouchSelector::changed goes through here,
+   including the ones of subclasses with lazily built columns, so that
+   they are blocked and coalesced the same way */
+void
 hildon_touch_selector_emit_value_changed        (HildonTouchSelector *selector,
                                                  gint column)
 {
@@ -658,11 +781,21 @@ hildon_touch_selector_emit_value_changed        (HildonTouchSelector *selector,
      selected, as now it is required to connect to the signal and then ask
      for the element selected. We can't do this API change, in order to avoid
      and ABI break */
-  if (!selector->priv->changed_blocked) {
+  if (!selector->priv->changed_blocked && selector->priv->update_depth > 0) {
+    GArray *pending = selector->priv->pending_changes;
+    guint i;
+
+    /* Coalesced until hildon_touch_selector_end_update() */
+    for (i = 0; i < pending->len; i++) {
+      if (g_array_index (pending, gint, i) == column)
+        return;
+    }
+    g_array_append_val (pending, column);
+  } else if (!selector->priv->changed_blocked) {
     if (hildon_touch_selector_get_column_selection_mode (selector) == HILDON_TOUCH_SELECTOR_SELECTION_MODE_SINGLE &&
-        selector->priv->columns) {
+        selector->priv->columns->len > 0) {
       HildonTouchSelectorColumn *col;
-      col = (HildonTouchSelectorColumn *) selector->priv->columns->data;
+      col = g_ptr_array_index (selector->priv->columns, 0);
       if (col->priv->livesearch) {
         hildon_live_search_clean_selection_map (HILDON_LIVE_SEARCH (col->priv->livesearch));
       }
@@ -681,6 +814,35 @@ hildon_touch_selector_check_ui_mode_coherence   (HildonTouchSelector *selector)
   }
 }
 
+typedef struct
+{
+  GString *str;
+  gint text_column;
+  gboolean first;
+} PrintRowsData;
+
+static void
+print_selected_row (GtkTreeModel *model,
+                    GtkTreePath  *path,
+                    GtkTreeIter  *iter,
+                    gpointer      data)
+{
+  PrintRowsData *print_data = data;
+  gchar *current_string = NULL;
+
+  if (!print_data->first)
+    g_string_append_c (print_data->str, ',');
+  print_data->first = FALSE;
+
+  if (print_data->text_column != -1) {
+    gtk_tree_model_get (model, iter, print_data->text_column, &current_string, -1);
+    if (current_string) {
+      g_string_append (print_data->str, current_string);
+      g_free (current_string);
+    }
+  }
+}
+
 /**
  * default_print_func:
  * @selector: a #HildonTouchSelector
@@ -694,67 +856,59 @@ hildon_touch_selector_check_ui_mode_coherence   (HildonTouchSelector *selector)
 static gchar *
 _default_print_func (HildonTouchSelector * selector, gpointer user_data)
 {
-  gchar *result = NULL;
-  gchar *aux = NULL;
+  GString *result;
+  gboolean has_value = FALSE;
   gint num_columns = 0;
   GtkTreeIter iter;
   GtkTreeModel *model = NULL;
   gchar *current_string = NULL;
   gint i;
   HildonTouchSelectorSelectionMode mode;
-  GList *item = NULL;
-  GtkTreePath *current_path = NULL;
-  GList *selected_rows = NULL;
   gint initial_value = 0;
   gint text_column = -1;
   HildonTouchSelectorColumn *column = NULL;
 
+  result = g_string_new (NULL);
+
   num_columns = hildon_touch_selector_get_num_columns (selector);
 
   mode = hildon_touch_selector_get_column_selection_mode (selector);
 
   if ((mode == HILDON_TOUCH_SELECTOR_SELECTION_MODE_MULTIPLE)
       && (num_columns > 0)) {
+    GtkTreeSelection *selection;
+    gint max_items = selector->priv->max_printed_items;
+    gint n_selected = -1;
+
     /* In this case we get the first column first */
-    selected_rows = hildon_touch_selector_get_selected_rows (selector, 0);
-    model = hildon_touch_selector_get_model (selector, 0);
     column = hildon_touch_selector_get_column (selector, 0);
-    text_column = hildon_touch_selector_column_get_text_column (column);
-
-    result = g_strdup_printf ("(");
-    i = 0;
-    for (item = selected_rows; item; item = g_list_next (item)) {
-      current_path = item->data;
-      gtk_tree_model_get_iter (model, &iter, current_path);
-
-      if (text_column != -1) {
-        gtk_tree_model_get (model, &iter, text_column, &current_string, -1);
-      }
+    selection = gtk_tree_view_get_selection (column->priv->tree_view);
+
+    if (max_items >= 0)
+      n_selected = gtk_tree_selection_count_selected_rows (selection);
+
+    if (n_selected > max_items) {
+      g_string_append_printf (result,
+                              g_dngettext ("hildon-libs",
+                                           "%d item selected",
+                                           "%d items selected",
+                                           n_selected),
+                              n_selected);
+    } else {
+      PrintRowsData print_data;
 
-      if (i < g_list_length (selected_rows) - 1) {
-        aux = g_strconcat (result, current_string, ",", NULL);
-        g_free (result);
-        result = aux;
-      } else {
-        aux = g_strconcat (result, current_string, NULL);
-        g_free (result);
-        result = aux;
-      }
+      /* Walk the selection with iters: no path lookups, and a
+         single growing buffer for the whole list */
+      print_data.str = result;
+      print_data.text_column = hildon_touch_selector_column_get_text_column (column);
+      print_data.first = TRUE;
 
-      if (current_string) {
-        g_free (current_string);
-        current_string = NULL;
-      }
-
-      i++;
+      g_string_append_c (result, '(');
+      gtk_tree_selection_selected_foreach (selection, print_selected_row, &print_data);
+      g_string_append_c (result, ')');
     }
 
-    aux = g_strconcat (result, ")", NULL);
-    g_free (result);
-    result = aux;
-
-    g_list_foreach (selected_rows, (GFunc) (gtk_tree_path_free), NULL);
-    g_list_free (selected_rows);
+    has_value = TRUE;
     initial_value = 1;
   } else {
     initial_value = 0;
@@ -774,19 +928,123 @@ _default_print_func (HildonTouchSelector * selector, gpointer user_data)
         gtk_tree_model_get (model, &iter, text_column, &current_string, -1);
       }
 
+      /* Nothing is printed if the first column has no selection */
       if (i == 0) {
-        result = current_string;
-      } else {
-        aux = g_strconcat (result, ":", current_string, NULL);
-        g_free (result);
-        g_free (current_string);
-        current_string = NULL;
-        result = aux;
+        has_value = TRUE;
+      } else if (has_value) {
+        g_string_append_c (result, ':');
       }
+
+      if (has_value && current_string)
+        g_string_append (result, current_string);
+
+      g_free (current_string);
+      current_string = NULL;
     }
   }
 
-  return result;
+  return g_string_free (result, !has_value);
+}
+
+/* Columns show their model directly. A GtkTreeModelFilter is only
+   inserted between the model and the tree view while the column has a
+   live search, so the helpers below are no-ops for the plain case. */
+static GtkTreeModel *
+column_get_view_model                           (HildonTouchSelectorColumn *column)
+{
+  return column->priv->filter ? column->priv->filter : column->priv->model;
+}
+
+static GtkTreePath *
+column_child_path_to_view_path                  (HildonTouchSelectorColumn *column,
+                                                 GtkTreePath *child_path)
+{
+  if (column->priv->filter == NULL)
+    return gtk_tree_path_copy (child_path);
+
+  return gtk_tree_model_filter_convert_child_path_to_path
+    (GTK_TREE_MODEL_FILTER (column->priv->filter), child_path);
+}
+
+static GtkTreePath *
+column_view_path_to_child_path                  (HildonTouchSelectorColumn *column,
+                                                 GtkTreePath *view_path)
+{
+  if (column->priv->filter == NULL)
+    return gtk_tree_path_copy (view_path);
+
+  return gtk_tree_model_filter_convert_path_to_child_path
+    (GTK_TREE_MODEL_FILTER (column->priv->filter), view_path);
+}
+
+static gboolean
+column_child_iter_to_view_iter                  (HildonTouchSelectorColumn *column,
+                                                 GtkTreeIter *view_iter,
+                                                 GtkTreeIter *child_iter)
+{
+  if (column->priv->filter == NULL) {
+    *view_iter = *child_iter;
+    return TRUE;
+  }
+
+  return gtk_tree_model_filter_convert_child_iter_to_iter
+    (GTK_TREE_MODEL_FILTER (column->priv->filter), view_iter, child_iter);
+}
+
+static void
+column_view_iter_to_child_iter                  (HildonTouchSelectorColumn *column,
+                                                 GtkTreeIter *child_iter,
+                                                 GtkTreeIter *view_iter)
+{
+  if (column->priv->filter == NULL) {
+    *child_iter = *view_iter;
+    return;
+  }
+
+  gtk_tree_model_filter_convert_iter_to_child_iter
+    (GTK_TREE_MODEL_FILTER (column->priv->filter), child_iter, view_iter);
+}
+
+/* Adds or removes the filter of @column, keeping the selected rows */
+static void
+column_set_filtered                             (HildonTouchSelectorColumn *column,
+                                                 gboolean filtered)
+{
+  GtkTreeSelection *selection;
+  GList *selected, *child_selected = NULL, *iter;
+
+  if ((column->priv->filter != NULL) == filtered)
+    return;
+
+  selection = gtk_tree_view_get_selection (column->priv->tree_view);
+  selected = gtk_tree_selection_get_selected_rows (selection, NULL);
+  for (iter = selected; iter; iter = iter->next) {
+    child_selected = g_list_prepend (child_selected,
+                                     column_view_path_to_child_path (column, iter->data));
+    gtk_tree_path_free (iter->data);
+  }
+  g_list_free (selected);
+
+  if (filtered) {
+    column->priv->filter = gtk_tree_model_filter_new (column->priv->model, NULL);
+  } else {
+    g_object_unref (column->priv->filter);
+    column->priv->filter = NULL;
+  }
+  gtk_tree_view_set_model (column->priv->tree_view,
+                           column_get_view_model (column));
+
+  for (iter = child_selected; iter; iter = iter->next) {
+    GtkTreePath *view_path;
+
+    view_path = column_child_path_to_view_path (column, iter->data);
+    if (view_path != NULL) {
+      gtk_tree_selection_select_path (selection, view_path);
+      gtk_tree_path_free (view_path);
+    }
+    gtk_tree_path_free (iter->data);
+  }
+  g_list_free (child_selected);
 }
 
 static void
@@ -805,8 +1063,7 @@ hildon_touch_selector_row_activated_cb          (GtkTreeView       *tree_view,
     gtk_tree_row_reference_free (selector_column->priv->last_activated);
   }
 
-  child_path = gtk_tree_model_filter_convert_path_to_child_path (GTK_TREE_MODEL_FILTER (selector_column->priv->filter),
-                                                                 path);
+  child_path = column_view_path_to_child_path (selector_column, path);
   selector_column->priv->last_activated = gtk_tree_row_reference_new (selector_column->priv->model,
                                                                       child_path);
   gtk_tree_path_free (child_path);
@@ -824,7 +1081,7 @@ _row_tapped_cb (GtkTreeView * tree_view, GtkTreePath * path, gpointer user_data)
 
   selector = column->priv->parent;
 
-  num_column = g_slist_index (selector->priv->columns, column);
+  num_column = column->priv->index;
 
   hildon_touch_selector_emit_value_changed (selector, num_column);
 }
@@ -839,7 +1096,6 @@ _create_new_column (HildonTouchSelector * selector,
   HildonTouchSelectorColumn *new_column = NULL;
   GtkTreeViewColumn *tree_column = NULL;
   GtkTreeView *tv = NULL;
-  GtkTreeModel *filter;
   GtkWidget *panarea = NULL;
   GtkTreeSelection *selection = NULL;
   GtkTreeIter iter;
@@ -871,12 +1127,7 @@ _create_new_column (HildonTouchSelector * selector,
     gtk_widget_set_can_focus (GTK_WIDGET (tv), FALSE);
   }
 
-  filter = gtk_tree_model_filter_new (model, NULL);
-  gtk_tree_view_set_model (tv, filter);
-  g_signal_connect (model, "row-changed",
-                    G_CALLBACK (on_row_changed), selector);
-  g_signal_connect_after (model, "row-deleted",
-                          G_CALLBACK (on_row_deleted), selector);
+  gtk_tree_view_set_model (tv, model);
   gtk_tree_view_set_rules_hint (tv, TRUE);
 
   gtk_tree_view_append_column (GTK_TREE_VIEW (tv), tree_column);
@@ -891,15 +1142,17 @@ _create_new_column (HildonTouchSelector * selector,
   new_column->priv->model = g_object_ref (model);
   new_column->priv->tree_view = tv;
   new_column->priv->panarea = panarea;
-  new_column->priv->filter = filter;
+  new_column->priv->filter = NULL;
   new_column->priv->livesearch = NULL;
 
+  model_columns_add (selector, new_column);
+
   selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (tv));
   gtk_tree_selection_set_mode (selection, GTK_SELECTION_BROWSE);
 
   /* select the first item */
   *emit_changed = FALSE;
-  if ((gtk_tree_model_get_iter_first (filter, &iter))&&
+  if ((gtk_tree_model_get_iter_first (model, &iter))&&
       (selector->priv->hildon_ui_mode == HILDON_UI_MODE_EDIT)) {
     gtk_tree_selection_select_iter (selection, &iter);
     *emit_changed = TRUE;
@@ -985,6 +1238,8 @@ hildon_touch_selector_column_init (HildonTouchSelectorColumn *column)
   column->priv->last_activated = NULL;
   column->priv->realize_handler = 0;
   column->priv->initial_path = NULL;
+  column->priv->estimated_rows = -1;
+  column->priv->estimated_height = 0;
 }
 
 static gboolean
@@ -994,8 +1249,7 @@ hildon_live_search_visible_func (GtkTreeModel *model,
                                  gpointer userdata)
 {
   gboolean visible = TRUE;
-  gchar *string, *string_ascii;
-  GSList *list_iter;
+  gchar *string;
   HildonTouchSelectorColumn *col;
   HildonTouchSelector *selector;
 
@@ -1003,18 +1257,12 @@ hildon_live_search_visible_func (GtkTreeModel *model,
   selector = col->priv->parent;
   gint text_column = GPOINTER_TO_INT (col->priv->text_column);
 
-  gtk_tree_model_get (model, iter, text_column, &string, -1);
-  string_ascii = hildon_helper_normalize_string (string);
-  list_iter = selector->priv->norm_tokens;
-  while (visible && list_iter) {
-    visible = (string_ascii != NULL &&
-               hildon_helper_smart_match (string_ascii,
-                                          (const gchar *)list_iter->data));
-    list_iter = list_iter->next;
-  }
+  if (selector->priv->matcher == NULL)
+    return TRUE;
 
+  gtk_tree_model_get (model, iter, text_column, &string, -1);
+  visible = hildon_matcher_match (selector->priv->matcher, string, NULL, NULL);
   g_free (string);
-  g_free (string_ascii);
 
   return visible;
 }
@@ -1025,24 +1273,14 @@ on_live_search_refilter (HildonLiveSearch *livesearch,
 {
     HildonTouchSelector *selector = HILDON_TOUCH_SELECTOR (userdata);
 
-    gchar **tokens = g_strsplit (hildon_live_search_get_text (livesearch), " ", -1);
-    gchar *token;
-    gint i;
-
-    if (selector->priv->norm_tokens != NULL) {
-        g_slist_foreach (selector->priv->norm_tokens, (GFunc) g_free, NULL);
-        g_slist_free (selector->priv->norm_tokens);
-        selector->priv->norm_tokens = NULL;
-    }
-
-    for (i = 0; tokens [i] != NULL; i++) {
-        token = hildon_helper_normalize_string (tokens[i]);
-        if (token != NULL)
-            selector->priv->norm_tokens = g_slist_prepend (selector->priv->norm_tokens,
-                                                           token);
-    }
+    /* The text is prepared once here, instead of once per row in the
+       visible function */
+    if (selector->priv->matcher != NULL)
+        hildon_matcher_unref (selector->priv->matcher);
 
-    g_strfreev (tokens);
+    selector->priv->matcher =
+        hildon_matcher_new (hildon_live_search_get_text (livesearch),
+                            HILDON_MATCHER_SPLIT_WORDS);
 
     return FALSE;
 }
@@ -1433,6 +1671,8 @@ hildon_touch_selector_add_live_search (HildonTouchSelector *selector,
   if (column->priv->livesearch == NULL) {
     gint text_column;
 
+    column_set_filtered (column, TRUE);
+
     column->priv->livesearch = hildon_live_search_new ();
     hildon_live_search_set_filter (HILDON_LIVE_SEARCH (column->priv->livesearch),
                                    GTK_TREE_MODEL_FILTER (column->priv->filter));
@@ -1460,10 +1700,10 @@ hildon_touch_selector_remove_live_search (HildonTouchSelector *selector)
   HildonTouchSelectorColumn *col;
 
   if (selector->priv->has_live_search == FALSE ||
-      selector->priv->columns == NULL)
+      selector->priv->columns->len == 0)
     return;
 
-  col = (HildonTouchSelectorColumn *) selector->priv->columns->data;
+  col = g_ptr_array_index (selector->priv->columns, 0);
 
   if (col->priv->livesearch != NULL) {
     hildon_live_search_widget_unhook (HILDON_LIVE_SEARCH (col->priv->livesearch));
@@ -1471,6 +1711,8 @@ hildon_touch_selector_remove_live_search (HildonTouchSelector *selector)
     col->priv->livesearch = NULL;
   }
 
+  column_set_filtered (col, FALSE);
+
   selector->priv->has_live_search = FALSE;
 }
 
@@ -1528,6 +1770,8 @@ hildon_touch_selector_append_column (HildonTouchSelector * selector,
   g_return_val_if_fail (HILDON_IS_TOUCH_SELECTOR (selector), NULL);
   g_return_val_if_fail (GTK_IS_TREE_MODEL (model), NULL);
 
+  hildon_touch_selector_build_columns (selector);
+
   if (model != NULL) {
 
     va_start (args, cell_renderer);
@@ -1536,13 +1780,12 @@ hildon_touch_selector_append_column (HildonTouchSelector * selector,
 
     /* If we already have one column, disable live search */
     if (selector->priv->has_live_search &&
-        selector->priv->columns != NULL &&
-        selector->priv->columns->next == NULL) {
+        selector->priv->columns->len == 1) {
 	    hildon_touch_selector_remove_live_search (selector);
     }
 
-    selector->priv->columns = g_slist_append (selector->priv->columns,
-                                              new_column);
+    new_column->priv->index = selector->priv->columns->len;
+    g_ptr_array_add (selector->priv->columns, new_column);
 
     new_column->priv->vbox = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
     gtk_box_pack_start (GTK_BOX (new_column->priv->vbox),
@@ -1571,7 +1814,7 @@ hildon_touch_selector_append_column (HildonTouchSelector * selector,
 
   g_signal_emit (selector, hildon_touch_selector_signals[COLUMNS_CHANGED], 0);
   if (emit_changed) {
-    colnum = g_slist_length (selector->priv->columns);
+    colnum = new_column->priv->index;
     hildon_touch_selector_emit_value_changed (selector, colnum);
   }
 
@@ -1640,17 +1883,23 @@ hildon_touch_selector_remove_column (HildonTouchSelector * selector, gint column
 {
   HildonTouchSelectorColumn *current_column = NULL;
   HildonTouchSelectorPrivate *priv;
+  guint i;
 
   g_return_val_if_fail (HILDON_IS_TOUCH_SELECTOR (selector), FALSE);
   g_return_val_if_fail (column <
                         hildon_touch_selector_get_num_columns (selector), FALSE);
 
   priv = HILDON_TOUCH_SELECTOR_GET_PRIVATE (selector);
-  current_column = g_slist_nth_data (priv->columns, column);
+  current_column = g_ptr_array_index (priv->columns, column);
 
   gtk_container_remove (GTK_CONTAINER (priv->hbox), current_column->priv->vbox);
-  priv->columns = g_slist_remove (priv->columns, current_column);
-  g_object_unref (current_column);
+  clean_column (current_column, selector);
+  g_ptr_array_remove_index (priv->columns, column);
+
+  for (i = column; i < priv->columns->len; i++) {
+    HildonTouchSelectorColumn *col = g_ptr_array_index (priv->columns, i);
+    col->priv->index = i;
+  }
 
   g_signal_emit (selector, hildon_touch_selector_signals[COLUMNS_CHANGED], 0);
 
@@ -1690,7 +1939,7 @@ hildon_touch_selector_set_column_attributes (HildonTouchSelector * selector,
   g_return_if_fail (num_column <
                     hildon_touch_selector_get_num_columns (selector));
 
-  current_column = g_slist_nth_data (selector->priv->columns, num_column);
+  current_column = g_ptr_array_index (selector->priv->columns, num_column);
 
   tree_column = gtk_tree_view_get_column (current_column->priv->tree_view, 0);
   gtk_tree_view_remove_column (current_column->priv->tree_view, tree_column);
@@ -1730,7 +1979,9 @@ hildon_touch_selector_get_num_columns (HildonTouchSelector * selector)
 {
   g_return_val_if_fail (HILDON_IS_TOUCH_SELECTOR (selector), -1);
 
-  return g_slist_length (selector->priv->columns);
+  hildon_touch_selector_build_columns (selector);
+
+  return selector->priv->columns->len;
 }
 
 /**
@@ -1756,7 +2007,7 @@ hildon_touch_selector_get_column_selection_mode (HildonTouchSelector * selector)
   g_return_val_if_fail (hildon_touch_selector_get_num_columns (selector) > 0,
                         result);
 
-  column = HILDON_TOUCH_SELECTOR_COLUMN (selector->priv->columns->data);
+  column = g_ptr_array_index (selector->priv->columns, 0);
 
   selection = gtk_tree_view_get_selection (column->priv->tree_view);
   treeview_mode = gtk_tree_selection_get_mode (selection);
@@ -1804,7 +2055,7 @@ hildon_touch_selector_set_column_selection_mode (HildonTouchSelector * selector,
     return;
   }
 
-  column = HILDON_TOUCH_SELECTOR_COLUMN ((g_slist_nth (selector->priv->columns, 0))->data);
+  column = g_ptr_array_index (selector->priv->columns, 0);
   tv = column->priv->tree_view;
 
   if (tv) {
@@ -1822,7 +2073,7 @@ hildon_touch_selector_set_column_selection_mode (HildonTouchSelector * selector,
 
     selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (tv));
     gtk_tree_selection_unselect_all (selection);
-    if (gtk_tree_model_get_iter_first (column->priv->filter, &iter)) {
+    if (gtk_tree_model_get_iter_first (column_get_view_model (column), &iter)) {
         gtk_tree_selection_select_iter (selection, &iter);
     }
 
@@ -1906,6 +2157,56 @@ hildon_touch_selector_get_print_func (HildonTouchSelector * selector)
   return selector->priv->print_func;
 }
 
+/**
+ * hildon_touch_selector_set_max_printed_items:
+ * @selector: a #HildonTouchSelector
+ * @max_items: the maximum number of items to list, or -1 for no limit
+ *
+ * Sets the maximum number of selected items that the default print
+ * function lists when @selector is in
+ * %HILDON_TOUCH_SELECTOR_SELECTION_MODE_MULTIPLE. When more items are
+ * selected, a text like "12 items selected" is printed instead. This
+ * keeps the value of a #HildonPickerButton cheap to produce for large
+ * selections.
+ *
+ * This setting has no effect on custom print functions set with
+ * hildon_touch_selector_set_print_func().
+ *
+ * Since: 3.0
+ **/
+void
+hildon_touch_selector_set_max_printed_items (HildonTouchSelector *selector,
+                                             gint max_items)
+{
+  g_return_if_fail (HILDON_IS_TOUCH_SELECTOR (selector));
+  g_return_if_fail (max_items >= -1);
+
+  if (selector->priv->max_printed_items == max_items)
+    return;
+
+  selector->priv->max_printed_items = max_items;
+  g_object_notify (G_OBJECT (selector), "max-printed-items");
+}
+
+/**
+ * hildon_touch_selector_get_max_printed_items:
+ * @selector: a #HildonTouchSelector
+ *
+ * Gets the value set by hildon_touch_selector_set_max_printed_items().
+ *
+ * Returns: the maximum number of items listed by the default print
+ * function, or -1 if there is no limit.
+ *
+ * Since: 3.0
+ **/
+gint
+hildon_touch_selector_get_max_printed_items (HildonTouchSelector *selector)
+{
+  g_return_val_if_fail (HILDON_IS_TOUCH_SELECTOR (selector), -1);
+
+  return selector->priv->max_printed_items;
+}
+
 /**
  * hildon_touch_selector_set_active:
  * @selector: a #HildonTouchSelector
@@ -1934,7 +2235,7 @@ hildon_touch_selector_set_active                (HildonTouchSelector *selector,
   mode = hildon_touch_selector_get_column_selection_mode (selector);
   g_return_if_fail (mode == HILDON_TOUCH_SELECTOR_SELECTION_MODE_SINGLE);
 
-  current_column = g_slist_nth_data (selector->priv->columns, column);
+  current_column = g_ptr_array_index (selector->priv->columns, column);
 
   selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (current_column->priv->tree_view));
 
@@ -1945,8 +2246,7 @@ hildon_touch_selector_set_active                (HildonTouchSelector *selector,
   }
 
   path = gtk_tree_path_new_from_indices (index, -1);
-  filter_path = gtk_tree_model_filter_convert_child_path_to_path (
-      GTK_TREE_MODEL_FILTER (current_column->priv->filter), path);
+  filter_path = column_child_path_to_view_path (current_column, path);
 
   if (filter_path != NULL) {
       gtk_tree_selection_unselect_all (selection);
@@ -1989,15 +2289,14 @@ hildon_touch_selector_get_active                (HildonTouchSelector *selector,
   mode = hildon_touch_selector_get_column_selection_mode (selector);
   g_return_val_if_fail (mode == HILDON_TOUCH_SELECTOR_SELECTION_MODE_SINGLE, -1);
 
-  current_column = g_slist_nth_data (selector->priv->columns, column);
+  current_column = g_ptr_array_index (selector->priv->columns, column);
 
   selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (current_column->priv->tree_view));
 
   if (gtk_tree_selection_get_selected (selection, NULL, &filter_iter)) {
     GtkTreePath *path;
     GtkTreeIter iter;
-    gtk_tree_model_filter_convert_iter_to_child_iter (GTK_TREE_MODEL_FILTER (current_column->priv->filter),
-                                                      &iter, &filter_iter);
+    column_view_iter_to_child_iter (current_column, &iter, &filter_iter);
     path = gtk_tree_model_get_path (current_column->priv->model, &iter);
     index = (gtk_tree_path_get_indices (path))[0];
     gtk_tree_path_free (path);
@@ -2048,7 +2347,7 @@ hildon_touch_selector_get_selected (HildonTouchSelector * selector,
      ((mode == HILDON_TOUCH_SELECTOR_SELECTION_MODE_MULTIPLE)&&(column>0)),
      FALSE);
 
-  current_column = g_slist_nth_data (selector->priv->columns, column);
+  current_column = g_ptr_array_index (selector->priv->columns, column);
 
   selection =
     gtk_tree_view_get_selection (GTK_TREE_VIEW (current_column->priv->tree_view));
@@ -2057,9 +2356,7 @@ hildon_touch_selector_get_selected (HildonTouchSelector * selector,
 
   if (iter) {
     if (result == TRUE) {
-      gtk_tree_model_filter_convert_iter_to_child_iter
-        (GTK_TREE_MODEL_FILTER (current_column->priv->filter),
-         iter, &filter_iter);
+      column_view_iter_to_child_iter (current_column, iter, &filter_iter);
     } else {
       memset (iter, 0, sizeof (GtkTreeIter));
     }
@@ -2096,18 +2393,18 @@ hildon_touch_selector_select_iter (HildonTouchSelector * selector,
   g_return_if_fail (HILDON_IS_TOUCH_SELECTOR (selector));
   g_return_if_fail (column < hildon_touch_selector_get_num_columns (selector));
 
-  current_column = g_slist_nth_data (selector->priv->columns, column);
+  current_column = g_ptr_array_index (selector->priv->columns, column);
 
   tv = current_column->priv->tree_view;
   selection = gtk_tree_view_get_selection (tv);
 
   /* The given iter might be not visible, due to the
      GtkTreeModelFilter we use. If so, don't change the selection. */
-  if (gtk_tree_model_filter_convert_child_iter_to_iter (GTK_TREE_MODEL_FILTER (current_column->priv->filter),
-                                                        &filter_iter, iter) == FALSE)
+  if (column_child_iter_to_view_iter (current_column, &filter_iter, iter) == FALSE)
           return;
 
-  filter_path = gtk_tree_model_get_path (current_column->priv->filter, &filter_iter);
+  filter_path = gtk_tree_model_get_path (column_get_view_model (current_column),
+                                         &filter_iter);
 
   gtk_tree_selection_select_iter (selection, &filter_iter);
 
@@ -2142,10 +2439,9 @@ void hildon_touch_selector_unselect_iter (HildonTouchSelector * selector,
   g_return_if_fail (HILDON_IS_TOUCH_SELECTOR (selector));
   g_return_if_fail (column < hildon_touch_selector_get_num_columns (selector));
 
-  current_column = g_slist_nth_data (selector->priv->columns, column);
+  current_column = g_ptr_array_index (selector->priv->columns, column);
   selection = gtk_tree_view_get_selection (current_column->priv->tree_view);
-  if (gtk_tree_model_filter_convert_child_iter_to_iter (GTK_TREE_MODEL_FILTER (current_column->priv->filter),
-                                                        &filter_iter, iter) == FALSE)
+  if (column_child_iter_to_view_iter (current_column, &filter_iter, iter) == FALSE)
     return;
 
   gtk_tree_selection_unselect_iter (selection, &filter_iter);
@@ -2171,13 +2467,430 @@ hildon_touch_selector_unselect_all (HildonTouchSelector * selector,
   g_return_if_fail (HILDON_IS_TOUCH_SELECTOR (selector));
   g_return_if_fail (column < hildon_touch_selector_get_num_columns (selector));
 
-  current_column = g_slist_nth_data (selector->priv->columns, column);
+  current_column = g_ptr_array_index (selector->priv->columns, column);
   selection = gtk_tree_view_get_selection (current_column->priv->tree_view);
   gtk_tree_selection_unselect_all (selection);
 
   hildon_touch_selector_emit_value_changed (selector, column);
 }
 
+/**
+ * hildon_touch_selector_select_paths:
+ * @selector: a #HildonTouchSelector
+ * @column: the position of the column to select the items in
+ * @paths: (element-type GtkTreePath): a list of #GtkTreePath<!-- -->s of the
+ * model of @column
+ *
+ * Adds all the rows in @paths to the selection of the column
+ * @column. Rows hidden by the live search of the column are skipped,
+ * as in hildon_touch_selector_select_iter(). In
+ * %HILDON_TOUCH_SELECTOR_SELECTION_MODE_SINGLE, the last selectable row
+ * of @paths ends up selected.
+ *
+ * The #HildonTouchSelector::changed signal is emitted once for the
+ * whole list, instead of once per row.
+ *
+ * Since: 3.0
+ **/
+void
+hildon_touch_selector_select_paths (HildonTouchSelector *selector,
+                                    gint column,
+                                    GList *paths)
+{
+  HildonTouchSelectorColumn *current_column = NULL;
+  GtkTreeSelection *selection = NULL;
+  GList *iter;
+
+  g_return_if_fail (HILDON_IS_TOUCH_SELECTOR (selector));
+  g_return_if_fail (column < hildon_touch_selector_get_num_columns (selector));
+
+  if (paths == NULL)
+    return;
+
+  current_column = g_ptr_array_index (selector->priv->columns, column);
+  selection = gtk_tree_view_get_selection (current_column->priv->tree_view);
+
+  for (iter = paths; iter; iter = iter->next) {
+    GtkTreePath *filter_path;
+
+    filter_path = column_child_path_to_view_path (current_column,
+                                                  (GtkTreePath *) iter->data);
+    if (filter_path == NULL)
+      continue;
+
+    gtk_tree_selection_select_path (selection, filter_path);
+    gtk_tree_path_free (filter_path);
+  }
+
+  hildon_touch_selector_emit_value_changed (selector, column);
+}
+
+/**
+ * hildon_touch_selector_begin_update:
+ * @selector: a #HildonTouchSelector
+ *
+ * Starts a batch of changes in the selection of @selector. Until the
+ * matching call to hildon_touch_selector_end_update(), the
+ * #HildonTouchSelector::changed signal is not emitted. Instead, each
+ * column whose selection changed is recorded, and
+ * hildon_touch_selector_end_update() emits the signal once for each
+ * of them.
+ *
+ * Calls to this function can be nested.
+ *
+ * Since: 3.0
+ **/
+void
+hildon_touch_selector_begin_update (HildonTouchSelector *selector)
+{
+  g_return_if_fail (HILDON_IS_TOUCH_SELECTOR (selector));
+
+  if (selector->priv->pending_changes == NULL)
+    selector->priv->pending_changes = g_array_new (FALSE, FALSE, sizeof (gint));
+
+  selector->priv->update_depth++;
+}
+
+/**
+ * hildon_touch_selector_end_update:
+ * @selector: a #HildonTouchSelector
+ *
+ * Ends a batch of changes started with
+ * hildon_touch_selector_begin_update(). When the outermost batch ends,
+ * #HildonTouchSelector::changed is emitted once for each column whose
+ * selection changed, in the order the columns were first changed.
+ *
+ * Since: 3.0
+ **/
+void
+hildon_touch_selector_end_update (HildonTouchSelector *selector)
+{
+  GArray *pending;
+  guint i;
+
+  g_return_if_fail (HILDON_IS_TOUCH_SELECTOR (selector));
+  g_return_if_fail (selector->priv->update_depth > 0);
+
+  if (--selector->priv->update_depth > 0)
+    return;
+
+  /* Handlers may start a new batch, so emit from a copy */
+  pending = selector->priv->pending_changes;
+  selector->priv->pending_changes = NULL;
+
+  for (i = 0; i < pending->len; i++)
+    hildon_touch_selector_emit_value_changed (selector,
+                                              g_array_index (pending, gint, i));
+
+  g_array_free (pending, TRUE);
+}
+
+struct _HildonTouchSelectorSnapshot
+{
+  gint n_columns;
+  GArray **rows;                /* sorted indices of the selected rows, per column */
+};
+
+G_DEFINE_BOXED_TYPE (HildonTouchSelectorSnapshot, hildon_touch_selector_snapshot,
+                     hildon_touch_selector_snapshot_copy,
+                     hildon_touch_selector_snapshot_free);
+
+/**
+ * hildon_touch_selector_snapshot_new:
+ * @n_columns: the number of columns of the snapshot
+ *
+ * Creates a #HildonTouchSelectorSnapshot with @n_columns columns and
+ * no selected rows. Use hildon_touch_selector_snapshot_set_rows() to
+ * fill it, for example with a selection saved by the application.
+ *
+ * Returns: a new #HildonTouchSelectorSnapshot. Free it with
+ * hildon_touch_selector_snapshot_free().
+ *
+ * Since: 3.0
+ **/
+HildonTouchSelectorSnapshot *
+hildon_touch_selector_snapshot_new              (gint n_columns)
+{
+  HildonTouchSelectorSnapshot *snapshot;
+  gint i;
+
+  g_return_val_if_fail (n_columns >= 0, NULL);
+
+  snapshot = g_slice_new (HildonTouchSelectorSnapshot);
+  snapshot->n_columns = n_columns;
+  snapshot->rows = g_new (GArray *, n_columns);
+  for (i = 0; i < n_columns; i++)
+    snapshot->rows[i] = g_array_new (FALSE, FALSE, sizeof (gint));
+
+  return snapshot;
+}
+
+/**
+ * hildon_touch_selector_snapshot_copy:
+ * @snapshot: a #HildonTouchSelectorSnapshot
+ *
+ * Copies @snapshot.
+ *
+ * Returns: a new #HildonTouchSelectorSnapshot
+ *
+ * Since: 3.0
+ **/
+HildonTouchSelectorSnapshot *
+hildon_touch_selector_snapshot_copy             (const HildonTouchSelectorSnapshot *snapshot)
+{
+  HildonTouchSelectorSnapshot *copy;
+  gint i;
+
+  g_return_val_if_fail (snapshot != NULL, NULL);
+
+  copy = hildon_touch_selector_snapshot_new (snapshot->n_columns);
+  for (i = 0; i < snapshot->n_columns; i++)
+    g_array_append_vals (copy->rows[i], snapshot->rows[i]->data, snapshot->rows[i]->len);
+
+  return copy;
+}
+
+/**
+ * hildon_touch_selector_snapshot_free:
+ * @snapshot: a #HildonTouchSelectorSnapshot
+ *
+ * Frees @snapshot.
+ *
+ * Since: 3.0
+ **/
+void
+hildon_touch_selector_snapshot_free             (HildonTouchSelectorSnapshot *snapshot)
+{
+  gint i;
+
+  if (snapshot == NULL)
+    return;
+
+  for (i = 0; i < snapshot->n_columns; i++)
+    g_array_free (snapshot->rows[i], TRUE);
+  g_free (snapshot->rows);
+  g_slice_free (HildonTouchSelectorSnapshot, snapshot);
+}
+
+/**
+ * hildon_touch_selector_snapshot_get_n_columns:
+ * @snapshot: a #HildonTouchSelectorSnapshot
+ *
+ * Gets the number of columns of @snapshot.
+ *
+ * Returns: the number of columns
+ *
+ * Since: 3.0
+ **/
+gint
+hildon_touch_selector_snapshot_get_n_columns    (const HildonTouchSelectorSnapshot *snapshot)
+{
+  g_return_val_if_fail (snapshot != NULL, 0);
+
+  return snapshot->n_columns;
+}
+
+/**
+ * hildon_touch_selector_snapshot_get_rows:
+ * @snapshot: a #HildonTouchSelectorSnapshot
+ * @column: a column of @snapshot
+ * @n_rows: return location for the number of rows
+ *
+ * Gets the indices of the rows selected in @column, in increasing
+ * order. The returned array belongs to @snapshot.
+ *
+ * Returns: (array length=n_rows): the selected rows of @column
+ *
+ * Since: 3.0
+ **/
+const gint *
+hildon_touch_selector_snapshot_get_rows         (const HildonTouchSelectorSnapshot *snapshot,
+                                                 gint                               column,
+                                                 gint                              *n_rows)
+{
+  g_return_val_if_fail (snapshot != NULL, NULL);
+  g_return_val_if_fail (column >= 0 && column < snapshot->n_columns, NULL);
+  g_return_val_if_fail (n_rows != NULL, NULL);
+
+  *n_rows = snapshot->rows[column]->len;
+
+  return (const gint *) snapshot->rows[column]->data;
+}
+
+static gint
+compare_rows                                    (gconstpointer a,
+                                                 gconstpointer b)
+{
+  gint row_a = *(const gint *) a;
+  gint row_b = *(const gint *) b;
+
+  return (row_a > row_b) - (row_a < row_b);
+}
+
+/**
+ * hildon_touch_selector_snapshot_set_rows:
+ * @snapshot: a #HildonTouchSelectorSnapshot
+ * @column: a column of @snapshot
+ * @rows: (array length=n_rows): indices of rows, in any order
+ * @n_rows: the number of elements of @rows
+ *
+ * Replaces the rows selected in @column of @snapshot with @rows.
+ *
+ * Since: 3.0
+ **/
+void
+hildon_touch_selector_snapshot_set_rows         (HildonTouchSelectorSnapshot *snapshot,
+                                                 gint                         column,
+                                                 const gint                  *rows,
+                                                 gint                         n_rows)
+{
+  GArray *column_rows;
+  gint i;
+
+  g_return_if_fail (snapshot != NULL);
+  g_return_if_fail (column >= 0 && column < snapshot->n_columns);
+  g_return_if_fail (n_rows == 0 || rows != NULL);
+
+  column_rows = snapshot->rows[column];
+  g_array_set_size (column_rows, 0);
+
+  for (i = 0; i < n_rows; i++) {
+    g_return_if_fail (rows[i] >= 0);
+    g_array_append_val (column_rows, rows[i]);
+  }
+
+  g_array_sort (column_rows, compare_rows);
+}
+
+static void
+snapshot_add_row                                (GtkTreeModel *model,
+                                                 GtkTreePath  *path,
+                                                 GtkTreeIter  *iter,
+                                                 gpointer      data)
+{
+  HildonTouchSelectorColumn *column = ((gpointer *) data)[0];
+  GArray *rows = ((gpointer *) data)[1];
+  GtkTreePath *child_path;
+  gint row;
+
+  child_path = column_view_path_to_child_path (column, path);
+  if (child_path == NULL)
+    return;
+
+  /* Columns are lists: only top level rows are recorded */
+  if (gtk_tree_path_get_depth (child_path) == 1) {
+    row = gtk_tree_path_get_indices (child_path)[0];
+    g_array_append_val (rows, row);
+  }
+
+  gtk_tree_path_free (child_path);
+}
+
+/**
+ * hildon_touch_selector_take_snapshot:
+ * @selector: a #HildonTouchSelector
+ *
+ * Records the rows selected in every column of @selector, as indices
+ * of the rows in the models of the columns. This takes time
+ * proportional to the number of selected rows, and the snapshot can be
+ * applied later with hildon_touch_selector_restore_snapshot(), for
+ * instance to cancel the changes done in a #HildonPickerDialog.
+ *
+ * Returns: a new #HildonTouchSelectorSnapshot. Free it with
+ * hildon_touch_selector_snapshot_free().
+ *
+ * Since: 3.0
+ **/
+HildonTouchSelectorSnapshot *
+hildon_touch_selector_take_snapshot             (HildonTouchSelector *selector)
+{
+  HildonTouchSelectorSnapshot *snapshot;
+  guint i;
+
+  g_return_val_if_fail (HILDON_IS_TOUCH_SELECTOR (selector), NULL);
+
+  hildon_touch_selector_build_columns (selector);
+
+  snapshot = hildon_touch_selector_snapshot_new (selector->priv->columns->len);
+
+  for (i = 0; i < selector->priv->columns->len; i++) {
+    HildonTouchSelectorColumn *column = g_ptr_array_index (selector->priv->columns, i);
+    GtkTreeSelection *selection;
+    gpointer data[2];
+
+    selection = gtk_tree_view_get_selection (column->priv->tree_view);
+
+    data[0] = column;
+    data[1] = snapshot->rows[i];
+    /* Rows come in view order, which the filter keeps */
+    gtk_tree_selection_selected_foreach (selection, snapshot_add_row, data);
+  }
+
+  return snapshot;
+}
+
+/**
+ * hildon_touch_selector_restore_snapshot:
+ * @selector: a #HildonTouchSelector
+ * @snapshot: a #HildonTouchSelectorSnapshot
+ *
+ * Selects in every column of @selector the rows recorded in
+ * @snapshot, and only those. Rows that no longer exist, or that are
+ * hidden by a live search, are skipped. #HildonTouchSelector::changed
+ * is emitted once for each column.
+ *
+ * Returns: %TRUE if the selection was restored, %FALSE if @snapshot
+ * and @selector have a different number of columns.
+ *
+ * Since: 3.0
+ **/
+gboolean
+hildon_touch_selector_restore_snapshot          (HildonTouchSelector               *selector,
+                                                 const HildonTouchSelectorSnapshot *snapshot)
+{
+  guint i;
+
+  g_return_val_if_fail (HILDON_IS_TOUCH_SELECTOR (selector), FALSE);
+  g_return_val_if_fail (snapshot != NULL, FALSE);
+
+  hildon_touch_selector_build_columns (selector);
+
+  if (snapshot->n_columns != selector->priv->columns->len)
+    return FALSE;
+
+  hildon_touch_selector_begin_update (selector);
+
+  for (i = 0; i < selector->priv->columns->len; i++) {
+    HildonTouchSelectorColumn *column = g_ptr_array_index (selector->priv->columns, i);
+    GArray *rows = snapshot->rows[i];
+    GtkTreeSelection *selection;
+    guint j;
+
+    selection = gtk_tree_view_get_selection (column->priv->tree_view);
+    gtk_tree_selection_unselect_all (selection);
+
+    for (j = 0; j < rows->len; j++) {
+      GtkTreePath *child_path, *view_path;
+
+      child_path = gtk_tree_path_new_from_indices (g_array_index (rows, gint, j), -1);
+      view_path = column_child_path_to_view_path (column, child_path);
+      gtk_tree_path_free (child_path);
+
+      if (view_path == NULL)
+        continue;
+
+      gtk_tree_selection_select_path (selection, view_path);
+      gtk_tree_path_free (view_path);
+    }
+
+    hildon_touch_selector_emit_value_changed (selector, i);
+  }
+
+  hildon_touch_selector_end_update (selector);
+
+  return TRUE;
+}
+
 /**
  * hildon_touch_selector_filter_selected_to_child_selected:
  * @filter: 
@@ -2197,11 +2910,11 @@ hildon_touch_selector_filter_selected_to_child_selected (GtkTreeModelFilter *fil
     GList *child_selected = NULL;
 
     for (iter = filter_selected; iter; iter = iter->next)
-        child_selected = g_list_append (child_selected,
-                                        gtk_tree_model_filter_convert_path_to_child_path (
-                                            filter, (GtkTreePath *)iter->data));
+        child_selected = g_list_prepend (child_selected,
+                                         gtk_tree_model_filter_convert_path_to_child_path (
+                                             filter, (GtkTreePath *)iter->data));
 
-    return child_selected;
+    return g_list_reverse (child_selected);
 }
 
 /**
@@ -2233,10 +2946,13 @@ hildon_touch_selector_get_selected_rows (HildonTouchSelector * selector,
   g_return_val_if_fail (column < hildon_touch_selector_get_num_columns (selector),
                         NULL);
 
-  current_column = g_slist_nth_data (selector->priv->columns, column);
+  current_column = g_ptr_array_index (selector->priv->columns, column);
   selection = gtk_tree_view_get_selection (current_column->priv->tree_view);
 
   filter_selected = gtk_tree_selection_get_selected_rows (selection, NULL);
+  if (current_column->priv->filter == NULL)
+    return filter_selected;
+
   result = hildon_touch_selector_filter_selected_to_child_selected
       (GTK_TREE_MODEL_FILTER (current_column->priv->filter),
        filter_selected);
@@ -2266,7 +2982,7 @@ hildon_touch_selector_get_model (HildonTouchSelector * selector, gint column)
   g_return_val_if_fail (column < hildon_touch_selector_get_num_columns (selector),
                         NULL);
 
-  current_column = g_slist_nth_data (selector->priv->columns, column);
+  current_column = g_ptr_array_index (selector->priv->columns, column);
 
   return current_column->priv->model;
 }
@@ -2280,26 +2996,24 @@ on_row_changed (GtkTreeModel *model,
   HildonTouchSelector *selector;
   HildonTouchSelectorColumn *current_column;
   GtkTreePath *filter_path;
-
-  gint column = 0;
-  GSList *col;
+  GPtrArray *columns;
+  guint i;
 
   selector = HILDON_TOUCH_SELECTOR (userdata);
 
-  for (col = selector->priv->columns; col != NULL; col = col->next) {
-    current_column = HILDON_TOUCH_SELECTOR_COLUMN (col->data);
-    if (current_column->priv->model == model) {
-        filter_path =
-            gtk_tree_model_filter_convert_child_path_to_path (GTK_TREE_MODEL_FILTER (current_column->priv->filter),
-                                                              path);
-        if (filter_path &&
-            gtk_tree_selection_path_is_selected (gtk_tree_view_get_selection (current_column->priv->tree_view),
-                                                 filter_path)) {
-            hildon_touch_selector_emit_value_changed (selector, column);
-        }
-        gtk_tree_path_free (filter_path);
+  columns = g_hash_table_lookup (selector->priv->model_columns, model);
+  if (columns == NULL)
+    return;
+
+  for (i = 0; i < columns->len; i++) {
+    current_column = g_ptr_array_index (columns, i);
+    filter_path = column_child_path_to_view_path (current_column, path);
+    if (filter_path &&
+        gtk_tree_selection_path_is_selected (gtk_tree_view_get_selection (current_column->priv->tree_view),
+                                             filter_path)) {
+        hildon_touch_selector_emit_value_changed (selector, current_column->priv->index);
     }
-    column ++;
+    gtk_tree_path_free (filter_path);
   }
 }
 
@@ -2309,29 +3023,31 @@ on_row_deleted (GtkTreeModel *model,
                 gpointer userdata)
 {
   HildonTouchSelector *selector = HILDON_TOUCH_SELECTOR (userdata);
-  gint column = 0;
-  GSList *col = selector->priv->columns;
-
-  while (col != NULL) {
-    HildonTouchSelectorColumn *current_column;
-    current_column = HILDON_TOUCH_SELECTOR_COLUMN (col->data);
-    if (current_column->priv->model == model) {
-      GtkTreeSelection *sel = gtk_tree_view_get_selection (current_column->priv->tree_view);
-      if (gtk_tree_selection_get_mode (sel) == GTK_SELECTION_BROWSE &&
-          gtk_tree_model_iter_n_children (model, NULL) > 0 &&
-          gtk_tree_selection_count_selected_rows (sel) == 0) {
-        GtkTreeIter iter;
-        GtkTreePath *first;
-
-        gtk_tree_model_get_iter_first (current_column->priv->filter, &iter);
-        first = gtk_tree_model_get_path (current_column->priv->filter, &iter);
-        gtk_tree_selection_select_path (sel, first);
-        gtk_tree_path_free (first);
-      }
-      hildon_touch_selector_emit_value_changed (selector, column);
+  GPtrArray *columns;
+  guint i;
+
+  columns = g_hash_table_lookup (selector->priv->model_columns, model);
+  if (columns == NULL)
+    return;
+
+  for (i = 0; i < columns->len; i++) {
+    HildonTouchSelectorColumn *current_column = g_ptr_array_index (columns, i);
+    GtkTreeSelection *sel = gtk_tree_view_get_selection (current_column->priv->tree_view);
+
+    if (gtk_tree_selection_get_mode (sel) == GTK_SELECTION_BROWSE &&
+        gtk_tree_model_iter_n_children (model, NULL) > 0 &&
+        gtk_tree_selection_count_selected_rows (sel) == 0) {
+      GtkTreeIter iter;
+      GtkTreePath *first;
+
+      GtkTreeModel *view_model = column_get_view_model (current_column);
+
+      gtk_tree_model_get_iter_first (view_model, &iter);
+      first = gtk_tree_model_get_path (view_model, &iter);
+      gtk_tree_selection_select_path (sel, first);
+      gtk_tree_path_free (first);
     }
-    col = col->next;
-    column ++;
+    hildon_touch_selector_emit_value_changed (selector, current_column->priv->index);
   }
 }
 
@@ -2341,31 +3057,29 @@ _hildon_touch_selector_set_model (HildonTouchSelector * selector,
 {
   HildonTouchSelectorColumn *current_column = NULL;
 
-  current_column =
-    HILDON_TOUCH_SELECTOR_COLUMN (g_slist_nth_data (selector->priv->columns, column));
+  current_column = g_ptr_array_index (selector->priv->columns, column);
 
   if (current_column->priv->model) {
-    g_signal_handlers_disconnect_by_func (current_column->priv->model,
-                                          on_row_changed, selector);
-    g_signal_handlers_disconnect_by_func (current_column->priv->model,
-                                          on_row_deleted, selector);
+    model_columns_remove (selector, current_column);
     g_object_unref (current_column->priv->model);
   }
 
   current_column->priv->model = g_object_ref (model);
+  current_column->priv->estimated_rows = -1;
 
   if (current_column->priv->filter) {
     g_object_unref (current_column->priv->filter);
+    current_column->priv->filter = gtk_tree_model_filter_new (model, NULL);
+    if (current_column->priv->livesearch) {
+      hildon_live_search_set_filter (HILDON_LIVE_SEARCH (current_column->priv->livesearch),
+                                     GTK_TREE_MODEL_FILTER (current_column->priv->filter));
+    }
   }
 
-  current_column->priv->filter = gtk_tree_model_filter_new (model, NULL);
   gtk_tree_view_set_model (current_column->priv->tree_view,
-                           current_column->priv->filter);
+                           column_get_view_model (current_column));
 
-  g_signal_connect (model, "row-changed",
-                    G_CALLBACK (on_row_changed), selector);
-  g_signal_connect_after (model, "row-deleted",
-                          G_CALLBACK (on_row_deleted), selector);
+  model_columns_add (selector, current_column);
 }
 
 /**
@@ -2551,7 +3265,7 @@ _hildon_touch_selector_center_on_selected_items (HildonTouchSelector *selector,
   GList *selected_rows = NULL;
   gint num_column = -1;
 
-  num_column = g_slist_index (selector->priv->columns, column);
+  num_column = column->priv->index;
 
   selected_rows = hildon_touch_selector_get_selected_rows (selector, num_column);
   if (selected_rows) {
@@ -2635,7 +3349,7 @@ hildon_touch_selector_get_column (HildonTouchSelector * selector,
   num_columns = hildon_touch_selector_get_num_columns (selector);
   g_return_val_if_fail (column < num_columns && column >= 0, NULL);
 
-  return g_slist_nth_data (selector->priv->columns, column);
+  return g_ptr_array_index (selector->priv->columns, column);
 }
 
 
@@ -2667,16 +3381,73 @@ hildon_touch_selector_get_column (HildonTouchSelector * selector,
 void
 hildon_touch_selector_center_on_selected         (HildonTouchSelector *selector)
 {
-  GSList *iter = NULL;
+  guint i;
 
   g_return_if_fail (HILDON_IS_TOUCH_SELECTOR (selector));
 
-  for (iter = selector->priv->columns; iter; iter = g_slist_next (iter)) {
+  hildon_touch_selector_build_columns (selector);
+
+  for (i = 0; i < selector->priv->columns->len; i++) {
     _hildon_touch_selector_center_on_selected_items (selector,
-                                                    HILDON_TOUCH_SELECTOR_COLUMN (iter->data));
+                                                    g_ptr_array_index (selector->priv->columns, i));
   }
 }
 
+/* Columns with more rows than this are not measured, their height is
+   estimated from a sample of OPTIMAL_SIZE_SAMPLE_ROWS rows instead */
+#define OPTIMAL_SIZE_EXACT_ROWS                         64
+#define OPTIMAL_SIZE_SAMPLE_ROWS                        16
+
+static gint
+hildon_touch_selector_column_get_optimal_height (HildonTouchSelectorColumn *column)
+{
+  GtkTreeModel *model = column_get_view_model (column);
+  GtkTreeView *tv = column->priv->tree_view;
+  GtkTreeViewColumn *tree_column;
+  gint n_rows, n_samples, i;
+  gint row_height = 0;
+  gint separator = 0;
+
+  n_rows = gtk_tree_model_iter_n_children (model, NULL);
+  tree_column = gtk_tree_view_get_column (tv, 0);
+
+  if (n_rows <= OPTIMAL_SIZE_EXACT_ROWS || tree_column == NULL) {
+    GtkRequisition child_requisition = {0};
+
+    /* Cheap enough to measure every row */
+    gtk_widget_get_preferred_size (GTK_WIDGET (tv), &child_requisition, NULL);
+
+    return child_requisition.height;
+  }
+
+  if (n_rows == column->priv->estimated_rows)
+    return column->priv->estimated_height;
+
+  gtk_widget_style_get (GTK_WIDGET (tv), "vertical-separator", &separator, NULL);
+
+  /* All the rows have the same height in fixed height mode, otherwise
+     take the tallest of rows spread evenly over the model */
+  n_samples = gtk_tree_view_get_fixed_height_mode (tv) ? 1 : OPTIMAL_SIZE_SAMPLE_ROWS;
+
+  for (i = 0; i < n_samples; i++) {
+    GtkTreeIter iter;
+    gint cell_height = 0;
+
+    if (!gtk_tree_model_iter_nth_child (model, &iter, NULL,
+                                        (gint) ((gint64) i * n_rows / n_samples)))
+      continue;
+
+    gtk_tree_view_column_cell_set_cell_data (tree_column, model, &iter, FALSE, FALSE);
+    gtk_tree_view_column_cell_get_size (tree_column, NULL, NULL, NULL, NULL, &cell_height);
+    row_height = MAX (row_height, cell_height);
+  }
+
+  column->priv->estimated_rows = n_rows;
+  column->priv->estimated_height = n_rows * (row_height + separator);
+
+  return column->priv->estimated_height;
+}
+
 /**
  * hildon_touch_selector_optimal_size_request
  * @selector: a #HildonTouchSelector
@@ -2698,26 +3469,30 @@ hildon_touch_selector_center_on_selected         (HildonTouchSelector *selector)
  * gtk_widget_size_request() has been called since the last time a resize was
  * queued.
  *
+ * Columns with many rows are not measured row by row. Their height is
+ * estimated from a sample of their rows, and the estimate is kept
+ * until the number of rows of the column changes.
+ *
  * Since: 2.2
  **/
 void
 hildon_touch_selector_optimal_size_request      (HildonTouchSelector *selector,
                                                  GtkRequisition *requisition)
 {
-  GSList *iter = NULL;
+  guint i;
   gint height = 0;
   gint base_height = 0;
 
   g_return_if_fail (HILDON_IS_TOUCH_SELECTOR (selector));
 
-  iter = selector->priv->columns;
+  hildon_touch_selector_build_columns (selector);
 
   /* Default optimal values are the current ones */
   gtk_widget_get_preferred_size (GTK_WIDGET (selector),
                                  requisition,
                                  NULL);
 
-  if (iter == NULL) {
+  if (selector->priv->columns->len == 0) {
     height = requisition->height;
   } else {
     /* we use the normal requisition as base, as the touch selector can has
@@ -2726,19 +3501,12 @@ hildon_touch_selector_optimal_size_request      (HildonTouchSelector *selector,
   }
 
   /* Compute optimal height for the columns */
-  while (iter) {
+  for (i = 0; i < selector->priv->columns->len; i++) {
     HildonTouchSelectorColumn *column;
-    GtkWidget *child;
-    GtkRequisition child_requisition = {0};
-
-    column = HILDON_TOUCH_SELECTOR_COLUMN (iter->data);
-    child = GTK_WIDGET (column->priv->tree_view);
-
-    gtk_widget_get_preferred_size (child, &child_requisition, NULL);
 
-    height = MAX (height, child_requisition.height);
+    column = g_ptr_array_index (selector->priv->columns, i);
 
-    iter = g_slist_next (iter);
+    height = MAX (height, hildon_touch_selector_column_get_optimal_height (column));
   }
 
   requisition->height = base_height + height;
@@ -2785,7 +3553,7 @@ hildon_touch_selector_set_hildon_ui_mode        (HildonTouchSelector *selector,
                                                  HildonUIMode         mode)
 {
   gint num = 0;
-  GSList *iter = NULL;
+  guint i;
   HildonTouchSelectorColumn *column = NULL;
   GtkTreeView *tree_view = NULL;
 
@@ -2797,8 +3565,8 @@ hildon_touch_selector_set_hildon_ui_mode        (HildonTouchSelector *selector,
     return FALSE;
   }
 
-  for (iter = selector->priv->columns; iter; iter = g_slist_next (iter)) {
-    column = HILDON_TOUCH_SELECTOR_COLUMN (iter->data);
+  for (i = 0; i < selector->priv->columns->len; i++) {
+    column = g_ptr_array_index (selector->priv->columns, i);
     tree_view = column->priv->tree_view;
 
     hildon_tree_view_set_hildon_ui_mode (tree_view, mode);
@@ -2891,7 +3659,7 @@ hildon_touch_selector_center_on_index (HildonTouchSelector *selector,
   g_return_if_fail ((column >= 0) && (column < hildon_touch_selector_get_num_columns (selector)));
   g_return_if_fail (index >= 0);
 
-  current_column = g_slist_nth_data (selector->priv->columns, column);
+  current_column = g_ptr_array_index (selector->priv->columns, column);
 
   path = gtk_tree_path_new_from_indices (index, -1);
 
@@ -2930,10 +3698,9 @@ hildon_touch_selector_set_live_search (HildonTouchSelector *selector,
     return;
 
   if (live_search) {
-    if (selector->priv->columns &&
-        selector->priv->columns->next == NULL) {
+    if (selector->priv->columns->len == 1) {
       /* There is one and only one column already.  */
-      col = (HildonTouchSelectorColumn *) selector->priv->columns->data;
+      col = g_ptr_array_index (selector->priv->columns, 0);
       /* There is already a livesearch widget. Let's hook it up.  */
       if (col->priv->livesearch) {
         hildon_live_search_widget_hook (HILDON_LIVE_SEARCH (col->priv->livesearch),
@@ -2943,16 +3710,14 @@ hildon_touch_selector_set_live_search (HildonTouchSelector *selector,
         /* There is no livesearch widget yet. Create one.  */
         hildon_touch_selector_add_live_search (selector, col);
       }
-    } else if (selector->priv->columns &&
-               selector->priv->columns->next != NULL) {
+    } else if (selector->priv->columns->len > 1) {
       g_critical ("Trying to set HildonTouchSelector::live-search to TRUE "
                   "in a HildonTouchSelector instance with more than one column.");
       return;
     }
   } else {
-    if (selector->priv->columns &&
-        selector->priv->columns->next == NULL) {
-        col = (HildonTouchSelectorColumn *) selector->priv->columns->data;
+    if (selector->priv->columns->len == 1) {
+        col = g_ptr_array_index (selector->priv->columns, 0);
         gtk_widget_hide (col->priv->livesearch);
         hildon_live_search_widget_unhook (HILDON_LIVE_SEARCH (col->priv->livesearch));
     }
@@ -56,6 +56,11 @@ typedef struct                                  _HildonTouchSelectorPrivate Hild
 typedef gchar *(*HildonTouchSelectorPrintFunc)  (HildonTouchSelector * selector,
                                                  gpointer user_data);
 
+#define                                         HILDON_TYPE_TOUCH_SELECTOR_SNAPSHOT \
+                                                (hildon_touch_selector_snapshot_get_type ())
+
+typedef struct                                  _HildonTouchSelectorSnapshot HildonTouchSelectorSnapshot;
+
 struct                                          _HildonTouchSelector
 {
   GtkBox parent_instance;
@@ -181,6 +186,50 @@ void
 hildon_touch_selector_unselect_all              (HildonTouchSelector * selector,
                                                  gint                  column);
 
+void
+hildon_touch_selector_select_paths              (HildonTouchSelector *selector,
+                                                 gint                 column,
+                                                 GList               *paths);
+
+void
+hildon_touch_selector_begin_update              (HildonTouchSelector *selector);
+
+void
+hildon_touch_selector_end_update                (HildonTouchSelector *selector);
+
+GType
+hildon_touch_selector_snapshot_get_type         (void) G_GNUC_CONST;
+
+HildonTouchSelectorSnapshot *
+hildon_touch_selector_snapshot_new              (gint n_columns);
+
+HildonTouchSelectorSnapshot *
+hildon_touch_selector_snapshot_copy             (const HildonTouchSelectorSnapshot *snapshot);
+
+void
+hildon_touch_selector_snapshot_free             (HildonTouchSelectorSnapshot *snapshot);
+
+gint
+hildon_touch_selector_snapshot_get_n_columns    (const HildonTouchSelectorSnapshot *snapshot);
+
+const gint *
+hildon_touch_selector_snapshot_get_rows         (const HildonTouchSelectorSnapshot *snapshot,
+                                                 gint                               column,
+                                                 gint                              *n_rows);
+
+void
+hildon_touch_selector_snapshot_set_rows         (HildonTouchSelectorSnapshot *snapshot,
+                                                 gint                         column,
+                                                 const gint                  *rows,
+                                                 gint                         n_rows);
+
+HildonTouchSelectorSnapshot *
+hildon_touch_selector_take_snapshot             (HildonTouchSelector *selector);
+
+gboolean
+hildon_touch_selector_restore_snapshot          (HildonTouchSelector               *selector,
+                                                 const HildonTouchSelectorSnapshot *snapshot);
+
 GList *
 hildon_touch_selector_get_selected_rows         (HildonTouchSelector *selector,
                                                  gint                 column);
@@ -210,6 +259,13 @@ hildon_touch_selector_set_print_func_full       (HildonTouchSelector          *s
 HildonTouchSelectorPrintFunc
 hildon_touch_selector_get_print_func            (HildonTouchSelector *selector);
 
+void
+hildon_touch_selector_set_max_printed_items     (HildonTouchSelector *selector,
+                                                 gint                 max_items);
+
+gint
+hildon_touch_selector_get_max_printed_items     (HildonTouchSelector *selector);
+
 gboolean
 hildon_touch_selector_has_multiple_selection    (HildonTouchSelector *selector);
 
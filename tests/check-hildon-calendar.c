@@ -0,0 +1,196 @@
+/*
+ * This file is a part of hildon tests
+ *
+ * Copyright (C) 2009 Nokia Corporation, all rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include <stdlib.h>
+#include <check.h>
+#include "test_suites.h"
+#include "check_utils.h"
+#include <hildon/hildon.h>
+
+#define N_MARKED_DAYS 40
+
+static HildonCalendar *calendar = NULL;
+static GtkWindow *window = NULL;
+
+static void
+fx_setup ()
+{
+    int argc = 0;
+
+    gtk_init (&argc, NULL);
+
+    window = GTK_WINDOW (hildon_window_new ());
+    calendar = HILDON_CALENDAR (hildon_calendar_new ());
+
+    fail_if (!HILDON_IS_CALENDAR (calendar),
+             "hildon-calendar: Creation failed.");
+
+    /* January 2010 */
+    hildon_calendar_select_month (calendar, 0, 2010);
+
+    gtk_container_add (GTK_CONTAINER (window), GTK_WIDGET (calendar));
+    show_test_window (GTK_WIDGET (window));
+}
+
+static void
+fx_teardown ()
+{
+    gtk_widget_destroy (GTK_WIDGET (window));
+}
+
+static guint32
+julian_day (guint day, guint month, guint year)
+{
+    GDate date;
+
+    g_date_clear (&date, 1);
+    g_date_set_dmy (&date, day, month, year);
+
+    return g_date_get_julian (&date);
+}
+
+/**
+   Purpose: test marking dates by Julian day.
+
+   Checks for:
+
+   - Every day of a range longer than 32 days is marked, and the days
+     around it are not.
+   - Unmarking the days on both sides of a 32-day boundary only
+     unmarks those.
+   - The marks stay on their dates when the month shown changes.
+   - Clearing the Julian marks removes all of them.
+
+*/
+START_TEST (test_hildon_calendar_julian_marks)
+{
+    guint32 days[N_MARKED_DAYS];
+    guint32 first, boundary;
+    guint32 around[2];
+    gint i;
+
+    /* From 20 January to 28 February 2010 */
+    first = julian_day (20, G_DATE_JANUARY, 2010);
+    for (i = 0; i < N_MARKED_DAYS; i++)
+        days[i] = first + i;
+
+    /* Test 1: marking the range. */
+    hildon_calendar_mark_julian_days (calendar, days, N_MARKED_DAYS);
+    for (i = 0; i < N_MARKED_DAYS; i++)
+        fail_if (!hildon_calendar_get_julian_day_is_marked (calendar, days[i]),
+                 "hildon-calendar: day %d of the marked range is not marked", i);
+    fail_if (hildon_calendar_get_julian_day_is_marked (calendar, first - 1) ||
+             hildon_calendar_get_julian_day_is_marked (calendar, first + N_MARKED_DAYS),
+             "hildon-calendar: a day out of the marked range is marked");
+
+    /* Test 2: unmarking across a 32-day boundary. */
+    boundary = (first / 32 + 1) * 32;
+    fail_if (boundary <= first || boundary >= first + N_MARKED_DAYS - 1,
+             "hildon-calendar: the marked range does not cross a 32-day boundary");
+    around[0] = boundary - 1;
+    around[1] = boundary;
+    hildon_calendar_unmark_julian_days (calendar, around, 2);
+    for (i = 0; i < N_MARKED_DAYS; i++) {
+        gboolean unmarked = (days[i] == around[0] || days[i] == around[1]);
+
+        fail_if (hildon_calendar_get_julian_day_is_marked (calendar, days[i]) == unmarked,
+                 "hildon-calendar: day %d of the range is %s after unmarking "
+                 "days %u and %u", i, unmarked ? "marked" : "not marked",
+                 around[0], around[1]);
+    }
+
+    /* Test 3: changing the month shown. */
+    hildon_calendar_select_month (calendar, 1, 2010);
+    fail_if (!hildon_calendar_get_julian_day_is_marked (calendar,
+                                                        julian_day (28, G_DATE_FEBRUARY, 2010)),
+             "hildon-calendar: 28 February is not marked after showing February");
+    hildon_calendar_select_month (calendar, 0, 2010);
+    fail_if (!hildon_calendar_get_julian_day_is_marked (calendar, first),
+             "hildon-calendar: 20 January is not marked after showing January again");
+
+    /* Test 4: clearing the marks. */
+    hildon_calendar_clear_julian_marks (calendar);
+    for (i = 0; i < N_MARKED_DAYS; i++)
+        fail_if (hildon_calendar_get_julian_day_is_marked (calendar, days[i]),
+                 "hildon-calendar: day %d of the range is still marked "
+                 "after clearing the marks", i);
+}
+END_TEST
+
+/**
+   Purpose: test that marks set by Julian day and marks set by day
+   number are kept apart.
+
+   Checks for:
+
+   - A Julian mark is not reported by hildon_calendar_get_day_is_marked().
+   - A day number mark is not reported by hildon_calendar_get_julian_day_is_marked().
+   - Clearing the Julian marks keeps the day number marks, and the
+     other way round.
+
+*/
+START_TEST (test_hildon_calendar_julian_day_marks)
+{
+    guint32 day = julian_day (10, G_DATE_JANUARY, 2010);
+
+    hildon_calendar_mark_julian_days (calendar, &day, 1);
+    hildon_calendar_mark_day (calendar, 5);
+
+    /* Test 1: Julian marks and day numbers. */
+    fail_if (hildon_calendar_get_day_is_marked (calendar, 10),
+             "hildon-calendar: a Julian mark is reported as a day number mark");
+    fail_if (!hildon_calendar_get_day_is_marked (calendar, 5),
+             "hildon-calendar: day 5 is not marked");
+
+    /* Test 2: day numbers and Julian marks. */
+    fail_if (hildon_calendar_get_julian_day_is_marked (calendar,
+                                                       julian_day (5, G_DATE_JANUARY, 2010)),
+             "hildon-calendar: a day number mark is reported as a Julian mark");
+
+    /* Test 3: clearing one kind of marks. */
+    hildon_calendar_clear_julian_marks (calendar);
+    fail_if (!hildon_calendar_get_day_is_marked (calendar, 5),
+             "hildon-calendar: clearing the Julian marks unmarked day 5");
+
+    hildon_calendar_mark_julian_days (calendar, &day, 1);
+    hildon_calendar_clear_marks (calendar);
+    fail_if (!hildon_calendar_get_julian_day_is_marked (calendar, day),
+             "hildon-calendar: clearing the day number marks removed a Julian mark");
+    fail_if (hildon_calendar_get_day_is_marked (calendar, 5),
+             "hildon-calendar: day 5 is still marked after clearing the marks");
+}
+END_TEST
+
+/* ---------- Suite creation ---------- */
+
+Suite *create_hildon_calendar_suite (void)
+{
+    Suite *s = suite_create ("HildonCalendar");
+
+    TCase *tc1 = tcase_create ("hildon_calendar_julian_marks");
+    tcase_add_checked_fixture (tc1, fx_setup, fx_teardown);
+    tcase_add_test (tc1, test_hildon_calendar_julian_marks);
+    tcase_add_test (tc1, test_hildon_calendar_julian_day_marks);
+    suite_add_tcase (s, tc1);
+
+    return s;
+}
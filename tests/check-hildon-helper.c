@@ -159,6 +159,169 @@ START_TEST (test_hildon_helper_set_logical_color_invalid)
 }
 END_TEST
 
+/* ----- Test case for hildon_helper_smart_match -----*/
+
+/**
+ * Purpose: test matching at word starts
+ * Cases considered:
+ *    - Match at the start of the haystack and after separators
+ *    - No match inside a word
+ *    - Case insensitive matching
+ *    - Matches past the first 16 bytes of the haystack
+ *    - Needles starting with a separator
+ */
+START_TEST (test_hildon_helper_smart_match_regular)
+{
+  const gchar *haystack;
+
+  haystack = "Abasto";
+  fail_if (hildon_helper_smart_match (haystack, "aba") != haystack,
+           "hildon-helper: \"aba\" should match the start of \"Abasto\"");
+
+  fail_if (hildon_helper_smart_match ("Moraba", "aba") != NULL,
+           "hildon-helper: \"aba\" should not match inside \"Moraba\"");
+
+  haystack = "A tool (abacus)";
+  fail_if (hildon_helper_smart_match (haystack, "ABA") != haystack + 8,
+           "hildon-helper: \"ABA\" should match \"abacus\"");
+
+  haystack = "The quick brown fox jumps over the lazy dog";
+  fail_if (hildon_helper_smart_match (haystack, "lazy") != haystack + 35,
+           "hildon-helper: \"lazy\" should match after 16 bytes");
+  fail_if (hildon_helper_smart_match (haystack, "azy") != NULL,
+           "hildon-helper: \"azy\" should not match inside \"lazy\"");
+  fail_if (hildon_helper_smart_match (haystack, "dogs") != NULL,
+           "hildon-helper: \"dogs\" should not match past the end");
+
+  haystack = "see: (notes)";
+  fail_if (hildon_helper_smart_match (haystack, "(no") != haystack + 5,
+           "hildon-helper: \"(no\" should match anywhere");
+}
+END_TEST
+
+/**
+ * Purpose: test matching with invalid parameters
+ * Cases considered:
+ *    - NULL haystack or needle
+ *    - Empty haystack
+ */
+START_TEST (test_hildon_helper_smart_match_invalid)
+{
+  fail_if (hildon_helper_smart_match (NULL, "a") != NULL,
+           "hildon-helper: a NULL haystack should not match");
+  fail_if (hildon_helper_smart_match ("a", NULL) != NULL,
+           "hildon-helper: a NULL needle should not match");
+  fail_if (hildon_helper_smart_match ("", "a") != NULL,
+           "hildon-helper: an empty haystack should not match");
+}
+END_TEST
+
+/* ----- Test case for hildon_helper_utf8_strstrcasedecomp_needle_stripped -----*/
+
+/**
+ * Purpose: test matching a stripped needle
+ * Cases considered:
+ *    - Accents and case are ignored in the haystack
+ *    - No match inside a word
+ *    - Match after a non-ASCII word
+ */
+START_TEST (test_hildon_helper_strstrcasedecomp_regular)
+{
+  gunichar *needle;
+  const gchar *haystack;
+
+  needle = hildon_helper_strip_string ("Ele");
+
+  haystack = "\xc3\x89l\xc3\xa9phant";
+  fail_if (hildon_helper_utf8_strstrcasedecomp_needle_stripped (haystack, needle) != haystack,
+           "hildon-helper: \"ele\" should match \"\xc3\x89l\xc3\xa9phant\"");
+
+  fail_if (hildon_helper_utf8_strstrcasedecomp_needle_stripped ("Vele", needle) != NULL,
+           "hildon-helper: \"ele\" should not match inside \"Vele\"");
+
+  haystack = "\xc3\x85ngstr\xc3\xb6m elephant";
+  fail_if (hildon_helper_utf8_strstrcasedecomp_needle_stripped (haystack, needle) != haystack + 11,
+           "hildon-helper: \"ele\" should match the second word");
+
+  g_free (needle);
+}
+END_TEST
+
+/* ----- Test case for HildonMatcher -----*/
+
+/**
+ * Purpose: test matching with a prepared needle
+ * Cases considered:
+ *    - Match at word starts, ignoring case and accents
+ *    - Match offsets of the first word
+ *    - Every word of a split needle must match
+ *    - Offsets of every word, sorted by position
+ *    - Matching only at the start of the haystack
+ *    - Matching many haystacks at once
+ */
+START_TEST (test_hildon_matcher_regular)
+{
+  const gchar *haystacks[] = { "Vele", "Big \xc3\x89l\xc3\xa9phant", NULL,
+                               "(eleven)" };
+  HildonMatcher *matcher;
+  GArray *ranges;
+  gint start, end;
+
+  matcher = hildon_matcher_new ("ele", HILDON_MATCHER_FLAGS_NONE);
+  fail_if (!hildon_matcher_match (matcher, "Big \xc3\x89l\xc3\xa9phant", &start, &end),
+           "hildon-matcher: \"ele\" should match \"\xc3\x89l\xc3\xa9phant\"");
+  fail_if (start != 4 || end != 9,
+           "hildon-matcher: the match should span bytes 4 to 9, not %d to %d",
+           start, end);
+  fail_if (hildon_matcher_match (matcher, "Vele", NULL, NULL),
+           "hildon-matcher: \"ele\" should not match inside \"Vele\"");
+  hildon_matcher_unref (matcher);
+
+  matcher = hildon_matcher_new ("smi jo", HILDON_MATCHER_SPLIT_WORDS);
+  fail_if (!hildon_matcher_match (matcher, "John Smith", NULL, NULL),
+           "hildon-matcher: \"smi jo\" should match \"John Smith\"");
+  fail_if (hildon_matcher_match (matcher, "John Doe", NULL, NULL),
+           "hildon-matcher: \"smi jo\" should not match \"John Doe\"");
+
+  ranges = hildon_matcher_match_words (matcher, "John Smith");
+  fail_if (ranges == NULL || ranges->len != 2,
+           "hildon-matcher: there should be one range per word");
+  fail_if (g_array_index (ranges, HildonMatchRange, 0).start != 0 ||
+           g_array_index (ranges, HildonMatchRange, 0).end != 2 ||
+           g_array_index (ranges, HildonMatchRange, 1).start != 5 ||
+           g_array_index (ranges, HildonMatchRange, 1).end != 8,
+           "hildon-matcher: the ranges should be sorted by position");
+  g_array_unref (ranges);
+  hildon_matcher_unref (matcher);
+
+  matcher = hildon_matcher_new ("new y", HILDON_MATCHER_STRING_PREFIX);
+  fail_if (!hildon_matcher_match (matcher, "New York", NULL, NULL),
+           "hildon-matcher: \"new y\" should be a prefix of \"New York\"");
+  fail_if (hildon_matcher_match (matcher, "Brand New York", NULL, NULL),
+           "hildon-matcher: \"new y\" should only match at the start");
+  hildon_matcher_unref (matcher);
+
+  matcher = hildon_matcher_new ("", HILDON_MATCHER_SPLIT_WORDS);
+  fail_if (!hildon_matcher_match (matcher, "anything", NULL, NULL),
+           "hildon-matcher: an empty needle should match everything");
+  hildon_matcher_unref (matcher);
+
+  matcher = hildon_matcher_new ("ele", HILDON_MATCHER_FLAGS_NONE);
+  ranges = hildon_matcher_match_all (matcher, haystacks, 4);
+  fail_if (ranges == NULL || ranges->len != 4,
+           "hildon-matcher: there should be one range per haystack");
+  fail_if (g_array_index (ranges, HildonMatchRange, 0).start != -1 ||
+           g_array_index (ranges, HildonMatchRange, 2).start != -1,
+           "hildon-matcher: haystacks that do not match should get -1");
+  fail_if (g_array_index (ranges, HildonMatchRange, 1).start != 4 ||
+           g_array_index (ranges, HildonMatchRange, 1).end != 9 ||
+           g_array_index (ranges, HildonMatchRange, 3).start != 1 ||
+           g_array_index (ranges, HildonMatchRange, 3).end != 4,
+           "hildon-matcher: wrong offsets for the matching haystacks");
+  g_array_unref (ranges);
+  hildon_matcher_unref (matcher);
+}
+END_TEST
 
 
 /* ---------- Suite creation ---------- */
@@ -171,6 +334,9 @@ Suite *create_hildon_helper_suite()
   /* Create test cases */
   TCase *tc1 = tcase_create("hildon_helper_set_logical_font");
   TCase *tc2 = tcase_create("hildon_helper_set_logical_color");
+  TCase *tc3 = tcase_create("hildon_helper_smart_match");
+  TCase *tc4 = tcase_create("hildon_helper_utf8_strstrcasedecomp_needle_stripped");
+  TCase *tc5 = tcase_create("hildon_matcher");
 
   /* Create test case for set_logical_font and add it to the suite */
   tcase_add_checked_fixture(tc1, fx_setup_default_helper, fx_teardown_default_helper);
@@ -184,6 +350,22 @@ Suite *create_hildon_helper_suite()
   tcase_add_test(tc2, test_hildon_helper_set_logical_color_invalid);
   suite_add_tcase (s, tc2);
 
+  /* Create test case for smart_match and add it to the suite */
+  tcase_add_checked_fixture(tc3, fx_setup_default_helper, fx_teardown_default_helper);
+  tcase_add_test(tc3, test_hildon_helper_smart_match_regular);
+  tcase_add_test(tc3, test_hildon_helper_smart_match_invalid);
+  suite_add_tcase (s, tc3);
+
+  /* Create test case for strstrcasedecomp and add it to the suite */
+  tcase_add_checked_fixture(tc4, fx_setup_default_helper, fx_teardown_default_helper);
+  tcase_add_test(tc4, test_hildon_helper_strstrcasedecomp_regular);
+  suite_add_tcase (s, tc4);
+
+  /* Create test case for HildonMatcher and add it to the suite */
+  tcase_add_checked_fixture(tc5, fx_setup_default_helper, fx_teardown_default_helper);
+  tcase_add_test(tc5, test_hildon_matcher_regular);
+  suite_add_tcase (s, tc5);
+
   /* Return created suite */
   return s;             
 }
@@ -0,0 +1,319 @@
+/*
+ * This file is a part of hildon tests
+ *
+ * Copyright (C) 2009 Nokia Corporation, all rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+#include "test_suites.h"
+#include "check_utils.h"
+#include <hildon/hildon.h>
+
+static HildonLiveSearch *livesearch = NULL;
+static GtkListStore *store = NULL;
+static GtkTreeModel *filter = NULL;
+
+static gint n_refilters = 0;
+
+static const gchar *rows[] = {
+    "apple", "banana", "apricot", "cherry", "avocado", "apple pie", NULL
+};
+
+static gboolean
+on_refilter (HildonLiveSearch *search,
+             gpointer          data)
+{
+    n_refilters++;
+
+    return FALSE;
+}
+
+static void
+fx_setup ()
+{
+    int argc = 0;
+
+    gtk_init (&argc, NULL);
+
+    store = gtk_list_store_new (1, G_TYPE_STRING);
+    fill_store ();
+
+    filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (store), NULL);
+
+    livesearch = HILDON_LIVE_SEARCH (hildon_live_search_new ());
+    g_object_ref_sink (livesearch);
+
+    hildon_live_search_set_filter (livesearch, GTK_TREE_MODEL_FILTER (filter));
+    hildon_live_search_set_text_column (livesearch, 0);
+    hildon_live_search_set_indexed (livesearch, TRUE);
+
+    n_refilters = 0;
+    g_signal_connect (livesearch, "refilter", G_CALLBACK (on_refilter), NULL);
+}
+
+static void
+fx_teardown ()
+{
+    gtk_widget_destroy (GTK_WIDGET (livesearch));
+    g_object_unref (livesearch);
+    g_object_unref (filter);
+    g_object_unref (store);
+}
+
+static gint
+count_visible_rows (void)
+{
+    return gtk_tree_model_iter_n_children (filter, NULL);
+}
+
+/* Spins the main loop until the filter is refiltered, which threaded
+   filtering only does once the worker thread is done */
+static gboolean
+wait_for_refilter (void)
+{
+    gint n = n_refilters;
+    gint64 end = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+
+    while (n_refilters == n && g_get_monotonic_time () < end) {
+        if (!g_main_context_iteration (NULL, FALSE))
+            g_usleep (1000);
+    }
+
+    return n_refilters != n;
+}
+
+static void
+fill_store (void)
+{
+    gint i;
+
+    for (i = 0; rows[i] != NULL; i++)
+        gtk_list_store_insert_with_values (store, NULL, -1, 0, rows[i], -1);
+}
+
+/**
+   Purpose: test that indexed filtering of a #GtkListStore shows the
+   rows starting with the text, also after the model changes.
+
+   Checks for:
+
+   - Filtering shows every row starting with the text.
+   - Narrowing the text only keeps the matching rows.
+   - Rows inserted, changed and removed after the index is built are
+     filtered like the other ones.
+   - Clearing the text shows every row again.
+
+*/
+START_TEST (test_hildon_live_search_indexed)
+{
+    GtkTreeIter iter;
+    gint n_rows;
+
+    /* Test 1: filtering with a prefix. */
+    hildon_live_search_set_text (livesearch, "ap");
+    n_rows = count_visible_rows ();
+    fail_if (n_rows != 3,
+             "hildon-live-search: %d rows start with `ap' instead of 3",
+             n_rows);
+
+    /* Test 2: narrowing the prefix. */
+    hildon_live_search_set_text (livesearch, "appl");
+    n_rows = count_visible_rows ();
+    fail_if (n_rows != 2,
+             "hildon-live-search: %d rows start with `appl' instead of 2",
+             n_rows);
+
+    /* Test 3: rows inserted and changed after indexing. */
+    gtk_list_store_insert_with_values (store, &iter, 0, 0, "applet", -1);
+    gtk_list_store_append (store, &iter);
+    gtk_list_store_set (store, &iter, 0, "application", -1);
+    hildon_live_search_set_text (livesearch, "ap");
+    n_rows = count_visible_rows ();
+    fail_if (n_rows != 5,
+             "hildon-live-search: %d rows start with `ap' after inserting "
+             "two matching rows, instead of 5", n_rows);
+
+    gtk_list_store_set (store, &iter, 0, "banana split", -1);
+    hildon_live_search_set_text (livesearch, "b");
+    n_rows = count_visible_rows ();
+    fail_if (n_rows != 2,
+             "hildon-live-search: %d rows start with `b' after changing "
+             "a row, instead of 2", n_rows);
+
+    /* Test 4: removed rows. */
+    gtk_list_store_remove (store, &iter);
+    n_rows = count_visible_rows ();
+    fail_if (n_rows != 1,
+             "hildon-live-search: %d rows start with `b' after removing "
+             "a row, instead of 1", n_rows);
+
+    /* Test 5: clearing the text. */
+    hildon_live_search_set_text (livesearch, "");
+    n_rows = count_visible_rows ();
+    fail_if (n_rows != 7,
+             "hildon-live-search: %d rows visible without text instead of 7",
+             n_rows);
+}
+END_TEST
+
+/**
+   Purpose: test that the default and the indexed filtering match the
+   same rows, comparing the text after Unicode normalization.
+
+   Checks for:
+
+   - Without index, composed and decomposed forms of the same text
+     match.
+   - With index, the same rows match.
+
+*/
+START_TEST (test_hildon_live_search_normalized)
+{
+    gint n_rows;
+
+    /* Composed and decomposed forms of the same text */
+    gtk_list_store_insert_with_values (store, NULL, -1, 0, "caf\xc3\xa9", -1);
+    gtk_list_store_insert_with_values (store, NULL, -1, 0, "cafe\xcc\x81 au lait", -1);
+
+    /* Test 1: default filtering. */
+    hildon_live_search_set_indexed (livesearch, FALSE);
+    hildon_live_search_set_text (livesearch, "cafe\xcc\x81");
+    n_rows = count_visible_rows ();
+    fail_if (n_rows != 2,
+             "hildon-live-search: %d rows start with `caf\xc3\xa9' "
+             "without index instead of 2", n_rows);
+
+    /* Test 2: indexed filtering. */
+    hildon_live_search_set_text (livesearch, "");
+    hildon_live_search_set_indexed (livesearch, TRUE);
+    hildon_live_search_set_text (livesearch, "cafe\xcc\x81");
+    n_rows = count_visible_rows ();
+    fail_if (n_rows != 2,
+             "hildon-live-search: %d rows start with `caf\xc3\xa9' "
+             "with index instead of 2", n_rows);
+}
+END_TEST
+
+/**
+   Purpose: test that threaded filtering, driven by typing in the
+   entry, shows the rows starting with the text once the worker
+   thread is done, comparing the text after Unicode normalization.
+
+   Checks for:
+
+   - Typing filters the model in the background, and refilters it
+     when the result is ready.
+   - Composed and decomposed forms of the same text match.
+   - Rows inserted afterwards are filtered the same way.
+
+*/
+START_TEST (test_hildon_live_search_threaded)
+{
+    gint n_rows;
+
+    hildon_live_search_set_indexed (livesearch, FALSE);
+    hildon_live_search_set_threaded (livesearch, TRUE);
+
+    /* Test 1: typing a prefix. */
+    hildon_live_search_append_text (livesearch, "ap");
+    fail_if (!wait_for_refilter (),
+             "hildon-live-search: typing `ap' never refiltered the model");
+    n_rows = count_visible_rows ();
+    fail_if (n_rows != 3,
+             "hildon-live-search: %d rows start with `ap' instead of 3",
+             n_rows);
+
+    /* Composed and decomposed forms of the same text */
+    gtk_list_store_insert_with_values (store, NULL, -1, 0, "caf\xc3\xa9", -1);
+    gtk_list_store_insert_with_values (store, NULL, -1, 0, "cafe\xcc\x81 au lait", -1);
+
+    /* Test 2: normalized matching in the worker thread. */
+    hildon_live_search_set_text (livesearch, "");
+    hildon_live_search_append_text (livesearch, "caf\xc3\xa9");
+    fail_if (!wait_for_refilter (),
+             "hildon-live-search: typing `caf\xc3\xa9' never refiltered the model");
+    n_rows = count_visible_rows ();
+    fail_if (n_rows != 2,
+             "hildon-live-search: %d rows start with `caf\xc3\xa9' instead of 2",
+             n_rows);
+
+    /* Test 3: rows inserted while filtering */
+    gtk_list_store_insert_with_values (store, NULL, 0, 0, "cafe\xcc\x81s", -1);
+    n_rows = count_visible_rows ();
+    fail_if (n_rows != 3,
+             "hildon-live-search: %d rows start with `caf\xc3\xa9' after "
+             "inserting a matching row, instead of 3", n_rows);
+}
+END_TEST
+
+/**
+   Purpose: test that threaded filtering works when the model is
+   empty at the first keystroke and filled afterwards.
+
+   Checks for:
+
+   - Typing in front of an empty model refilters it.
+   - Typing again once the model is filled shows the matching rows.
+
+*/
+START_TEST (test_hildon_live_search_threaded_empty)
+{
+    gint n_rows;
+
+    hildon_live_search_set_indexed (livesearch, FALSE);
+    hildon_live_search_set_threaded (livesearch, TRUE);
+    gtk_list_store_clear (store);
+
+    /* Test 1: typing with an empty model. */
+    hildon_live_search_append_text (livesearch, "a");
+    fail_if (!wait_for_refilter (),
+             "hildon-live-search: typing in front of an empty model "
+             "never refiltered it");
+    n_rows = count_visible_rows ();
+    fail_if (n_rows != 0,
+             "hildon-live-search: %d rows visible in an empty model", n_rows);
+
+    /* Test 2: typing once the model is filled. */
+    fill_store ();
+    hildon_live_search_append_text (livesearch, "p");
+    fail_if (!wait_for_refilter (),
+             "hildon-live-search: typing `ap' never refiltered the model");
+    n_rows = count_visible_rows ();
+    fail_if (n_rows != 3,
+             "hildon-live-search: %d rows start with `ap' instead of 3",
+             n_rows);
+}
+END_TEST
+
+Suite *create_hildon_live_search_suite (void)
+{
+    Suite *s = suite_create ("HildonLiveSearch");
+
+    TCase *tc1 = tcase_create ("hildon_live_search");
+    tcase_add_checked_fixture (tc1, fx_setup, fx_teardown);
+    tcase_add_test (tc1, test_hildon_live_search_indexed);
+    tcase_add_test (tc1, test_hildon_live_search_normalized);
+    tcase_add_test (tc1, test_hildon_live_search_threaded);
+    tcase_add_test (tc1, test_hildon_live_search_threaded_empty);
+    suite_add_tcase (s, tc1);
+
+    return s;
+}
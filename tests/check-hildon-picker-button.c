@@ -30,6 +30,8 @@
 static HildonButton *button = NULL;
 static HildonTouchSelector *selector = NULL;
 static GtkWindow *window = NULL;
+static gint factory_calls = 0;
+static gint changed_column = -1;
 
 static void
 fx_setup ()
@@ -66,6 +68,45 @@ fx_teardown ()
     gtk_widget_destroy (GTK_WIDGET (window));
 }
 
+static HildonTouchSelector *
+build_selector (HildonPickerButton *picker,
+                gpointer            user_data)
+{
+    HildonTouchSelector *built;
+
+    built = HILDON_TOUCH_SELECTOR (hildon_touch_selector_new_text ());
+    hildon_touch_selector_append_text (built, "Row one");
+    hildon_touch_selector_append_text (built, "Row two");
+    hildon_touch_selector_append_text (built, "Row three");
+    hildon_touch_selector_append_text (built, "Row four");
+
+    factory_calls++;
+
+    return built;
+}
+
+static void
+on_changed (HildonTouchSelector *changed_selector,
+            gint                 column,
+            gpointer             user_data)
+{
+    changed_column = column;
+}
+
+/* Spins the main loop until *@pointer is cleared, for up to 5 seconds */
+static gboolean
+wait_for_clear (gpointer *pointer)
+{
+    gint64 end = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+
+    while (*pointer != NULL && g_get_monotonic_time () < end) {
+        if (!g_main_context_iteration (NULL, FALSE))
+            g_usleep (1000);
+    }
+
+    return *pointer == NULL;
+}
+
 /**
    Purpose: test that programmatic changes in the selector update the
    value displayed in the button.
@@ -110,6 +151,343 @@ START_TEST (test_hildon_picker_button_value)
 }
 END_TEST
 
+/**
+   Purpose: test that a selection snapshot restores the selector and
+   the value displayed in the button.
+
+   Checks for:
+
+   - The snapshot records the index of the selected row.
+   - Restoring the snapshot selects the recorded row again.
+   - A snapshot with a different number of columns is refused.
+
+*/
+START_TEST (test_hildon_picker_button_snapshot)
+{
+    HildonTouchSelectorSnapshot *snapshot, *other;
+    const gint *rows;
+    gint n_rows;
+    const gchar *value;
+
+    hildon_touch_selector_set_active (selector, 0, 2);
+    snapshot = hildon_touch_selector_take_snapshot (selector);
+
+    /* Test 1: contents of the snapshot. */
+    fail_if (hildon_touch_selector_snapshot_get_n_columns (snapshot) != 1,
+             "hildon-picker-button: snapshot has %d columns instead of 1",
+             hildon_touch_selector_snapshot_get_n_columns (snapshot));
+    rows = hildon_touch_selector_snapshot_get_rows (snapshot, 0, &n_rows);
+    fail_if (n_rows != 1 || rows[0] != 2,
+             "hildon-picker-button: snapshot did not record the third row");
+
+    /* Test 2: restoring the snapshot. */
+    hildon_touch_selector_set_active (selector, 0, 0);
+    fail_if (!hildon_touch_selector_restore_snapshot (selector, snapshot),
+             "hildon-picker-button: snapshot could not be restored");
+    fail_if (hildon_touch_selector_get_active (selector, 0) != 2,
+             "hildon-picker-button: restored snapshot selects row %d instead of 2",
+             hildon_touch_selector_get_active (selector, 0));
+    value = hildon_button_get_value (button);
+    fail_if (strcmp (value, "Row three") != 0,
+             "hildon-picker-button: restored the third row in the selector, "
+             "but button displays `%s'.", value);
+
+    /* Test 3: snapshot of another selector. */
+    other = hildon_touch_selector_snapshot_new (2);
+    fail_if (hildon_touch_selector_restore_snapshot (selector, other),
+             "hildon-picker-button: restored a snapshot with 2 columns "
+             "in a selector with 1 column");
+
+    hildon_touch_selector_snapshot_free (other);
+    hildon_touch_selector_snapshot_free (snapshot);
+}
+END_TEST
+
+/**
+   Purpose: test that the selector of a #HildonDateButton, whose
+   columns are only built when needed, can be used as a
+   #HildonTouchSelector before the picker dialog was ever shown.
+
+   Checks for:
+
+   - The selector has the day, month and year columns.
+   - Each column has the date set in the button selected.
+   - Changing the selection updates the date of the button.
+
+*/
+START_TEST (test_hildon_picker_button_date)
+{
+    HildonDateButton *date_button;
+    HildonTouchSelector *date_selector;
+    guint year, month, day;
+    gint n_columns, i;
+
+    date_button = HILDON_DATE_BUTTON (hildon_date_button_new (HILDON_SIZE_AUTO,
+                                                              HILDON_BUTTON_ARRANGEMENT_VERTICAL));
+    g_object_ref_sink (date_button);
+    hildon_date_button_set_date (date_button, 2010, 5, 15);
+
+    /* Test 1: columns of the selector. */
+    date_selector = hildon_picker_button_get_selector (HILDON_PICKER_BUTTON (date_button));
+    n_columns = hildon_touch_selector_get_num_columns (date_selector);
+    fail_if (n_columns != 3,
+             "hildon-picker-button: date selector has %d columns instead of 3",
+             n_columns);
+
+    /* Test 2: selected rows. */
+    for (i = 0; i < n_columns; i++)
+        fail_if (hildon_touch_selector_get_active (date_selector, i) < 0,
+                 "hildon-picker-button: column %d of the date selector "
+                 "has no row selected", i);
+
+    hildon_date_button_get_date (date_button, &year, &month, &day);
+    fail_if (year != 2010 || month != 5 || day != 15,
+             "hildon-picker-button: date selector shows %u-%u-%u "
+             "instead of 2010-5-15", year, month, day);
+
+    /* Test 3: changing the selection. */
+    hildon_date_selector_select_day (HILDON_DATE_SELECTOR (date_selector), 20);
+    hildon_date_button_get_date (date_button, &year, &month, &day);
+    fail_if (day != 20,
+             "hildon-picker-button: selecting day 20 in the date selector "
+             "gives day %u", day);
+
+    gtk_widget_destroy (GTK_WIDGET (date_button));
+    g_object_unref (date_button);
+}
+END_TEST
+
+/**
+   Purpose: test that a selector factory is only called when the
+   selector is needed.
+
+   Checks for:
+
+   - The factory is not called when it is set.
+   - The value set in the button is shown until the selector is built.
+   - Getting the selector builds it once, and keeps it.
+   - Changes in the built selector update the value of the button.
+
+*/
+START_TEST (test_hildon_picker_button_factory)
+{
+    HildonPickerButton *picker = HILDON_PICKER_BUTTON (button);
+    HildonTouchSelector *built;
+    const gchar *value;
+
+    factory_calls = 0;
+    hildon_picker_button_set_selector_factory (picker, build_selector, NULL, NULL);
+    hildon_button_set_value (button, "Row two");
+
+    /* Test 1: the selector is not built yet. */
+    fail_if (factory_calls != 0,
+             "hildon-picker-button: the factory was called %d times "
+             "before the selector was needed", factory_calls);
+    value = hildon_button_get_value (button);
+    fail_if (strcmp (value, "Row two") != 0,
+             "hildon-picker-button: button displays `%s' instead of the "
+             "value set before the selector is built", value);
+
+    /* Test 2: getting the selector builds it once. */
+    built = hildon_picker_button_get_selector (picker);
+    fail_if (!HILDON_IS_TOUCH_SELECTOR (built) || factory_calls != 1,
+             "hildon-picker-button: getting the selector called the "
+             "factory %d times instead of once", factory_calls);
+    fail_if (hildon_picker_button_get_selector (picker) != built ||
+             factory_calls != 1,
+             "hildon-picker-button: the built selector was not kept");
+
+    /* Test 3: changing the selection of the built selector. */
+    hildon_touch_selector_set_active (built, 0, 2);
+    value = hildon_button_get_value (button);
+    fail_if (strcmp (value, "Row three") != 0,
+             "hildon-picker-button: switched to third row in the built "
+             "selector, but button displays `%s'.", value);
+}
+END_TEST
+
+/**
+   Purpose: test that the selector built by a factory is released
+   some time after the dialog is closed, and built again when needed.
+
+   Checks for:
+
+   - Clicking the button shows the built selector in a picker dialog.
+   - The selector is released after the timeout, but not the dialog.
+   - The value of the button is kept after the release.
+   - The rebuilt selector has the same row selected.
+   - Clicking again shows the rebuilt selector in the same dialog.
+
+*/
+START_TEST (test_hildon_picker_button_timeout)
+{
+    HildonPickerButton *picker = HILDON_PICKER_BUTTON (button);
+    HildonTouchSelector *built, *rebuilt;
+    GtkWidget *dialog;
+    gpointer released, kept;
+    const gchar *value;
+
+    factory_calls = 0;
+    hildon_picker_button_set_selector_factory (picker, build_selector, NULL, NULL);
+    hildon_picker_button_set_selector_timeout (picker, 1);
+
+    /* Test 1: clicking the button. */
+    gtk_button_clicked (GTK_BUTTON (button));
+    fail_if (factory_calls != 1,
+             "hildon-picker-button: clicking called the factory %d times "
+             "instead of once", factory_calls);
+    built = hildon_picker_button_get_selector (picker);
+    dialog = gtk_widget_get_toplevel (GTK_WIDGET (built));
+    fail_if (!HILDON_IS_PICKER_DIALOG (dialog),
+             "hildon-picker-button: the built selector is not in a picker dialog");
+
+    hildon_touch_selector_set_active (built, 0, 2);
+    gtk_dialog_response (GTK_DIALOG (dialog), GTK_RESPONSE_OK);
+
+    /* Test 2: releasing the selector. */
+    released = built;
+    g_object_add_weak_pointer (G_OBJECT (built), &released);
+    kept = dialog;
+    g_object_add_weak_pointer (G_OBJECT (dialog), &kept);
+
+    fail_if (!wait_for_clear (&released),
+             "hildon-picker-button: the selector was not released");
+    fail_if (kept == NULL,
+             "hildon-picker-button: the dialog was destroyed with the selector");
+    fail_if (hildon_picker_dialog_get_selector (HILDON_PICKER_DIALOG (dialog)) != NULL,
+             "hildon-picker-button: the dialog still holds the released selector");
+
+    /* Test 3: value of the button. */
+    value = hildon_button_get_value (button);
+    fail_if (strcmp (value, "Row three") != 0,
+             "hildon-picker-button: button displays `%s' after the selector "
+             "was released", value);
+
+    /* Test 4: rebuilding the selector. */
+    rebuilt = hildon_picker_button_get_selector (picker);
+    fail_if (factory_calls != 2,
+             "hildon-picker-button: the factory was called %d times "
+             "instead of twice", factory_calls);
+    fail_if (hildon_touch_selector_get_active (rebuilt, 0) != 2,
+             "hildon-picker-button: rebuilt selector selects row %d instead of 2",
+             hildon_touch_selector_get_active (rebuilt, 0));
+
+    /* Test 5: clicking again. */
+    gtk_button_clicked (GTK_BUTTON (button));
+    fail_if (gtk_widget_get_toplevel (GTK_WIDGET (rebuilt)) != dialog,
+             "hildon-picker-button: the rebuilt selector is not shown "
+             "in the same dialog");
+    gtk_dialog_response (GTK_DIALOG (dialog), GTK_RESPONSE_DELETE_EVENT);
+
+    g_object_remove_weak_pointer (G_OBJECT (dialog), &kept);
+}
+END_TEST
+
+/**
+   Purpose: test that the picker buttons of a window share one dialog.
+
+   Checks for:
+
+   - Clicking a button shows its selector in a dialog for the window.
+   - Clicking another button of the window shows its selector in the same dialog.
+   - Clicking a button while the dialog shows another selector swaps them.
+
+*/
+START_TEST (test_hildon_picker_button_shared_dialog)
+{
+    GtkWidget *other_window, *box;
+    HildonPickerButton *first, *second;
+    HildonTouchSelector *first_selector, *second_selector;
+    GtkWidget *dialog;
+
+    other_window = hildon_window_new ();
+    box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+    gtk_container_add (GTK_CONTAINER (other_window), box);
+
+    first = HILDON_PICKER_BUTTON (hildon_picker_button_new (HILDON_SIZE_AUTO,
+                                                            HILDON_BUTTON_ARRANGEMENT_VERTICAL));
+    second = HILDON_PICKER_BUTTON (hildon_picker_button_new (HILDON_SIZE_AUTO,
+                                                             HILDON_BUTTON_ARRANGEMENT_VERTICAL));
+    first_selector = build_selector (first, NULL);
+    second_selector = build_selector (second, NULL);
+    hildon_picker_button_set_selector (first, first_selector);
+    hildon_picker_button_set_selector (second, second_selector);
+    gtk_box_pack_start (GTK_BOX (box), GTK_WIDGET (first), FALSE, FALSE, 0);
+    gtk_box_pack_start (GTK_BOX (box), GTK_WIDGET (second), FALSE, FALSE, 0);
+
+    show_test_window (other_window);
+
+    /* Test 1: clicking the first button. */
+    gtk_button_clicked (GTK_BUTTON (first));
+    dialog = gtk_widget_get_toplevel (GTK_WIDGET (first_selector));
+    fail_if (!HILDON_IS_PICKER_DIALOG (dialog),
+             "hildon-picker-button: the selector is not in a picker dialog");
+    fail_if (gtk_window_get_transient_for (GTK_WINDOW (dialog)) != GTK_WINDOW (other_window),
+             "hildon-picker-button: the dialog is not transient for the window");
+    gtk_dialog_response (GTK_DIALOG (dialog), GTK_RESPONSE_OK);
+
+    /* Test 2: clicking the second button. */
+    gtk_button_clicked (GTK_BUTTON (second));
+    fail_if (gtk_widget_get_toplevel (GTK_WIDGET (second_selector)) != dialog,
+             "hildon-picker-button: the second button got a dialog of its own");
+    fail_if (gtk_widget_get_parent (GTK_WIDGET (first_selector)) != NULL,
+             "hildon-picker-button: the first selector is still in the dialog");
+
+    /* Test 3: clicking the first button while the dialog is open. */
+    gtk_button_clicked (GTK_BUTTON (first));
+    fail_if (hildon_picker_dialog_get_selector (HILDON_PICKER_DIALOG (dialog)) != first_selector,
+             "hildon-picker-button: the dialog does not show the selector "
+             "of the last button clicked");
+    gtk_dialog_response (GTK_DIALOG (dialog), GTK_RESPONSE_DELETE_EVENT);
+
+    gtk_widget_destroy (other_window);
+}
+END_TEST
+
+/**
+   Purpose: test the column reported when appending a column selects
+   its first row.
+
+   Checks for:
+
+   - Appending the first column reports column 0 as changed.
+   - Appending the second column reports column 1 as changed.
+
+*/
+START_TEST (test_hildon_picker_button_append_column)
+{
+    HildonTouchSelector *columns;
+    GtkListStore *model;
+
+    columns = HILDON_TOUCH_SELECTOR (hildon_touch_selector_new ());
+    g_object_ref_sink (columns);
+    hildon_touch_selector_set_hildon_ui_mode (columns, HILDON_UI_MODE_EDIT);
+    g_signal_connect (columns, "changed", G_CALLBACK (on_changed), NULL);
+
+    model = gtk_list_store_new (1, G_TYPE_STRING);
+    gtk_list_store_insert_with_values (model, NULL, -1, 0, "Row one", -1);
+    gtk_list_store_insert_with_values (model, NULL, -1, 0, "Row two", -1);
+
+    /* Test 1: first column. */
+    changed_column = -1;
+    hildon_touch_selector_append_text_column (columns, GTK_TREE_MODEL (model), TRUE);
+    fail_if (changed_column != 0,
+             "hildon-picker-button: appending the first column reported "
+             "column %d as changed", changed_column);
+
+    /* Test 2: second column. */
+    changed_column = -1;
+    hildon_touch_selector_append_text_column (columns, GTK_TREE_MODEL (model), TRUE);
+    fail_if (changed_column != 1,
+             "hildon-picker-button: appending the second column reported "
+             "column %d as changed", changed_column);
+
+    g_object_unref (model);
+    gtk_widget_destroy (GTK_WIDGET (columns));
+    g_object_unref (columns);
+}
+END_TEST
+
 Suite *create_hildon_picker_button_suite (void)
 {
     Suite *s = suite_create ("HildonPickerButton");
@@ -117,6 +495,12 @@ Suite *create_hildon_picker_button_suite (void)
     TCase *tc1 = tcase_create ("hildon_picker_button");
     tcase_add_checked_fixture (tc1, fx_setup, fx_teardown);
     tcase_add_test (tc1, test_hildon_picker_button_value);
+    tcase_add_test (tc1, test_hildon_picker_button_snapshot);
+    tcase_add_test (tc1, test_hildon_picker_button_date);
+    tcase_add_test (tc1, test_hildon_picker_button_factory);
+    tcase_add_test (tc1, test_hildon_picker_button_timeout);
+    tcase_add_test (tc1, test_hildon_picker_button_shared_dialog);
+    tcase_add_test (tc1, test_hildon_picker_button_append_column);
     suite_add_tcase (s, tc1);
 
     return s;
@@ -63,5 +63,7 @@ Suite *create_hildon_window_suite(void);
 Suite *create_hildon_program_suite(void);
 Suite *create_hildon_composite_widget_suite(void);
 Suite *create_hildon_picker_button_suite (void);
+Suite *create_hildon_live_search_suite (void);
+Suite *create_hildon_calendar_suite (void);
 
 #endif